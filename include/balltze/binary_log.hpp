@@ -0,0 +1,243 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_API__BINARY_LOG_HPP
+#define BALLTZE_API__BINARY_LOG_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <istream>
+#include <chrono>
+#include <optional>
+#include <type_traits>
+#include <unordered_map>
+#include <fmt/format.h>
+#include <fmt/args.h>
+
+/**
+ * Binary log format written by loggers in binary mode.
+ *
+ * The file starts with a magic string followed by a stream of entries. Format
+ * strings and logger names are written once, the first time they are used, and
+ * referenced by ID afterwards; messages only store the raw arguments, so they are
+ * formatted when the log is read. Integers are stored in native (little endian) order.
+ *
+ *   'S' u32 id, u16 length, bytes                  format string definition
+ *   'N' u32 id, u16 length, bytes                  logger name definition
+ *   'R' u64 time, u8 level, u32 logger, u32 format, u8 count, arguments...
+ *   'D' u64 count                                  messages dropped
+ *
+ * Every argument is a type tag followed by its value.
+ */
+namespace Balltze::BinaryLog {
+    constexpr char MAGIC[8] = { 'B', 'L', 'T', 'Z', 'L', 'O', 'G', '1' };
+
+    enum EntryType : char {
+        ENTRY_FORMAT = 'S',
+        ENTRY_LOGGER_NAME = 'N',
+        ENTRY_RECORD = 'R',
+        ENTRY_DROPPED = 'D'
+    };
+
+    enum ArgumentType : std::uint8_t {
+        ARGUMENT_BOOL,
+        ARGUMENT_INT,
+        ARGUMENT_UINT,
+        ARGUMENT_FLOAT,
+        ARGUMENT_CHAR,
+        ARGUMENT_STRING
+    };
+
+    /**
+     * Whether a type can be stored in a binary log
+     */
+    template<typename T>
+    constexpr bool is_encodable = std::is_arithmetic_v<T> || std::is_enum_v<T>;
+
+    template<typename T>
+    void write_raw(fmt::memory_buffer &output, T value) {
+        auto *bytes = reinterpret_cast<const char *>(&value);
+        output.append(bytes, bytes + sizeof(T));
+    }
+
+    inline void write_string(fmt::memory_buffer &output, std::string_view string) {
+        auto length = static_cast<std::uint16_t>(std::min<std::size_t>(string.size(), 0xFFFF));
+        write_raw(output, length);
+        output.append(string.data(), string.data() + length);
+    }
+
+    /**
+     * Write an argument with its type tag
+     */
+    template<typename T>
+    void write_argument(fmt::memory_buffer &output, T value) {
+        static_assert(is_encodable<T>, "Type cannot be stored in a binary log");
+        if constexpr(std::is_enum_v<T>) {
+            write_argument(output, static_cast<std::underlying_type_t<T>>(value));
+        }
+        else if constexpr(std::is_same_v<T, bool>) {
+            write_raw(output, ARGUMENT_BOOL);
+            write_raw<std::uint8_t>(output, value);
+        }
+        else if constexpr(std::is_same_v<T, char>) {
+            write_raw(output, ARGUMENT_CHAR);
+            write_raw(output, value);
+        }
+        else if constexpr(std::is_floating_point_v<T>) {
+            write_raw(output, ARGUMENT_FLOAT);
+            write_raw<double>(output, value);
+        }
+        else if constexpr(std::is_signed_v<T>) {
+            write_raw(output, ARGUMENT_INT);
+            write_raw<std::int64_t>(output, value);
+        }
+        else {
+            write_raw(output, ARGUMENT_UINT);
+            write_raw<std::uint64_t>(output, value);
+        }
+    }
+
+    /**
+     * Message read from a binary log
+     */
+    struct Entry {
+        std::chrono::system_clock::time_point time;
+        std::uint8_t level;
+        std::string logger_name;
+        std::string message;
+    };
+
+    /**
+     * Decoder for binary logs
+     */
+    class Reader {
+    public:
+        /**
+         * Start reading a log
+         * @param stream    stream to read from; must be opened in binary mode
+         * @throws std::runtime_error if the stream is not a binary log
+         */
+        Reader(std::istream &stream) : m_stream(stream) {
+            char magic[sizeof(MAGIC)];
+            if(!m_stream.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) {
+                throw std::runtime_error("Not a binary log");
+            }
+        }
+
+        /**
+         * Read the next message
+         * @return message; std::nullopt at the end of the log
+         * @throws std::runtime_error if the log is corrupted
+         */
+        std::optional<Entry> next() {
+            char type;
+            while(m_stream.get(type)) {
+                switch(type) {
+                    case ENTRY_FORMAT: {
+                        auto id = read<std::uint32_t>();
+                        m_formats[id] = read_string();
+                        break;
+                    }
+                    case ENTRY_LOGGER_NAME: {
+                        auto id = read<std::uint32_t>();
+                        m_logger_names[id] = read_string();
+                        break;
+                    }
+                    case ENTRY_DROPPED: {
+                        Entry entry;
+                        entry.time = std::chrono::system_clock::time_point();
+                        entry.level = 0xFF;
+                        entry.message = fmt::format("{} messages were dropped", read<std::uint64_t>());
+                        return entry;
+                    }
+                    case ENTRY_RECORD:
+                        return read_record();
+                    default:
+                        throw std::runtime_error("Corrupted binary log");
+                }
+            }
+            return std::nullopt;
+        }
+
+    private:
+        std::istream &m_stream;
+        std::unordered_map<std::uint32_t, std::string> m_formats;
+        std::unordered_map<std::uint32_t, std::string> m_logger_names;
+
+        template<typename T>
+        T read() {
+            T value;
+            if(!m_stream.read(reinterpret_cast<char *>(&value), sizeof(T))) {
+                throw std::runtime_error("Truncated binary log");
+            }
+            return value;
+        }
+
+        std::string read_string() {
+            auto length = read<std::uint16_t>();
+            std::string string(length, '\0');
+            if(length > 0 && !m_stream.read(string.data(), length)) {
+                throw std::runtime_error("Truncated binary log");
+            }
+            return string;
+        }
+
+        Entry read_record() {
+            Entry entry;
+            auto time = read<std::uint64_t>();
+            entry.time = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(time)));
+            entry.level = read<std::uint8_t>();
+            auto logger_id = read<std::uint32_t>();
+            auto format_id = read<std::uint32_t>();
+            auto count = read<std::uint8_t>();
+
+            fmt::dynamic_format_arg_store<fmt::format_context> arguments;
+            for(std::size_t i = 0; i < count; i++) {
+                switch(read<std::uint8_t>()) {
+                    case ARGUMENT_BOOL:
+                        arguments.push_back(read<std::uint8_t>() != 0);
+                        break;
+                    case ARGUMENT_INT:
+                        arguments.push_back(read<std::int64_t>());
+                        break;
+                    case ARGUMENT_UINT:
+                        arguments.push_back(read<std::uint64_t>());
+                        break;
+                    case ARGUMENT_FLOAT:
+                        arguments.push_back(read<double>());
+                        break;
+                    case ARGUMENT_CHAR:
+                        arguments.push_back(read<char>());
+                        break;
+                    case ARGUMENT_STRING:
+                        arguments.push_back(read_string());
+                        break;
+                    default:
+                        throw std::runtime_error("Corrupted binary log");
+                }
+            }
+
+            auto logger = m_logger_names.find(logger_id);
+            entry.logger_name = logger != m_logger_names.end() ? logger->second : "?";
+            auto format = m_formats.find(format_id);
+            if(format == m_formats.end()) {
+                entry.message = fmt::format("<unknown format {}>", format_id);
+            }
+            else {
+                try {
+                    entry.message = fmt::vformat(format->second, arguments);
+                }
+                catch(fmt::format_error &e) {
+                    entry.message = fmt::format("<format error: {}> {}", e.what(), format->second);
+                }
+            }
+            return entry;
+        }
+    };
+}
+
+#endif
@@ -5,8 +5,15 @@
 
 #include <cstring>
 #include <string>
+#include <string_view>
 #include <vector>
+#include <list>
+#include <memory>
 #include <optional>
+#include <algorithm>
+#include <unordered_map>
+#include <typeinfo>
+#include "config.hpp"
 #include "utils.hpp"
 #include "api.hpp"
 
@@ -16,6 +23,8 @@ namespace Balltze {
 
     using PluginHandle = void *;
 
+    class PluginCommandIndex;
+
     /**
      * Result of a command
      */
@@ -180,14 +189,7 @@ namespace Balltze {
         /**
          * Register the command to the command list
          */
-        inline void register_command() {
-            try {
-                this->register_command_impl(get_current_module());
-            }
-            catch(...) {
-                throw;
-            }
-        }
+        inline void register_command();
 
     protected:
         /** Name of the command */
@@ -234,6 +236,7 @@ namespace Balltze {
         friend CommandResult execute_command(std::string command);
         static CommandResult execute_command_impl(HMODULE module_handle, std::string command);
         friend void load_commands_settings();
+        friend class PluginCommandIndex;
         static void load_commands_settings_impl(HMODULE module_handle);
     };
 
@@ -251,6 +254,634 @@ namespace Balltze {
      */
     BALLTZE_API std::string unsplit_arguments(const std::vector<std::string> &arguments) noexcept;
 
+    inline CommandResult execute_command(std::string command);
+
+    /**
+     * Index of the commands registered by the current plugin.
+     * 
+     * Commands are indexed by full name and name in a hash table for dispatch, 
+     * and in a compressed prefix trie for completion and suggestions. Every plugin 
+     * has its own index, filled by Command::register_command(); it does not see 
+     * commands of other plugins or of the library, and execute_command() still 
+     * looks commands up in the library. The index is destroyed with the plugin 
+     * module, so nothing has to be removed on unload.
+     */
+    class PluginCommandIndex {
+    public:
+        /**
+         * Get the index of the current plugin
+         */
+        static PluginCommandIndex &get() noexcept {
+            static PluginCommandIndex index;
+            return index;
+        }
+
+        /**
+         * Add a copy of a command to the index
+         * @param command   command to add; replaces a command with the same full name
+         * @return          reference to the stored command
+         */
+        template<typename T>
+        T &add(T const &command) {
+            remove(command_full_name(command));
+            auto &stored = *m_commands.emplace_back(std::make_unique<T>(command));
+            index(stored);
+            return static_cast<T &>(stored);
+        }
+
+        /**
+         * Remove a command from the index
+         * @param full_name full name of the command
+         * @return          true if the command was removed
+         */
+        bool remove(std::string_view full_name) noexcept {
+            auto it = m_by_full_name.find(full_name);
+            if(it == m_by_full_name.end()) {
+                return false;
+            }
+            auto *command = it->second;
+            unindex(*command);
+            m_commands.remove_if([command](auto const &stored) { return stored.get() == command; });
+            return true;
+        }
+
+        /**
+         * Find a command by full name, or by name if no full name matches
+         * @param name  name of the command
+         * @return      pointer to the command if found, nullptr if not
+         */
+        Command const *find(std::string_view name) const noexcept {
+            if(auto it = m_by_full_name.find(name); it != m_by_full_name.end()) {
+                return it->second;
+            }
+            if(auto it = m_by_name.find(name); it != m_by_name.end()) {
+                return it->second;
+            }
+            return nullptr;
+        }
+
+        /**
+         * Execute a command. Commands that are not in the index are passed to 
+         * execute_command().
+         * @param command       console command input
+         * @param from_console  whether the input comes from the console; commands that cannot be called from it fail
+         * @return              result of the command
+         */
+        CommandResult execute(std::string const &command, bool from_console = true) const {
+            auto arguments = split_arguments(command);
+            if(arguments.empty()) {
+                return COMMAND_RESULT_FAILED_ERROR_NOT_FOUND;
+            }
+            auto *found = find(arguments[0]);
+            if(!found) {
+                return execute_command(command);
+            }
+            std::vector<const char *> argv;
+            argv.reserve(arguments.size() - 1);
+            for(std::size_t i = 1; i < arguments.size(); i++) {
+                argv.push_back(arguments[i].c_str());
+            }
+            return call(*found, argv.size(), argv.data(), from_console);
+        }
+
+        /**
+         * Call a command with the checks and side effects of the console: commands that 
+         * cannot be called from the console are refused, and the arguments of commands 
+         * that save them are saved to the settings config in the background, or, if the 
+         * index has no settings config, run through execute_command() so the library 
+         * saves them.
+         * @param command       command to call
+         * @param arg_count     number of arguments
+         * @param args          arguments
+         * @param from_console  whether the call comes from the console
+         * @return              result of the command
+         */
+        static CommandResult call(Command const &command, std::size_t arg_count, const char **args, bool from_console = true);
+
+        /**
+         * Save the arguments of autosave commands called through call() to a config of 
+         * the plugin with Config::save_async(), instead of through the library, which 
+         * saves synchronously. The plugin must call Config::shutdown_saves() when unloaded.
+         * @param config    config to save to, or nullptr to save through the library; must outlive its use
+         * @param prefix    dotted key the arguments are saved under, by full name of the command
+         */
+        void set_settings(Config::Config *config, std::string prefix = "commands") noexcept {
+            m_settings = config;
+            m_settings_prefix = std::move(prefix);
+        }
+
+        /**
+         * Call the autosave commands of the index with the arguments saved in the settings config
+         * @return number of commands called
+         */
+        std::size_t load_settings() {
+            if(!m_settings) {
+                return 0;
+            }
+            std::size_t loaded = 0;
+            for(auto const &command : m_commands) {
+                if(!command->autosave()) {
+                    continue;
+                }
+                auto arguments = m_settings->get(settings_key(*command));
+                if(!arguments) {
+                    continue;
+                }
+                command->call(split_arguments(*arguments));
+                loaded++;
+            }
+            return loaded;
+        }
+
+        /**
+         * Get the commands of the plugin whose name or full name start with a prefix
+         * @param prefix    prefix to complete
+         * @param limit     maximum number of results
+         * @return          matching names in lexicographical order
+         */
+        std::vector<std::string> complete(std::string_view prefix, std::size_t limit = static_cast<std::size_t>(-1)) const {
+            std::vector<std::string> results;
+            TrieNode const *node = &m_trie;
+            std::string path;
+            std::string_view rest = prefix;
+            while(!rest.empty()) {
+                auto *child = node->child(rest[0]);
+                if(!child) {
+                    return results;
+                }
+                auto common = common_prefix(child->label, rest);
+                if(common < rest.size() && common < child->label.size()) {
+                    return results;
+                }
+                path += child->label;
+                rest.remove_prefix(std::min(common, rest.size()));
+                node = child;
+            }
+            collect(*node, path, results, limit);
+            return results;
+        }
+
+        /**
+         * Get the names of commands of the plugin closest to a possibly misspelled input
+         * @param input         input to match
+         * @param max_distance  maximum edit distance
+         * @param limit         maximum number of results
+         * @return              matching names sorted by edit distance
+         */
+        std::vector<std::string> suggest(std::string_view input, std::size_t max_distance = 2, std::size_t limit = 5) const {
+            std::vector<std::pair<std::size_t, std::string>> matches;
+            std::vector<std::size_t> row(input.size() + 1);
+            for(std::size_t i = 0; i <= input.size(); i++) {
+                row[i] = i;
+            }
+            std::string path;
+            for(auto const &child : m_trie.children) {
+                suggest(*child, input, row, path, max_distance, matches);
+            }
+            std::stable_sort(matches.begin(), matches.end(), [](auto const &a, auto const &b) {
+                return a.first < b.first;
+            });
+            std::vector<std::string> results;
+            for(std::size_t i = 0; i < matches.size() && i < limit; i++) {
+                results.emplace_back(std::move(matches[i].second));
+            }
+            return results;
+        }
+
+        /**
+         * Get the number of commands in the index
+         */
+        std::size_t size() const noexcept {
+            return m_commands.size();
+        }
+
+        PluginCommandIndex(PluginCommandIndex const &) = delete;
+        PluginCommandIndex &operator=(PluginCommandIndex const &) = delete;
+
+    private:
+        struct TrieNode {
+            /** Edge label leading to this node */
+            std::string label;
+
+            /** Children sorted by the first character of their label */
+            std::vector<std::unique_ptr<TrieNode>> children;
+
+            /** Number of commands indexed under this exact name */
+            std::size_t terminal_count = 0;
+
+            TrieNode *child(char c) const noexcept {
+                auto it = std::lower_bound(children.begin(), children.end(), c, [](auto const &node, char c) {
+                    return node->label[0] < c;
+                });
+                return (it != children.end() && (*it)->label[0] == c) ? it->get() : nullptr;
+            }
+
+            void add_child(std::unique_ptr<TrieNode> node) {
+                auto it = std::lower_bound(children.begin(), children.end(), node->label[0], [](auto const &node, char c) {
+                    return node->label[0] < c;
+                });
+                children.insert(it, std::move(node));
+            }
+        };
+
+        /** Stored commands; list nodes keep the names of the commands stable */
+        std::list<std::unique_ptr<Command>> m_commands;
+
+        /** Commands by full name */
+        std::unordered_map<std::string_view, Command *> m_by_full_name;
+
+        /** Commands by name; the first registered command wins */
+        std::unordered_map<std::string_view, Command *> m_by_name;
+
+        /** Prefix trie of names and full names */
+        TrieNode m_trie;
+
+        /** Config the arguments of autosave commands are saved to */
+        Config::Config *m_settings = nullptr;
+
+        /** Key of the saved arguments in the settings config */
+        std::string m_settings_prefix;
+
+        std::string settings_key(Command const &command) const {
+            return m_settings_prefix.empty() ? std::string(command_full_name(command)) : m_settings_prefix + "." + std::string(command_full_name(command));
+        }
+
+        PluginCommandIndex() = default;
+
+        static std::string_view command_full_name(Command const &command) noexcept {
+            return command.m_full_name ? std::string_view(*command.m_full_name) : std::string_view(command.m_name);
+        }
+
+        static std::size_t common_prefix(std::string_view a, std::string_view b) noexcept {
+            std::size_t i = 0;
+            while(i < a.size() && i < b.size() && a[i] == b[i]) {
+                i++;
+            }
+            return i;
+        }
+
+        void index(Command &command) {
+            auto full_name = command_full_name(command);
+            std::string_view name = command.m_name;
+            m_by_full_name[full_name] = &command;
+            m_by_name.try_emplace(name, &command);
+            trie_insert(full_name);
+            if(name != full_name) {
+                trie_insert(name);
+            }
+        }
+
+        void unindex(Command &command) noexcept {
+            auto full_name = command_full_name(command);
+            std::string_view name = command.m_name;
+            m_by_full_name.erase(full_name);
+            trie_remove(m_trie, full_name);
+            if(name != full_name) {
+                trie_remove(m_trie, name);
+            }
+            auto it = m_by_name.find(name);
+            if(it != m_by_name.end() && it->second == &command) {
+                m_by_name.erase(it);
+                for(auto const &stored : m_commands) {
+                    if(stored.get() != &command && stored->m_name == name) {
+                        m_by_name.emplace(std::string_view(stored->m_name), stored.get());
+                        break;
+                    }
+                }
+            }
+        }
+
+        void trie_insert(std::string_view key) {
+            TrieNode *node = &m_trie;
+            while(!key.empty()) {
+                auto *child = node->child(key[0]);
+                if(!child) {
+                    auto leaf = std::make_unique<TrieNode>();
+                    leaf->label = std::string(key);
+                    leaf->terminal_count = 1;
+                    node->add_child(std::move(leaf));
+                    return;
+                }
+                auto common = common_prefix(child->label, key);
+                if(common < child->label.size()) {
+                    // Split the edge at the common prefix
+                    auto split = std::make_unique<TrieNode>();
+                    split->label = child->label.substr(0, common);
+                    auto &slot = *std::find_if(node->children.begin(), node->children.end(), [child](auto const &c) { return c.get() == child; });
+                    auto old_child = std::move(slot);
+                    old_child->label.erase(0, common);
+                    split->add_child(std::move(old_child));
+                    slot = std::move(split);
+                    child = slot.get();
+                }
+                key.remove_prefix(common);
+                node = child;
+            }
+            node->terminal_count++;
+        }
+
+        static bool trie_remove(TrieNode &node, std::string_view key) noexcept {
+            if(key.empty()) {
+                if(node.terminal_count > 0) {
+                    node.terminal_count--;
+                    return true;
+                }
+                return false;
+            }
+            auto it = std::find_if(node.children.begin(), node.children.end(), [&](auto const &child) {
+                return child->label[0] == key[0];
+            });
+            if(it == node.children.end() || key.substr(0, (*it)->label.size()) != (*it)->label) {
+                return false;
+            }
+            auto &child = **it;
+            if(!trie_remove(child, key.substr(child.label.size()))) {
+                return false;
+            }
+            if(child.terminal_count == 0 && child.children.empty()) {
+                node.children.erase(it);
+            }
+            else if(child.terminal_count == 0 && child.children.size() == 1) {
+                // Merge the child with its only child
+                auto grandchild = std::move(child.children[0]);
+                grandchild->label.insert(0, child.label);
+                *it = std::move(grandchild);
+            }
+            return true;
+        }
+
+        static void collect(TrieNode const &node, std::string &path, std::vector<std::string> &results, std::size_t limit) {
+            if(results.size() >= limit) {
+                return;
+            }
+            if(node.terminal_count > 0) {
+                results.emplace_back(path);
+            }
+            for(auto const &child : node.children) {
+                path += child->label;
+                collect(*child, path, results, limit);
+                path.erase(path.size() - child->label.size());
+            }
+        }
+
+        static void suggest(TrieNode const &node, std::string_view input, std::vector<std::size_t> const &previous_row, std::string &path, std::size_t max_distance, std::vector<std::pair<std::size_t, std::string>> &matches) {
+            // Levenshtein rows are extended one character at a time along the edge
+            std::vector<std::size_t> row = previous_row;
+            std::vector<std::size_t> next(input.size() + 1);
+            for(char c : node.label) {
+                next[0] = row[0] + 1;
+                std::size_t row_min = next[0];
+                for(std::size_t i = 1; i <= input.size(); i++) {
+                    std::size_t cost = input[i - 1] == c ? 0 : 1;
+                    next[i] = std::min({ next[i - 1] + 1, row[i] + 1, row[i - 1] + cost });
+                    row_min = std::min(row_min, next[i]);
+                }
+                row.swap(next);
+                if(row_min > max_distance) {
+                    return;
+                }
+            }
+            path += node.label;
+            if(node.terminal_count > 0 && row[input.size()] <= max_distance) {
+                matches.emplace_back(row[input.size()], path);
+            }
+            for(auto const &child : node.children) {
+                suggest(*child, input, row, path, max_distance, matches);
+            }
+            path.erase(path.size() - node.label.size());
+        }
+    };
+
+    /**
+     * Tokenizer for console commands that reuses its storage between calls.
+     * 
+     * Arguments follow the rules of split_arguments: whitespace separates arguments 
+     * outside of double quotes, and a backslash escapes the next character. Commands 
+     * are separated by newlines and semicolons outside of quotes.
+     */
+    class CommandTokenizer {
+    public:
+        /**
+         * A tokenized command
+         */
+        struct TokenizedCommand {
+            /** Command name followed by its arguments */
+            const char **tokens;
+
+            /** Number of tokens, including the command name */
+            std::size_t token_count;
+
+            std::string_view name() const noexcept {
+                return tokens[0];
+            }
+
+            const char **arguments() const noexcept {
+                return tokens + 1;
+            }
+
+            std::size_t argument_count() const noexcept {
+                return token_count - 1;
+            }
+        };
+
+        /**
+         * Tokenize a script of commands. Previous results are invalidated.
+         * @param script    commands separated by newlines or semicolons
+         * @return          number of commands
+         */
+        std::size_t tokenize(std::string_view script) {
+            m_arena.clear();
+            m_offsets.clear();
+            m_command_bounds.clear();
+            m_arena.reserve(script.size() + 1);
+
+            bool in_quotes = false;
+            bool in_token = false;
+            std::size_t command_start = 0;
+
+            auto end_token = [&]() {
+                if(in_token) {
+                    m_arena.push_back('\0');
+                    in_token = false;
+                }
+            };
+            auto end_command = [&]() {
+                end_token();
+                if(m_offsets.size() > command_start) {
+                    m_command_bounds.emplace_back(command_start, m_offsets.size() - command_start);
+                }
+                command_start = m_offsets.size();
+            };
+            auto put = [&](char c) {
+                if(!in_token) {
+                    m_offsets.push_back(m_arena.size());
+                    in_token = true;
+                }
+                m_arena.push_back(c);
+            };
+
+            for(std::size_t i = 0; i < script.size(); i++) {
+                char c = script[i];
+                if(c == '\\' && i + 1 < script.size()) {
+                    put(script[++i]);
+                }
+                else if(c == '"') {
+                    if(!in_token) {
+                        m_offsets.push_back(m_arena.size());
+                        in_token = true;
+                    }
+                    in_quotes = !in_quotes;
+                }
+                else if(in_quotes) {
+                    put(c);
+                }
+                else if(c == '\n' || c == ';') {
+                    end_command();
+                }
+                else if(c == ' ' || c == '\t' || c == '\r') {
+                    end_token();
+                }
+                else {
+                    put(c);
+                }
+            }
+            end_command();
+
+            // Pointers are resolved once the arena stops growing
+            m_tokens.resize(m_offsets.size());
+            for(std::size_t i = 0; i < m_offsets.size(); i++) {
+                m_tokens[i] = m_arena.data() + m_offsets[i];
+            }
+            return m_command_bounds.size();
+        }
+
+        /**
+         * Get the number of commands of the last tokenized script
+         */
+        std::size_t size() const noexcept {
+            return m_command_bounds.size();
+        }
+
+        /**
+         * Get a command of the last tokenized script
+         * @param index index of the command
+         */
+        TokenizedCommand operator[](std::size_t index) noexcept {
+            auto [offset, count] = m_command_bounds[index];
+            return TokenizedCommand { m_tokens.data() + offset, count };
+        }
+
+    private:
+        /** Null-terminated unescaped tokens */
+        std::string m_arena;
+
+        /** Offsets of the tokens in the arena */
+        std::vector<std::size_t> m_offsets;
+
+        /** Pointers to the tokens */
+        std::vector<const char *> m_tokens;
+
+        /** First token and token count of each command */
+        std::vector<std::pair<std::size_t, std::size_t>> m_command_bounds;
+    };
+
+    /**
+     * Runs scripts of commands. The script is tokenized in a single pass and commands 
+     * of the current module are called directly, without going through strings.
+     */
+    class CommandBatchExecutor {
+    public:
+        /**
+         * Execute a script
+         * @param script        commands separated by newlines or semicolons
+         * @param stop_on_error stop at the first command that does not succeed
+         * @param from_console  whether the script comes from the console (e.g. rcon); commands that cannot be called from it fail
+         * @return              number of commands that succeeded
+         */
+        std::size_t execute(std::string_view script, bool stop_on_error = false, bool from_console = true) {
+            m_results.clear();
+            std::size_t count = m_tokenizer.tokenize(script);
+            m_results.reserve(count);
+            std::size_t succeeded = 0;
+            for(std::size_t i = 0; i < count; i++) {
+                auto command = m_tokenizer[i];
+                CommandResult result;
+                if(auto *found = m_index.find(command.name())) {
+                    result = PluginCommandIndex::call(*found, command.argument_count(), command.arguments(), from_console);
+                }
+                else {
+                    result = execute_command(unsplit_command(command));
+                }
+                m_results.push_back(result);
+                if(result == COMMAND_RESULT_SUCCESS) {
+                    succeeded++;
+                }
+                else if(stop_on_error) {
+                    break;
+                }
+            }
+            return succeeded;
+        }
+
+        /**
+         * Get the results of the commands of the last script
+         */
+        std::vector<CommandResult> const &results() const noexcept {
+            return m_results;
+        }
+
+        /**
+         * Create an executor for the commands of an index
+         * @param index     index to look commands up in
+         */
+        CommandBatchExecutor(PluginCommandIndex &index = PluginCommandIndex::get()) noexcept : m_index(index) {}
+
+    private:
+        PluginCommandIndex &m_index;
+        CommandTokenizer m_tokenizer;
+        std::vector<CommandResult> m_results;
+
+        static std::string unsplit_command(CommandTokenizer::TokenizedCommand const &command) {
+            std::vector<std::string> tokens(command.tokens, command.tokens + command.token_count);
+            return unsplit_arguments(tokens);
+        }
+    };
+
+    inline CommandResult PluginCommandIndex::call(Command const &command, std::size_t arg_count, const char **args, bool from_console) {
+        if(from_console && !command.can_call_from_console()) {
+            return COMMAND_RESULT_FAILED_ERROR;
+        }
+        auto &index = get();
+        if(command.autosave() && arg_count > 0 && index.m_settings) {
+            auto result = command.call(arg_count, args);
+            if(result == COMMAND_RESULT_SUCCESS) {
+                index.m_settings->set(index.settings_key(command), unsplit_arguments(std::vector<std::string>(args, args + arg_count)));
+                index.m_settings->save_async();
+            }
+            return result;
+        }
+        if(command.autosave() && arg_count > 0) {
+            std::vector<std::string> tokens;
+            tokens.reserve(arg_count + 1);
+            tokens.emplace_back(command_full_name(command));
+            tokens.insert(tokens.end(), args, args + arg_count);
+            return execute_command(unsplit_arguments(tokens));
+        }
+        return command.call(arg_count, args);
+    }
+
+    inline void Command::register_command() {
+        try {
+            this->register_command_impl(get_current_module());
+            if(typeid(*this) == typeid(Command)) {
+                PluginCommandIndex::get().add(*this);
+            }
+        }
+        catch(...) {
+            throw;
+        }
+    }
+
     /**
      * Register a command
      * @param name                  name of the command
@@ -3,17 +3,332 @@
 #ifndef BALLTZE_API__CONFIG_HPP
 #define BALLTZE_API__CONFIG_HPP
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <utility>
 #include <istream>
 #include <optional>
+#include <fstream>
+#include <stdexcept>
 #include <filesystem>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <map>
+#include <deque>
+#include <string_view>
+#include <charconv>
+#include <algorithm>
+#include <iterator>
 #include <nlohmann/json.hpp>
 #include "api.hpp"
 
 namespace Balltze::Config {
+    class Config;
+    class ConfigWatcher;
+
+    template<typename T>
+    class ConfigBinding;
+
+    /**
+     * Dotted config key split once, so it can be reused without allocating
+     */
+    class ConfigKey {
+    public:
+        /**
+         * Compile a dotted key
+         * @param key Dotted key to compile
+         */
+        ConfigKey(std::string const &key) {
+            std::size_t start = 0;
+            while(true) {
+                std::size_t end = key.find('.', start);
+                if(end == std::string::npos) {
+                    m_path.emplace_back(key.substr(start));
+                    break;
+                }
+                m_path.emplace_back(key.substr(start, end - start));
+                start = end + 1;
+            }
+        }
+
+        ConfigKey(const char *key) : ConfigKey(std::string(key)) {}
+
+        ConfigKey() = default;
+
+        /**
+         * Get the components of the key
+         * @return Vector of keys
+         */
+        std::vector<std::string> const &path() const noexcept {
+            return m_path;
+        }
+
+    private:
+        /** Components of the dotted key */
+        std::vector<std::string> m_path;
+    };
+
+    /**
+     * Background writer for config files. Saves scheduled within the debounce window 
+     * of each other are coalesced into a single write of the latest snapshot.
+     * 
+     * shutdown() must be called when the plugin is unloaded. Threads cannot be joined 
+     * while the loader lock is held, so the destructor only tells the writer thread to 
+     * stop and detaches it; the thread runs code of the plugin module, which is unmapped 
+     * right after, and saves still pending at that point are lost.
+     */
+    class ConfigWriter {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        /**
+         * Get the writer of the current module
+         */
+        static ConfigWriter &get() noexcept {
+            static ConfigWriter writer;
+            return writer;
+        }
+
+        /**
+         * Write a JSON object to a file, replacing it atomically. It is not synchronized 
+         * with the writer; use write() for files that may have saves scheduled.
+         * @param filepath  Path of the file
+         * @param json      JSON object to write
+         * @throws std::runtime_error if the file cannot be written
+         */
+        static void write_file(std::filesystem::path const &filepath, nlohmann::json const &json) {
+            auto temp_path = filepath;
+            temp_path += ".tmp";
+            {
+                std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+                if(!file.is_open()) {
+                    throw std::runtime_error("Could not open config file " + temp_path.string());
+                }
+                file << json.dump(4);
+                file.flush();
+                if(!file) {
+                    throw std::runtime_error("Could not write config file " + temp_path.string());
+                }
+            }
+            std::error_code ec;
+            std::filesystem::rename(temp_path, filepath, ec);
+            if(ec) {
+                std::filesystem::remove(temp_path, ec);
+                throw std::runtime_error("Could not replace config file " + filepath.string());
+            }
+        }
+
+        /**
+         * Schedule a save
+         * @param filepath  Path of the file
+         * @param json      Snapshot to write
+         * @param delay     Debounce window; the write happens once no save was scheduled for this long
+         */
+        void schedule(std::filesystem::path const &filepath, nlohmann::json json, std::chrono::milliseconds delay) {
+            std::lock_guard<std::mutex> lock(m_state->mutex);
+            auto &pending = m_state->pending[filepath];
+            pending.snapshot = std::move(json);
+            pending.deadline = Clock::now() + delay;
+            if(!m_thread.joinable()) {
+                m_state->stop = false;
+                m_thread = std::thread(&ConfigWriter::run, m_state);
+            }
+            m_state->condition.notify_one();
+        }
+
+        /**
+         * Write a file now. A save of the file scheduled before is dropped, and a save 
+         * being written by the writer thread is finished first, so the file always ends 
+         * up with this snapshot.
+         * @param filepath  Path of the file
+         * @param json      Snapshot to write
+         * @throws std::runtime_error if the file cannot be written
+         */
+        void write(std::filesystem::path const &filepath, nlohmann::json const &json) {
+            std::unique_lock<std::mutex> lock(m_state->mutex);
+            m_state->pending.erase(filepath);
+            std::lock_guard<std::mutex> write_lock(m_state->write_mutex);
+            lock.unlock();
+            write_file(filepath, json);
+            lock.lock();
+            m_state->record_written(filepath, json);
+        }
+
+        /**
+         * Get the last snapshot the current module wrote to a file through the writer
+         * @param filepath  Path of the file
+         * @param serial    Serial of the last snapshot the caller got; updated when a newer one is returned
+         * @return          Snapshot if one newer than serial was written, std::nullopt otherwise
+         */
+        std::optional<nlohmann::json> last_written(std::filesystem::path const &filepath, std::uint64_t &serial) {
+            std::lock_guard<std::mutex> lock(m_state->mutex);
+            auto it = m_state->written.find(written_key(filepath));
+            if(it == m_state->written.end() || it->second.first == serial) {
+                return std::nullopt;
+            }
+            serial = it->second.first;
+            return it->second.second;
+        }
+
+        /**
+         * Write every pending save now and wait until they are done
+         */
+        void flush() {
+            std::unique_lock<std::mutex> lock(m_state->mutex);
+            if(!m_thread.joinable()) {
+                return;
+            }
+            for(auto &[path, pending] : m_state->pending) {
+                pending.deadline = Clock::time_point::min();
+            }
+            m_state->condition.notify_one();
+            m_state->idle_condition.wait(lock, [this]() { 
+                return m_state->pending.empty() && !m_state->writing; 
+            });
+        }
+
+        /**
+         * Write every pending save and stop the writer thread. Call it when the plugin 
+         * is being unloaded, before returning from the unload function. A later save 
+         * starts the thread again.
+         */
+        void shutdown() {
+            flush();
+            {
+                std::lock_guard<std::mutex> lock(m_state->mutex);
+                m_state->stop = true;
+                m_state->condition.notify_one();
+            }
+            if(m_thread.joinable()) {
+                m_thread.join();
+            }
+        }
+
+        /**
+         * Check if there are saves waiting to be written
+         */
+        bool pending() noexcept {
+            std::lock_guard<std::mutex> lock(m_state->mutex);
+            return !m_state->pending.empty() || m_state->writing;
+        }
+
+        ~ConfigWriter() {
+            if(m_thread.joinable()) {
+                {
+                    std::lock_guard<std::mutex> lock(m_state->mutex);
+                    m_state->stop = true;
+                    m_state->condition.notify_one();
+                }
+                m_thread.detach();
+            }
+        }
+
+    private:
+        struct PendingSave {
+            nlohmann::json snapshot;
+            Clock::time_point deadline;
+        };
+
+        /**
+         * State shared with the writer thread; the thread keeps it alive after the 
+         * writer is destroyed
+         */
+        struct State {
+            std::map<std::filesystem::path, PendingSave> pending;
+            std::map<std::filesystem::path, std::pair<std::uint64_t, nlohmann::json>> written;
+            std::uint64_t write_serial = 0;
+            std::mutex mutex;
+            std::mutex write_mutex;
+            std::condition_variable condition;
+            std::condition_variable idle_condition;
+            bool stop = false;
+            bool writing = false;
+
+            /** Must be called with the mutex held */
+            void record_written(std::filesystem::path const &filepath, nlohmann::json const &json) {
+                written[written_key(filepath)] = { ++write_serial, json };
+            }
+        };
+
+        static std::filesystem::path written_key(std::filesystem::path const &filepath) noexcept {
+            std::error_code ec;
+            auto absolute = std::filesystem::absolute(filepath, ec);
+            return ec ? filepath : absolute;
+        }
+
+        std::shared_ptr<State> m_state = std::make_shared<State>();
+        std::thread m_thread;
+
+        ConfigWriter() = default;
+
+        static void run(std::shared_ptr<State> state) {
+            std::unique_lock<std::mutex> lock(state->mutex);
+            while(true) {
+                if(state->pending.empty()) {
+                    state->idle_condition.notify_all();
+                }
+                if(state->stop) {
+                    return;
+                }
+                if(state->pending.empty()) {
+                    state->condition.wait(lock);
+                    continue;
+                }
+
+                auto next = state->pending.begin();
+                for(auto it = state->pending.begin(); it != state->pending.end(); it++) {
+                    if(it->second.deadline < next->second.deadline) {
+                        next = it;
+                    }
+                }
+                auto deadline = next->second.deadline;
+                if(Clock::now() < deadline) {
+                    state->condition.wait_until(lock, deadline);
+                    continue;
+                }
+
+                auto filepath = next->first;
+                auto snapshot = std::move(next->second.snapshot);
+                state->pending.erase(next);
+                state->writing = true;
+
+                // Taken before the queue is released so write() cannot overtake this snapshot
+                std::unique_lock<std::mutex> write_lock(state->write_mutex);
+                lock.unlock();
+                bool written = false;
+                try {
+                    write_file(filepath, snapshot);
+                    written = true;
+                }
+                catch(...) {
+                    // Nothing to report to from here; the next save will retry
+                }
+                write_lock.unlock();
+                lock.lock();
+                if(written) {
+                    state->record_written(filepath, snapshot);
+                }
+                state->writing = false;
+            }
+        }
+    };
+
+    /**
+     * JSON config file.
+     * 
+     * A plugin that calls save_async() must call shutdown_saves() in its unload function. 
+     * The background writer thread runs code of the plugin module, so if it is still 
+     * running when the module is unmapped, the process crashes.
+     */
     class BALLTZE_API Config {
+        template<typename T>
+        friend class ConfigBinding;
+        friend class ConfigWatcher;
+
     private:
         /** Path to the config file */
         std::filesystem::path filepath;
@@ -65,6 +380,40 @@ namespace Balltze::Config {
          */
         void save();
 
+        /**
+         * Save config file now, in order with the background saves of the current module; 
+         * use it instead of save() on configs that are also saved with save_async()
+         * @throws std::runtime_error if config file cannot be saved
+         */
+        void save_now() {
+            ConfigWriter::get().write(filepath, config);
+        }
+
+        /**
+         * Save config file in the background. Saves requested within the delay 
+         * are coalesced into one write.
+         * @param delay Time to wait for further changes before writing
+         */
+        void save_async(std::chrono::milliseconds delay = std::chrono::milliseconds(500)) {
+            ConfigWriter::get().schedule(filepath, config, delay);
+        }
+
+        /**
+         * Write every pending background save of the current module
+         */
+        static void flush_saves() {
+            ConfigWriter::get().flush();
+        }
+
+        /**
+         * Write every pending background save of the current module and stop its writer 
+         * thread. It must be called from the unload function of any plugin that used 
+         * save_async(), before it returns.
+         */
+        static void shutdown_saves() {
+            ConfigWriter::get().shutdown();
+        }
+
         /**
          * Get value from config
          * @param key   Key to get value from
@@ -98,6 +447,53 @@ namespace Balltze::Config {
          */
         std::optional<std::string> get(std::string key);
 
+        /**
+         * Get value from config using a compiled key. It has its own name because 
+         * ConfigKey converts from strings, which would make get("key") ambiguous.
+         * @param key   Compiled key to get value from
+         * @return      Value if key exists, std::nullopt otherwise
+         * @tparam T    Type of value
+         */
+        template<typename T>
+        std::optional<T> get_compiled(ConfigKey const &key) {
+            auto *slice = find(key);
+            if(slice && slice->is_primitive()) {
+                return slice->get<T>();
+            }
+            return std::nullopt;
+        }
+
+        /**
+         * Find the node of a compiled key
+         * @param key   Compiled key to look up
+         * @return      Pointer to the node if key exists, nullptr otherwise
+         */
+        nlohmann::json *find(ConfigKey const &key) noexcept {
+            nlohmann::json *slice = &config;
+            for(auto const &component : key.path()) {
+                if(!slice->is_object()) {
+                    return nullptr;
+                }
+                auto it = slice->find(component);
+                if(it == slice->end()) {
+                    return nullptr;
+                }
+                slice = &*it;
+            }
+            return slice;
+        }
+
+        /**
+         * Bind a key to get and set its value without splitting it on every access
+         * @param key   Key to bind
+         * @return      Binding for the key
+         * @tparam T    Type of value
+         */
+        template<typename T>
+        ConfigBinding<T> bind(ConfigKey key) noexcept {
+            return ConfigBinding<T>(this, std::move(key));
+        }
+
         /**
          * Get array from config
          * @param key Key to get array from
@@ -224,6 +620,90 @@ namespace Balltze::Config {
         }
     };
 
+    /**
+     * Typed handle to a config key. The key is split once; the node is looked up
+     * again on every access, so a binding stays valid across load(), remove() and
+     * any other change of the tree, and no string is allocated.
+     * @tparam T Type of value
+     */
+    template<typename T>
+    class ConfigBinding {
+        friend class Config;
+
+    public:
+        /**
+         * Get the value of the bound key
+         * @return Value if key exists, std::nullopt otherwise
+         */
+        std::optional<T> get() {
+            auto *node = m_config->find(m_key);
+            if(node && node->is_primitive()) {
+                return node->template get<T>();
+            }
+            return std::nullopt;
+        }
+
+        /**
+         * Get the value of the bound key
+         * @param default_value Value to return if key does not exist
+         * @return              Value if key exists, default_value otherwise
+         */
+        T get_or(T default_value) {
+            auto *node = m_config->find(m_key);
+            if(node && node->is_primitive()) {
+                return node->template get<T>();
+            }
+            return default_value;
+        }
+
+        /**
+         * Set the value of the bound key
+         * @param value Value to set
+         */
+        void set(T value) {
+            auto *node = m_config->find(m_key);
+            if(node && node->is_primitive()) {
+                *node = value;
+            }
+            else {
+                nlohmann::json *slice = &m_config->config;
+                for(auto const &component : m_key.path()) {
+                    if(!slice->is_object()) {
+                        *slice = nlohmann::json::object();
+                    }
+                    slice = &(*slice)[component];
+                }
+                *slice = value;
+            }
+        }
+
+        /**
+         * Check if the bound key exists
+         * @return True if key exists, false otherwise
+         */
+        bool exists() {
+            return m_config->find(m_key) != nullptr;
+        }
+
+        /**
+         * Get the compiled key of the binding
+         */
+        ConfigKey const &key() const noexcept {
+            return m_key;
+        }
+
+        ConfigBinding() = default;
+
+    private:
+        /** Config the key is bound to */
+        Config *m_config = nullptr;
+
+        /** Compiled key */
+        ConfigKey m_key;
+
+        ConfigBinding(Config *config, ConfigKey key) noexcept : m_config(config), m_key(std::move(key)) {}
+    };
+
     /**
      * From Chimera
      * https://github.com/SnowyMouse/chimera/blob/master/src/chimera/config/ini.hpp
@@ -331,6 +811,410 @@ namespace Balltze::Config {
          */
         void load_from_stream(std::istream &stream);
     };
+
+    /**
+     * Header-only Ini with the interface of Ini. The file is read into a single 
+     * buffer which the values point into, and keys are indexed in an open-addressing 
+     * hash table, so lookups do not scan every value. It is a separate type so the 
+     * layout of the exported Ini is unchanged.
+     */
+    class IndexedIni {
+    public:
+        /**
+         * Get the value by name
+         * @param  key name of the value
+         * @return     pointer to the value if found, or nullptr if not
+         */
+        const char *get_value(const char *key) const noexcept {
+            auto *entry = find_entry(key);
+            return entry ? entry->value : nullptr;
+        }
+
+        /**
+         * Get the value by name
+         * @param  key name of the value
+         * @return     string value of the key or nullopt if not set
+         */
+        std::optional<std::string> get_value_string(const char *key) const noexcept {
+            auto *entry = find_entry(key);
+            if(entry) {
+                return std::string(entry->value, entry->value_length);
+            }
+            return std::nullopt;
+        }
+
+        /**
+         * Get the value by name
+         * @param  key name of the value
+         * @return     boolean value of the key or nullopt if not set
+         */
+        std::optional<bool> get_value_bool(const char *key) const noexcept {
+            auto *entry = find_entry(key);
+            if(entry) {
+                std::string_view value(entry->value, entry->value_length);
+                return value == "1" || value == "true";
+            }
+            return std::nullopt;
+        }
+
+        /**
+         * Get the value by name
+         * @param  key name of the value
+         * @return     boolean value of the key or nullopt if not set
+         */
+        std::optional<double> get_value_float(const char *key) const noexcept {
+            return parse_number<double>(key);
+        }
+
+        /**
+         * Get the value by name
+         * @param  key name of the value
+         * @return     boolean value of the key or nullopt if not set
+         */
+        std::optional<long> get_value_long(const char *key) const noexcept {
+            return parse_number<long>(key);
+        }
+
+        /**
+         * Get the value by name
+         * @param  key name of the value
+         * @return     boolean value of the key or nullopt if not set
+         */
+        std::optional<unsigned long long> get_value_size(const char *key) const noexcept {
+            return parse_number<unsigned long long>(key);
+        }
+
+        /**
+         * Set the value
+         * @param key        name of the value
+         * @param new_value  new value to set to
+         */
+        void set_value(const char *key, const char *new_value) noexcept {
+            auto *entry = find_entry(key);
+            if(entry) {
+                if(!entry->owned_value) {
+                    entry->owned_value = &m_owned_strings.emplace_back();
+                }
+                *entry->owned_value = new_value;
+                entry->value = entry->owned_value->c_str();
+                entry->value_length = entry->owned_value->size();
+            }
+            else {
+                auto &owned_key = m_owned_strings.emplace_back(key);
+                auto &value = m_owned_strings.emplace_back(new_value);
+                insert_entry({ {}, owned_key, value.c_str(), value.size(), &value });
+            }
+        }
+
+        /**
+         * Set the value
+         * @param key        name of the value
+         * @param new_value  new value to set to
+         */
+        void set_value(std::pair<std::string, std::string> key_value) noexcept {
+            set_value(key_value.first.c_str(), key_value.second.c_str());
+        }
+
+        /**
+         * Delete the value
+         * @param key name of the value
+         */
+        void delete_value(const char *key) noexcept {
+            auto slot = find_slot(key);
+            if(slot != NOT_FOUND) {
+                m_entries[m_slots[slot].entry].deleted = true;
+                m_slots[slot].entry = TOMBSTONE;
+                m_count--;
+            }
+        }
+
+        /**
+         * Initialize an IndexedIni from a path
+         * @param path path to initialize from
+         */
+        IndexedIni(const char *path) {
+            std::ifstream file(path, std::ios::binary | std::ios::ate);
+            if(file.is_open()) {
+                auto size = static_cast<std::size_t>(file.tellg());
+                m_buffer.resize(size + 1);
+                file.seekg(0);
+                file.read(m_buffer.data(), size);
+                m_buffer.resize(static_cast<std::size_t>(file.gcount()) + 1);
+                m_buffer.back() = '\0';
+                parse_buffer();
+            }
+        }
+
+        /**
+         * Initialize an IndexedIni from a stream
+         * @param data data to initialize from
+         */
+        IndexedIni(std::istream &stream) {
+            load_from_stream(stream);
+        }
+
+        /**
+         * Initialize an empty IndexedIni.
+         */
+        IndexedIni() = default;
+
+        /**
+         * Copy an IndexedIni
+         * @param copy ini file to copy
+         */
+        IndexedIni(const IndexedIni &copy) {
+            for(auto const &entry : copy.m_entries) {
+                if(!entry.deleted) {
+                    auto &value = m_owned_strings.emplace_back(entry.value, entry.value_length);
+                    auto &key = m_owned_strings.emplace_back(entry.full_key());
+                    insert_entry({ {}, key, value.c_str(), value.size(), &value });
+                }
+            }
+        }
+
+        /**
+         * Move an IndexedIni
+         * @param move ini file to move from
+         */
+        IndexedIni(IndexedIni &&move) = default;
+
+    private:
+        struct Entry {
+            /** Group the key was found in; empty for keys set at runtime */
+            std::string_view group;
+
+            /** Key within its group */
+            std::string_view key;
+
+            /** Null-terminated value */
+            const char *value;
+
+            /** Length of the value */
+            std::size_t value_length;
+
+            /** Storage of the value if it was set at runtime */
+            std::string *owned_value = nullptr;
+
+            bool deleted = false;
+
+            std::string full_key() const {
+                if(group.empty()) {
+                    return std::string(key);
+                }
+                std::string full_key;
+                full_key.reserve(group.size() + 1 + key.size());
+                full_key.append(group).append(1, '.').append(key);
+                return full_key;
+            }
+
+            bool matches(std::string_view full_key) const noexcept {
+                if(group.empty()) {
+                    return full_key == key;
+                }
+                return full_key.size() == group.size() + 1 + key.size() && full_key.substr(0, group.size()) == group && full_key[group.size()] == '.' && full_key.substr(group.size() + 1) == key;
+            }
+        };
+
+        struct Slot {
+            std::uint32_t hash;
+            std::uint32_t entry;
+        };
+
+        static constexpr std::uint32_t EMPTY = 0xFFFFFFFF;
+        static constexpr std::uint32_t TOMBSTONE = 0xFFFFFFFE;
+        static constexpr std::size_t NOT_FOUND = static_cast<std::size_t>(-1);
+
+        /** Contents of the file; values point into it */
+        std::vector<char> m_buffer;
+
+        /** Keys and values set at runtime; deque so the strings never move */
+        std::deque<std::string> m_owned_strings;
+
+        /** Values of the Ini */
+        std::vector<Entry> m_entries;
+
+        /** Hash table of indices into m_entries; size is a power of two */
+        std::vector<Slot> m_slots;
+
+        /** Number of live entries */
+        std::size_t m_count = 0;
+
+        /** Number of used slots, including tombstones */
+        std::size_t m_used_slots = 0;
+
+        static std::uint32_t hash_append(std::uint32_t hash, std::string_view data) noexcept {
+            for(char c : data) {
+                hash ^= static_cast<std::uint8_t>(c);
+                hash *= 16777619u;
+            }
+            return hash;
+        }
+
+        static std::uint32_t hash_key(std::string_view key) noexcept {
+            return hash_append(2166136261u, key);
+        }
+
+        static std::uint32_t hash_entry(Entry const &entry) noexcept {
+            if(entry.group.empty()) {
+                return hash_key(entry.key);
+            }
+            return hash_append(hash_append(hash_append(2166136261u, entry.group), "."), entry.key);
+        }
+
+        std::size_t find_slot(std::string_view key) const noexcept {
+            if(m_slots.empty()) {
+                return NOT_FOUND;
+            }
+            auto hash = hash_key(key);
+            std::size_t mask = m_slots.size() - 1;
+            for(std::size_t i = hash & mask; ; i = (i + 1) & mask) {
+                auto const &slot = m_slots[i];
+                if(slot.entry == EMPTY) {
+                    return NOT_FOUND;
+                }
+                if(slot.entry != TOMBSTONE && slot.hash == hash && m_entries[slot.entry].matches(key)) {
+                    return i;
+                }
+            }
+        }
+
+        Entry *find_entry(std::string_view key) noexcept {
+            auto slot = find_slot(key);
+            return slot == NOT_FOUND ? nullptr : &m_entries[m_slots[slot].entry];
+        }
+
+        Entry const *find_entry(std::string_view key) const noexcept {
+            auto slot = find_slot(key);
+            return slot == NOT_FOUND ? nullptr : &m_entries[m_slots[slot].entry];
+        }
+
+        void rehash(std::size_t capacity) {
+            std::vector<Slot> slots(capacity, Slot { 0, EMPTY });
+            std::size_t mask = capacity - 1;
+            for(auto const &slot : m_slots) {
+                if(slot.entry != EMPTY && slot.entry != TOMBSTONE) {
+                    std::size_t i = slot.hash & mask;
+                    while(slots[i].entry != EMPTY) {
+                        i = (i + 1) & mask;
+                    }
+                    slots[i] = slot;
+                }
+            }
+            m_slots = std::move(slots);
+            m_used_slots = m_count;
+        }
+
+        /**
+         * Insert an entry, replacing the value of an existing entry with the same key
+         */
+        void insert_entry(Entry entry) {
+            auto hash = hash_entry(entry);
+            if((m_used_slots + 1) * 10 > m_slots.size() * 7) {
+                std::size_t capacity = 16;
+                while((m_count + 1) * 10 > capacity * 5) {
+                    capacity *= 2;
+                }
+                rehash(capacity);
+            }
+
+            std::size_t mask = m_slots.size() - 1;
+            std::size_t insert_at = NOT_FOUND;
+            for(std::size_t i = hash & mask; ; i = (i + 1) & mask) {
+                auto &slot = m_slots[i];
+                if(slot.entry == EMPTY) {
+                    if(insert_at == NOT_FOUND) {
+                        insert_at = i;
+                        m_used_slots++;
+                    }
+                    break;
+                }
+                if(slot.entry == TOMBSTONE) {
+                    if(insert_at == NOT_FOUND) {
+                        insert_at = i;
+                    }
+                    continue;
+                }
+                auto &existing = m_entries[slot.entry];
+                if(slot.hash == hash && existing.full_key() == entry.full_key()) {
+                    existing.value = entry.value;
+                    existing.value_length = entry.value_length;
+                    existing.owned_value = entry.owned_value;
+                    return;
+                }
+            }
+
+            m_slots[insert_at] = { hash, static_cast<std::uint32_t>(m_entries.size()) };
+            m_entries.emplace_back(entry);
+            m_count++;
+        }
+
+        template<typename T>
+        std::optional<T> parse_number(const char *key) const noexcept {
+            auto *entry = find_entry(key);
+            if(!entry) {
+                return std::nullopt;
+            }
+            const char *begin = entry->value;
+            const char *end = entry->value + entry->value_length;
+            if(begin != end && *begin == '+') {
+                begin++;
+            }
+            T value {};
+            auto result = std::from_chars(begin, end, value);
+            if(result.ec != std::errc()) {
+                return std::nullopt;
+            }
+            return value;
+        }
+
+        /**
+         * Index the buffer. Values are terminated in place.
+         */
+        void parse_buffer() {
+            auto is_space = [](char c) { return c == ' ' || c == '\t' || c == '\r'; };
+            auto trim = [&](char *begin, char *end) {
+                while(begin < end && is_space(*begin)) begin++;
+                while(end > begin && is_space(*(end - 1))) end--;
+                return std::pair<char *, char *>(begin, end);
+            };
+
+            std::string_view group;
+            char *cursor = m_buffer.data();
+            char *buffer_end = m_buffer.data() + m_buffer.size() - 1;
+            while(cursor < buffer_end) {
+                char *line_end = std::find(cursor, buffer_end, '\n');
+                auto [begin, end] = trim(cursor, line_end);
+                cursor = line_end + 1;
+
+                if(begin == end || *begin == ';' || *begin == '#') {
+                    continue;
+                }
+                if(*begin == '[') {
+                    char *close = std::find(begin, end, ']');
+                    group = std::string_view(begin + 1, close - begin - 1);
+                    continue;
+                }
+                char *equals = std::find(begin, end, '=');
+                if(equals == end) {
+                    continue;
+                }
+                auto [key_begin, key_end] = trim(begin, equals);
+                auto [value_begin, value_end] = trim(equals + 1, end);
+                *value_end = '\0';
+                insert_entry({ group, std::string_view(key_begin, key_end - key_begin), value_begin, static_cast<std::size_t>(value_end - value_begin) });
+            }
+        }
+
+        /**
+         * Load from the stream
+         * @param stream stream to load from
+         */
+        void load_from_stream(std::istream &stream) {
+            m_buffer.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+            m_buffer.push_back('\0');
+            parse_buffer();
+        }
+    };
 }
 
 #endif
@@ -0,0 +1,355 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_API__CONFIG_WATCHER_HPP
+#define BALLTZE_API__CONFIG_WATCHER_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <optional>
+#include <functional>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <nlohmann/json.hpp>
+#include "config.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace Balltze::Config {
+    /**
+     * Watches the file of a config and applies external changes to it.
+     *
+     * The file is parsed on a background thread and diffed by poll(), which must be 
+     * called from the thread that owns the config (e.g. a tick event listener). Only 
+     * the keys that changed are written to the in-memory tree, and callbacks are 
+     * invoked for each of them.
+     *
+     * The file is compared against the last version of it the watcher knows of, so 
+     * only keys changed by someone else are applied. Snapshots written by this module 
+     * with save_now() or save_async() become that version as soon as they are written. 
+     * save() is implemented by the library and cannot be seen; a file it wrote is only 
+     * recognized while it still matches the in-memory tree, so use save_now() for 
+     * watched configs.
+     */
+    class ConfigWatcher {
+    public:
+        /**
+         * Callback for a changed key
+         * @param key   Dotted key that changed
+         * @param value New value; nullptr if the key was removed
+         */
+        using ChangeCallback = std::function<void(std::string const &key, nlohmann::json const *value)>;
+
+        /**
+         * A change read from the file
+         */
+        struct Change {
+            /** Dotted key that changed */
+            std::string key;
+
+            /** New value; std::nullopt if the key was removed */
+            std::optional<nlohmann::json> value;
+        };
+
+        /**
+         * Start watching the file of a config
+         * @param config    Config to watch; must outlive the watcher
+         * @throws std::runtime_error if the file cannot be watched
+         */
+        ConfigWatcher(Config &config) : m_config(config), m_baseline(config.config) {
+            ConfigWriter::get().last_written(config.filepath, m_written_serial);
+            m_filepath = std::filesystem::absolute(config.filepath);
+            m_last_write_time = file_write_time();
+            start_backend();
+            m_thread = std::thread(&ConfigWatcher::run, this);
+        }
+
+        ConfigWatcher(ConfigWatcher const &) = delete;
+        ConfigWatcher &operator=(ConfigWatcher const &) = delete;
+
+        ~ConfigWatcher() {
+            m_stop = true;
+            stop_backend();
+            if(m_thread.joinable()) {
+                m_thread.join();
+            }
+            close_backend();
+        }
+
+        /**
+         * Add a callback for a key. It is called when the key or any key below it changes.
+         * @param key       Dotted key to listen to; empty to listen to every key
+         * @param callback  Callback to call
+         */
+        void on_change(std::string key, ChangeCallback callback) {
+            m_callbacks.emplace_back(std::move(key), std::move(callback));
+        }
+
+        /**
+         * Apply the changes read from the file and call the listeners
+         * @return Number of keys changed
+         */
+        std::size_t poll() {
+            std::optional<nlohmann::json> tree;
+            std::optional<nlohmann::json> written;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                tree.swap(m_tree);
+                written.swap(m_written);
+            }
+            if(!tree) {
+                return 0;
+            }
+
+            // Our own writes are not external changes
+            if(written) {
+                m_baseline = std::move(*written);
+            }
+            if(*tree == m_baseline || *tree == m_config.config) {
+                m_baseline = std::move(*tree);
+                return 0;
+            }
+
+            auto changes = diff(m_baseline, *tree);
+            m_baseline = std::move(*tree);
+
+            std::size_t applied = 0;
+            for(auto &change : changes) {
+                ConfigKey key(change.key);
+                auto *node = m_config.find(key);
+                if(change.value) {
+                    if(node && *node == *change.value) {
+                        continue;
+                    }
+                    if(node && !node->is_structured() && !change.value->is_structured()) {
+                        *node = *change.value;
+                    }
+                    else {
+                        m_config.set(change.key, *change.value);
+                    }
+                }
+                else {
+                    if(!node) {
+                        continue;
+                    }
+                    m_config.remove(change.key);
+                }
+                applied++;
+
+                auto *value = change.value ? m_config.find(key) : nullptr;
+                for(auto &[listened_key, callback] : m_callbacks) {
+                    if(is_same_or_child(change.key, listened_key)) {
+                        callback(change.key, value);
+                    }
+                }
+            }
+            return applied;
+        }
+
+        /**
+         * Compare two trees
+         * @param old_tree  Previous tree
+         * @param new_tree  Current tree
+         * @return          Changed keys; objects are walked, anything else is compared as a whole
+         */
+        static std::vector<Change> diff(nlohmann::json const &old_tree, nlohmann::json const &new_tree) {
+            std::vector<Change> changes;
+            diff(old_tree, new_tree, "", changes);
+            return changes;
+        }
+
+    private:
+        Config &m_config;
+        std::filesystem::path m_filepath;
+        std::filesystem::file_time_type m_last_write_time;
+        nlohmann::json m_baseline;
+        std::uint64_t m_written_serial = 0;
+        std::vector<std::pair<std::string, ChangeCallback>> m_callbacks;
+        std::optional<nlohmann::json> m_tree;
+        std::optional<nlohmann::json> m_written;
+        std::mutex m_mutex;
+        std::thread m_thread;
+        std::atomic<bool> m_stop = false;
+
+        #ifdef _WIN32
+        HANDLE m_notification = INVALID_HANDLE_VALUE;
+        HANDLE m_stop_event = nullptr;
+        #else
+        int m_inotify = -1;
+        int m_stop_pipe[2] = { -1, -1 };
+        #endif
+
+        static bool is_same_or_child(std::string const &key, std::string const &parent) noexcept {
+            if(parent.empty()) {
+                return true;
+            }
+            if(key.compare(0, parent.size(), parent) != 0) {
+                return false;
+            }
+            return key.size() == parent.size() || key[parent.size()] == '.';
+        }
+
+        static void diff(nlohmann::json const &old_tree, nlohmann::json const &new_tree, std::string const &prefix, std::vector<Change> &changes) {
+            if(!old_tree.is_object() || !new_tree.is_object()) {
+                if(old_tree != new_tree) {
+                    changes.push_back({prefix, std::optional<nlohmann::json>(std::in_place, new_tree)});
+                }
+                return;
+            }
+            for(auto it = old_tree.begin(); it != old_tree.end(); it++) {
+                auto key = prefix.empty() ? it.key() : prefix + "." + it.key();
+                auto new_it = new_tree.find(it.key());
+                if(new_it == new_tree.end()) {
+                    changes.push_back({key, std::nullopt});
+                }
+                else {
+                    diff(*it, *new_it, key, changes);
+                }
+            }
+            for(auto it = new_tree.begin(); it != new_tree.end(); it++) {
+                if(!old_tree.contains(it.key())) {
+                    auto key = prefix.empty() ? it.key() : prefix + "." + it.key();
+                    changes.push_back({key, std::optional<nlohmann::json>(std::in_place, *it)});
+                }
+            }
+        }
+
+        std::filesystem::file_time_type file_write_time() const noexcept {
+            std::error_code ec;
+            auto time = std::filesystem::last_write_time(m_filepath, ec);
+            return ec ? std::filesystem::file_time_type::min() : time;
+        }
+
+        void reload() {
+            auto write_time = file_write_time();
+            if(write_time == m_last_write_time) {
+                return;
+            }
+
+            // Let the writer finish; editors usually write in several steps
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            m_last_write_time = file_write_time();
+
+            // Taken before the file is read, so the file is at least as new as the snapshot
+            auto written = ConfigWriter::get().last_written(m_filepath, m_written_serial);
+
+            std::optional<nlohmann::json> tree;
+            try {
+                std::ifstream file(m_filepath);
+                if(file.is_open()) {
+                    tree = nlohmann::json::parse(file);
+                }
+            }
+            catch(...) {
+                // Keep the last good tree until the file is fixed
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if(tree) {
+                m_tree = std::move(tree);
+            }
+            if(written) {
+                m_written = std::move(written);
+            }
+        }
+
+        #ifdef _WIN32
+        void start_backend() {
+            auto directory = m_filepath.parent_path();
+            m_notification = FindFirstChangeNotificationW(directory.wstring().c_str(), FALSE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+            if(m_notification == INVALID_HANDLE_VALUE) {
+                throw std::runtime_error("Could not watch config directory " + directory.string());
+            }
+            m_stop_event = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+            if(!m_stop_event) {
+                FindCloseChangeNotification(m_notification);
+                throw std::runtime_error("Could not create config watcher stop event");
+            }
+        }
+
+        void stop_backend() noexcept {
+            SetEvent(m_stop_event);
+        }
+
+        void close_backend() noexcept {
+            FindCloseChangeNotification(m_notification);
+            CloseHandle(m_stop_event);
+        }
+
+        void run() {
+            HANDLE handles[] = { m_notification, m_stop_event };
+            while(!m_stop) {
+                auto result = WaitForMultipleObjects(2, handles, FALSE, INFINITE);
+                if(result != WAIT_OBJECT_0) {
+                    break;
+                }
+                reload();
+                if(!FindNextChangeNotification(m_notification)) {
+                    break;
+                }
+            }
+        }
+        #else
+        void start_backend() {
+            auto directory = m_filepath.parent_path();
+            m_inotify = inotify_init1(IN_CLOEXEC);
+            if(m_inotify < 0) {
+                throw std::runtime_error("Could not initialize inotify");
+            }
+            if(inotify_add_watch(m_inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0 || pipe(m_stop_pipe) != 0) {
+                close(m_inotify);
+                throw std::runtime_error("Could not watch config directory " + directory.string());
+            }
+        }
+
+        void stop_backend() noexcept {
+            char byte = 0;
+            [[maybe_unused]] auto written = write(m_stop_pipe[1], &byte, 1);
+        }
+
+        void close_backend() noexcept {
+            close(m_inotify);
+            close(m_stop_pipe[0]);
+            close(m_stop_pipe[1]);
+        }
+
+        void run() {
+            alignas(inotify_event) char buffer[4096];
+            auto filename = m_filepath.filename().string();
+            pollfd fds[] = { { m_inotify, POLLIN, 0 }, { m_stop_pipe[0], POLLIN, 0 } };
+            while(!m_stop) {
+                if(::poll(fds, 2, -1) < 0 || (fds[1].revents & POLLIN)) {
+                    break;
+                }
+                auto length = read(m_inotify, buffer, sizeof(buffer));
+                if(length <= 0) {
+                    break;
+                }
+                bool matches = false;
+                for(char *ptr = buffer; ptr < buffer + length; ) {
+                    auto *event = reinterpret_cast<inotify_event *>(ptr);
+                    if(event->len > 0 && filename == event->name) {
+                        matches = true;
+                    }
+                    ptr += sizeof(inotify_event) + event->len;
+                }
+                if(matches) {
+                    reload();
+                }
+            }
+        }
+        #endif
+    };
+}
+
+#endif
@@ -6,7 +6,10 @@
 #include <string>
 #include <cstdio>
 #include <filesystem>
+#include <iterator>
 #include <windows.h>
+#include <fmt/format.h>
+#include <fmt/printf.h>
 #include "data_types.hpp"
 #include "../api.hpp"
 
@@ -29,24 +32,58 @@ namespace Balltze::Engine {
     /**
      * Print a message of a color in the console
      * @param color  Color to use in the message
-     * @param format String format (passed to snprintf)
+     * @param format String format (printf syntax, type-checked by fmt)
      * @param args   Additional arguments to pass
      */
     template<typename... Args> void console_printf(const ColorARGB &color, const char *format, Args... args) noexcept {
-        char message[256];
-        std::snprintf(message, sizeof(message), format, args...);
-        console_print(message, color);
+        thread_local fmt::memory_buffer buffer;
+        try {
+            // fmt has no public printf into a buffer; sprintf() would format into a new one every call
+            buffer.clear();
+            fmt::detail::vprintf(buffer, fmt::string_view(format), fmt::printf_args(fmt::make_printf_args(args...)));
+            console_print(std::string(buffer.data(), buffer.size()), color);
+        }
+        catch(fmt::format_error &e) {
+            console_print(std::string("Invalid format string: ") + e.what(), CONSOLE_COLOR_ERROR);
+        }
     }
 
     /**
      * Print a message in the console
-     * @param format String format (passed to snprintf)
+     * @param format String format (printf syntax, type-checked by fmt)
      * @param args   Additional arguments to pass
      */
     template<typename... Args> void console_printf(const char *format, Args... args) noexcept {
         console_printf(ColorARGB{1.0, 1.0, 1.0, 1.0}, format, args...);
     }
 
+    /**
+     * Print a message of a color in the console
+     * @param color  Color to use in the message
+     * @param format Format string (fmt syntax, checked at compile time)
+     * @param args   Additional arguments to pass
+     */
+    template<typename... Args> void console_format(const ColorARGB &color, fmt::format_string<Args...> format, Args &&...args) noexcept {
+        thread_local fmt::memory_buffer buffer;
+        try {
+            buffer.clear();
+            fmt::format_to(std::back_inserter(buffer), format, std::forward<Args>(args)...);
+            console_print(std::string(buffer.data(), buffer.size()), color);
+        }
+        catch(std::exception &e) {
+            console_print(std::string("Failed to format message: ") + e.what(), CONSOLE_COLOR_ERROR);
+        }
+    }
+
+    /**
+     * Print a message in the console
+     * @param format Format string (fmt syntax, checked at compile time)
+     * @param args   Additional arguments to pass
+     */
+    template<typename... Args> void console_format(fmt::format_string<Args...> format, Args &&...args) noexcept {
+        console_format(ColorARGB{1.0, 1.0, 1.0, 1.0}, format, std::forward<Args>(args)...);
+    }
+
     /**
      * Get the Halo profile path
      * @return Halo profile path
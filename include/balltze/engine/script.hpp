@@ -4,7 +4,18 @@
 #define BALLTZE_API__ENGINE__SCRIPT_HPP
 
 #include <cstdint>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <fmt/format.h>
 #include "../memory.hpp"
+#include "data_types.hpp"
 
 namespace Balltze::Engine {
     enum HscDataType : std::uint16_t {
@@ -77,6 +88,246 @@ namespace Balltze::Engine {
         }
     };
     static_assert(sizeof(HscFunctionEntry) == 0x1C);
+
+    struct HscFunctionList {
+        HscFunctionEntry **functions;
+        std::uint32_t function_count;
+    };
+
+    /**
+     * Get the script functions of the engine
+     * @return script function list
+     */
+    BALLTZE_API HscFunctionList &get_hsc_functions() noexcept;
+
+    /**
+     * Argument for script parameters that are passed by name, like objects, AI or sounds
+     * @tparam type Data type of the parameter
+     */
+    template<HscDataType type>
+    struct HscName {
+        std::string_view name;
+    };
+
+    /**
+     * Script data type of a C++ argument type
+     */
+    template<typename T, typename = void>
+    struct HscTypeOf;
+
+    template<> struct HscTypeOf<bool> { static constexpr HscDataType value = HSC_DATA_TYPE_BOOLEAN; };
+    template<> struct HscTypeOf<float> { static constexpr HscDataType value = HSC_DATA_TYPE_REAL; };
+    template<> struct HscTypeOf<std::int16_t> { static constexpr HscDataType value = HSC_DATA_TYPE_SHORT; };
+    template<> struct HscTypeOf<std::int32_t> { static constexpr HscDataType value = HSC_DATA_TYPE_LONG; };
+    template<> struct HscTypeOf<std::string_view> { static constexpr HscDataType value = HSC_DATA_TYPE_STRING; };
+    template<HscDataType type> struct HscTypeOf<HscName<type>> { static constexpr HscDataType value = type; };
+
+    /**
+     * Raw script value; accepted as the return type of any function
+     */
+    template<> struct HscTypeOf<ScenarioScriptNodeValue> { static constexpr HscDataType value = HSC_DATA_TYPE_PASSTHROUGH; };
+
+    template<typename Signature>
+    class HscFunction;
+
+    /**
+     * Script function bound to a C++ signature. Parameter and return types are checked
+     * once when the function is bound, and calls serialize the arguments into a reused
+     * buffer and hand the expression to the executor.
+     *
+     * This is not a faster way to call the function: the engine script functions read
+     * their arguments from a script thread stack frame, so the executor still has to
+     * compile and evaluate the expression like any other script string. Binding only
+     * moves the name lookup and the type checks out of the call.
+     *
+     * @tparam Return   void, or the C++ type of the return value; see HscTypeOf
+     */
+    template<typename Return, typename... Args>
+    class HscFunction<Return(Args...)> {
+    public:
+        /**
+         * Evaluates an expression; functions with a return value get the value the expression evaluated to
+         */
+        using Executor = std::conditional_t<std::is_void_v<Return>, std::function<void(const char *expression)>, std::function<ScenarioScriptNodeValue(const char *expression)>>;
+
+        HscFunction(HscFunctionEntry *entry, Executor executor) : m_entry(entry), m_executor(std::move(executor)) {
+            m_prefix = fmt::format("({}", entry->name);
+            m_buffer.reserve(m_prefix.size() + 16 * sizeof...(Args) + 1);
+        }
+
+        /**
+         * Call the function
+         * @param args  arguments
+         * @return      value returned by the function
+         */
+        Return operator()(Args... args) {
+            m_buffer.clear();
+            m_buffer.append(m_prefix);
+            (append(args), ...);
+            m_buffer.push_back(')');
+            if constexpr(std::is_void_v<Return>) {
+                m_executor(m_buffer.c_str());
+            }
+            else {
+                return value_of(m_executor(m_buffer.c_str()));
+            }
+        }
+
+        HscFunctionEntry *entry() const noexcept {
+            return m_entry;
+        }
+
+    private:
+        HscFunctionEntry *m_entry;
+        Executor m_executor;
+        std::string m_prefix;
+        std::string m_buffer;
+
+        void append(bool value) {
+            m_buffer.append(value ? " true" : " false");
+        }
+
+        void append(float value) {
+            // Keep reals in plain decimal form; fmt would write exponents, inf and nan
+            if(std::isnan(value)) {
+                value = 0.0F;
+            }
+            value = std::clamp(value, std::numeric_limits<float>::lowest(), std::numeric_limits<float>::max());
+            fmt::format_to(std::back_inserter(m_buffer), " {:.6f}", value);
+        }
+
+        void append(std::int16_t value) {
+            fmt::format_to(std::back_inserter(m_buffer), " {}", value);
+        }
+
+        void append(std::int32_t value) {
+            fmt::format_to(std::back_inserter(m_buffer), " {}", value);
+        }
+
+        void append(std::string_view value) {
+            m_buffer.append(" \"");
+            for(char c : value) {
+                if(c == '"' || c == '\\') {
+                    m_buffer.push_back('\\');
+                }
+                m_buffer.push_back(c);
+            }
+            m_buffer.push_back('"');
+        }
+
+        template<HscDataType type>
+        void append(HscName<type> value) {
+            append(value.name);
+        }
+
+        static Return value_of(ScenarioScriptNodeValue value) noexcept {
+            if constexpr(std::is_same_v<Return, bool>) {
+                return value.bool_int != 0;
+            }
+            else if constexpr(std::is_same_v<Return, float>) {
+                return value.real;
+            }
+            else if constexpr(std::is_same_v<Return, std::int16_t>) {
+                return value.short_int;
+            }
+            else if constexpr(std::is_same_v<Return, std::int32_t>) {
+                return value.long_int;
+            }
+            else {
+                static_assert(std::is_same_v<Return, ScenarioScriptNodeValue>, "unsupported script function return type");
+                return value;
+            }
+        }
+    };
+
+    /**
+     * Index of the script functions of the engine by name
+     */
+    class HscFunctionTable {
+    public:
+        /**
+         * Get the index of the engine functions for the current module; built on first use
+         */
+        static HscFunctionTable const &get() {
+            static HscFunctionTable table(get_hsc_functions());
+            return table;
+        }
+
+        /**
+         * Index a function list
+         * @param list  function list
+         */
+        HscFunctionTable(HscFunctionList const &list) : HscFunctionTable(list.functions, list.function_count) {}
+
+        /**
+         * Index a function table
+         * @param functions pointer to the array of function entries
+         * @param count     number of functions
+         */
+        HscFunctionTable(HscFunctionEntry **functions, std::size_t count) {
+            m_functions.reserve(count);
+            for(std::size_t i = 0; i < count; i++) {
+                if(functions[i] && functions[i]->name) {
+                    m_functions.emplace(functions[i]->name, functions[i]);
+                }
+            }
+        }
+
+        /**
+         * Find a function
+         * @param name  name of the function
+         * @return      function entry; nullptr if not found
+         */
+        HscFunctionEntry *find(std::string_view name) const noexcept {
+            auto it = m_functions.find(name);
+            return it != m_functions.end() ? it->second : nullptr;
+        }
+
+        std::size_t size() const noexcept {
+            return m_functions.size();
+        }
+
+        /**
+         * Bind a function to a C++ signature
+         * @tparam Signature    signature of the function, e.g. void(HscName<HSC_DATA_TYPE_OBJECT_NAME>, bool) or float(HscName<HSC_DATA_TYPE_UNIT>)
+         * @param name          name of the function
+         * @param executor      function that evaluates a script expression
+         * @return              bound function
+         * @throws std::runtime_error if the function does not exist or the signature does not match its parameters or return type
+         */
+        template<typename Signature>
+        HscFunction<Signature> bind(std::string_view name, typename HscFunction<Signature>::Executor executor) const {
+            auto *entry = find(name);
+            if(!entry) {
+                throw std::runtime_error(fmt::format("Script function {} does not exist", name));
+            }
+            check_parameters(entry, static_cast<Signature *>(nullptr));
+            return HscFunction<Signature>(entry, std::move(executor));
+        }
+
+    private:
+        std::unordered_map<std::string_view, HscFunctionEntry *> m_functions;
+
+        template<typename Return, typename... Args>
+        static void check_parameters(HscFunctionEntry *entry, Return (*)(Args...)) {
+            if constexpr(std::is_void_v<Return>) {
+                // The value of any function may be discarded
+            }
+            else if(HscTypeOf<Return>::value != HSC_DATA_TYPE_PASSTHROUGH && entry->return_type != HscTypeOf<Return>::value) {
+                throw std::runtime_error(fmt::format("Script function {} returns type {}, not {}", entry->name, static_cast<int>(entry->return_type), static_cast<int>(HscTypeOf<Return>::value)));
+            }
+            constexpr HscDataType types[] = { HscTypeOf<Args>::value..., HSC_DATA_TYPE_VOID };
+            if(entry->parameter_count != sizeof...(Args)) {
+                throw std::runtime_error(fmt::format("Script function {} takes {} parameters, not {}", entry->name, entry->parameter_count, sizeof...(Args)));
+            }
+            auto *parameters = entry->parameters();
+            for(std::size_t i = 0; i < sizeof...(Args); i++) {
+                if(parameters[i] != types[i] && parameters[i] != HSC_DATA_TYPE_PASSTHROUGH) {
+                    throw std::runtime_error(fmt::format("Parameter {} of script function {} has type {}, not {}", i + 1, entry->name, static_cast<int>(parameters[i]), static_cast<int>(types[i])));
+                }
+            }
+        }
+    };
 }
 
 #endif
@@ -0,0 +1,350 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_API__HELPERS__ADPCM_HPP
+#define BALLTZE_API__HELPERS__ADPCM_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include "parallel.hpp"
+
+/**
+ * Decoder for IMA ADPCM and Xbox ADPCM sound data.
+ *
+ * Both formats store blocks of 4-bit IMA samples. Each block starts with a 4 byte
+ * header per channel (initial sample, step index and a reserved byte) followed by
+ * the channels interleaved in 4 byte chunks. Xbox ADPCM is the IMA layout with a
+ * fixed block size of 36 bytes per channel, which holds 65 samples per channel.
+ *
+ * Blocks do not depend on each other, so they are decoded in parallel.
+ *
+ * This header does not depend on the engine; adpcm_tag.hpp gets the format of the
+ * permutations of sound tags.
+ */
+namespace Balltze::Adpcm {
+    /**
+     * Layout of ADPCM data
+     */
+    struct Format {
+        /** Number of interleaved channels */
+        std::size_t channels;
+
+        /** Size of a block in bytes, including the headers of every channel */
+        std::size_t block_align;
+    };
+
+    constexpr std::size_t HEADER_SIZE = 4;
+    constexpr std::size_t XBOX_BLOCK_SIZE = 36;
+
+    /**
+     * Get the format of Xbox ADPCM data
+     * @param channels  number of channels
+     */
+    constexpr Format xbox_format(std::size_t channels) noexcept {
+        return { channels, XBOX_BLOCK_SIZE * channels };
+    }
+
+    /**
+     * Get the number of samples per channel a block holds
+     * @param format        data format
+     * @param block_size    size of the block; smaller than block_align for the last block
+     */
+    constexpr std::size_t samples_per_block(Format const &format, std::size_t block_size) noexcept {
+        std::size_t header_size = HEADER_SIZE * format.channels;
+        if(format.channels == 0 || block_size < header_size) {
+            return 0;
+        }
+        std::size_t chunks = (block_size - header_size) / (4 * format.channels);
+        return 1 + chunks * 8;
+    }
+
+    constexpr std::size_t samples_per_block(Format const &format) noexcept {
+        return samples_per_block(format, format.block_align);
+    }
+
+    /**
+     * Get the number of samples per channel of some data
+     * @param format    data format
+     * @param size      size of the data
+     */
+    constexpr std::size_t sample_count(Format const &format, std::size_t size) noexcept {
+        if(format.block_align == 0) {
+            return 0;
+        }
+        return size / format.block_align * samples_per_block(format) + samples_per_block(format, size % format.block_align);
+    }
+
+    namespace Detail {
+        constexpr std::int16_t step_table[89] = {
+            7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+            50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+            253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+            1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+            3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487,
+            12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+        };
+
+        constexpr std::int8_t index_table[16] = { -1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8 };
+
+        struct ChannelState {
+            std::int32_t predictor;
+            std::int32_t index;
+
+            std::int16_t decode(std::uint8_t nibble) noexcept {
+                std::int32_t step = step_table[index];
+                std::int32_t difference = step >> 3;
+                if(nibble & 1) {
+                    difference += step >> 2;
+                }
+                if(nibble & 2) {
+                    difference += step >> 1;
+                }
+                if(nibble & 4) {
+                    difference += step;
+                }
+                predictor = std::clamp(nibble & 8 ? predictor - difference : predictor + difference, -32768, 32767);
+                index = std::clamp(index + index_table[nibble], 0, 88);
+                return static_cast<std::int16_t>(predictor);
+            }
+        };
+    }
+
+    /**
+     * Decode a block
+     * @param format    data format
+     * @param block     block data
+     * @param size      size of the block; may be smaller than block_align for the last block
+     * @param output    interleaved 16-bit samples; must hold samples_per_block(format, size) samples per channel
+     * @return          number of samples per channel decoded
+     */
+    inline std::size_t decode_block(Format const &format, const std::byte *block, std::size_t size, std::int16_t *output) noexcept {
+        auto *input = reinterpret_cast<const std::uint8_t *>(block);
+        std::size_t channels = format.channels;
+        std::size_t samples = samples_per_block(format, size);
+        if(samples == 0) {
+            return 0;
+        }
+
+        Detail::ChannelState states[8];
+        channels = std::min<std::size_t>(channels, 8);
+        for(std::size_t c = 0; c < channels; c++) {
+            std::int16_t predictor;
+            std::memcpy(&predictor, input + c * HEADER_SIZE, sizeof(predictor));
+            states[c] = { predictor, std::min<std::int32_t>(input[c * HEADER_SIZE + 2], 88) };
+            output[c] = predictor;
+        }
+
+        const std::uint8_t *data = input + HEADER_SIZE * format.channels;
+        std::size_t chunks = (samples - 1) / 8;
+        for(std::size_t chunk = 0; chunk < chunks; chunk++) {
+            for(std::size_t c = 0; c < channels; c++) {
+                auto &state = states[c];
+                const std::uint8_t *bytes = data + (chunk * format.channels + c) * 4;
+                std::int16_t *samples_output = output + (1 + chunk * 8) * format.channels + c;
+                for(std::size_t b = 0; b < 4; b++) {
+                    samples_output[(b * 2) * format.channels] = state.decode(bytes[b] & 0xF);
+                    samples_output[(b * 2 + 1) * format.channels] = state.decode(bytes[b] >> 4);
+                }
+            }
+        }
+        return samples;
+    }
+
+    /**
+     * Decode ADPCM data
+     * @param format    data format
+     * @param data      ADPCM data
+     * @param size      size of the data
+     * @param threads   number of threads to use; 0 to use every hardware thread
+     * @return          interleaved 16-bit samples
+     * @throws std::runtime_error if the format is not valid
+     */
+    inline std::vector<std::int16_t> decode(Format const &format, const std::byte *data, std::size_t size, std::size_t threads = 0) {
+        if(format.channels == 0 || format.channels > 8 || format.block_align <= HEADER_SIZE * format.channels) {
+            throw std::runtime_error("Invalid ADPCM format");
+        }
+        std::vector<std::int16_t> output(sample_count(format, size) * format.channels);
+        std::size_t blocks = (size + format.block_align - 1) / format.block_align;
+        std::size_t block_samples = samples_per_block(format) * format.channels;
+
+        // Group blocks so each task does a meaningful amount of work
+        constexpr std::size_t blocks_per_task = 64;
+        parallel_for((blocks + blocks_per_task - 1) / blocks_per_task, [&](std::size_t task) {
+            std::size_t end = std::min(blocks, (task + 1) * blocks_per_task);
+            for(std::size_t block = task * blocks_per_task; block < end; block++) {
+                std::size_t offset = block * format.block_align;
+                decode_block(format, data + offset, std::min(format.block_align, size - offset), output.data() + block * block_samples);
+            }
+        }, threads);
+        return output;
+    }
+
+    /**
+     * A sound data buffer to decode
+     */
+    struct Job {
+        Format format;
+        const std::byte *data;
+        std::size_t size;
+    };
+
+    /**
+     * Decode several buffers at once, e.g. every permutation of a sound. The blocks of
+     * every buffer share a single pool so short and long buffers are balanced.
+     * @param jobs      buffers to decode
+     * @param threads   number of threads to use; 0 to use every hardware thread
+     * @return          interleaved 16-bit samples of each buffer
+     */
+    inline std::vector<std::vector<std::int16_t>> decode(std::vector<Job> const &jobs, std::size_t threads = 0) {
+        struct Task {
+            std::size_t job;
+            std::size_t first_block;
+            std::size_t last_block;
+        };
+        constexpr std::size_t blocks_per_task = 64;
+        std::vector<std::vector<std::int16_t>> outputs(jobs.size());
+        std::vector<Task> tasks;
+        for(std::size_t i = 0; i < jobs.size(); i++) {
+            auto const &job = jobs[i];
+            if(job.format.channels == 0 || job.format.channels > 8 || job.format.block_align <= HEADER_SIZE * job.format.channels) {
+                throw std::runtime_error("Invalid ADPCM format");
+            }
+            outputs[i].resize(sample_count(job.format, job.size) * job.format.channels);
+            std::size_t blocks = (job.size + job.format.block_align - 1) / job.format.block_align;
+            for(std::size_t block = 0; block < blocks; block += blocks_per_task) {
+                tasks.push_back({ i, block, std::min(blocks, block + blocks_per_task) });
+            }
+        }
+
+        parallel_for(tasks.size(), [&](std::size_t i) {
+            auto const &task = tasks[i];
+            auto const &job = jobs[task.job];
+            std::size_t block_samples = samples_per_block(job.format) * job.format.channels;
+            for(std::size_t block = task.first_block; block < task.last_block; block++) {
+                std::size_t offset = block * job.format.block_align;
+                decode_block(job.format, job.data + offset, std::min(job.format.block_align, job.size - offset), outputs[task.job].data() + block * block_samples);
+            }
+        }, threads);
+        return outputs;
+    }
+
+    /**
+     * Incremental decoder with bounded memory. Data is written in pieces of any size
+     * and decoded samples are read out of a ring buffer; writes stop consuming data
+     * when the ring buffer cannot hold another block.
+     */
+    class StreamDecoder {
+    public:
+        /**
+         * @param format    data format
+         * @param capacity  number of samples per channel the output buffer holds; raised to one block
+         * @throws std::runtime_error if the format is not valid
+         */
+        StreamDecoder(Format format, std::size_t capacity = 4096) : m_format(format) {
+            if(format.channels == 0 || format.channels > 8 || format.block_align <= HEADER_SIZE * format.channels) {
+                throw std::runtime_error("Invalid ADPCM format");
+            }
+            m_block.resize(format.block_align);
+            m_decoded.resize(samples_per_block(format) * format.channels);
+            m_ring.resize(std::max(capacity, samples_per_block(format)) * format.channels);
+        }
+
+        /**
+         * Write ADPCM data
+         * @param data  data to write
+         * @param size  size of the data
+         * @return      number of bytes consumed; less than size if the output buffer is full
+         */
+        std::size_t write(const std::byte *data, std::size_t size) {
+            std::size_t consumed = 0;
+            while(consumed < size) {
+                if(m_block_size == 0 && free_space() < m_decoded.size()) {
+                    break;
+                }
+                std::size_t copy = std::min(size - consumed, m_format.block_align - m_block_size);
+                std::memcpy(m_block.data() + m_block_size, data + consumed, copy);
+                m_block_size += copy;
+                consumed += copy;
+                if(m_block_size == m_format.block_align) {
+                    flush_block();
+                }
+            }
+            return consumed;
+        }
+
+        /**
+         * Decode the last, partial block. Call it once all the data was written.
+         * @return whether the output buffer had room for it
+         */
+        bool finish() {
+            if(m_block_size == 0) {
+                return true;
+            }
+            if(free_space() < m_decoded.size()) {
+                return false;
+            }
+            flush_block();
+            return true;
+        }
+
+        /**
+         * Read decoded samples
+         * @param output    interleaved 16-bit samples
+         * @param frames    maximum number of samples per channel to read
+         * @return          number of samples per channel read
+         */
+        std::size_t read(std::int16_t *output, std::size_t frames) noexcept {
+            std::size_t count = std::min(frames * m_format.channels, m_used);
+            std::size_t first = std::min(count, m_ring.size() - m_read);
+            std::memcpy(output, m_ring.data() + m_read, first * sizeof(std::int16_t));
+            std::memcpy(output + first, m_ring.data(), (count - first) * sizeof(std::int16_t));
+            m_read = (m_read + count) % m_ring.size();
+            m_used -= count;
+            return count / m_format.channels;
+        }
+
+        /**
+         * Get the number of samples per channel ready to be read
+         */
+        std::size_t available() const noexcept {
+            return m_used / m_format.channels;
+        }
+
+        /**
+         * Discard every pending sample and partial block
+         */
+        void reset() noexcept {
+            m_block_size = 0;
+            m_read = 0;
+            m_used = 0;
+        }
+
+    private:
+        Format m_format;
+        std::vector<std::byte> m_block;
+        std::size_t m_block_size = 0;
+        std::vector<std::int16_t> m_decoded;
+        std::vector<std::int16_t> m_ring;
+        std::size_t m_read = 0;
+        std::size_t m_used = 0;
+
+        std::size_t free_space() const noexcept {
+            return m_ring.size() - m_used;
+        }
+
+        void flush_block() noexcept {
+            std::size_t count = decode_block(m_format, m_block.data(), m_block_size, m_decoded.data()) * m_format.channels;
+            m_block_size = 0;
+            std::size_t write = (m_read + m_used) % m_ring.size();
+            std::size_t first = std::min(count, m_ring.size() - write);
+            std::memcpy(m_ring.data() + write, m_decoded.data(), first * sizeof(std::int16_t));
+            std::memcpy(m_ring.data(), m_decoded.data() + first, (count - first) * sizeof(std::int16_t));
+            m_used += count;
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,32 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_API__HELPERS__ADPCM_TAG_HPP
+#define BALLTZE_API__HELPERS__ADPCM_TAG_HPP
+
+#include <cstddef>
+#include <stdexcept>
+#include "../engine/tag_definitions/sound.hpp"
+#include "adpcm.hpp"
+
+/**
+ * ADPCM decoder entry points for the permutations of sound tags
+ */
+namespace Balltze::Adpcm {
+    /**
+     * Get the format of a sound
+     * @param format        format of the permutation
+     * @param channel_count channel count of the sound
+     * @throws std::runtime_error if the format is not ADPCM
+     */
+    inline Format sound_format(Engine::TagDefinitions::SoundFormat format, Engine::TagDefinitions::SoundChannelCount channel_count) {
+        using namespace Engine::TagDefinitions;
+        std::size_t channels = channel_count == SOUND_CHANNEL_COUNT_STEREO ? 2 : 1;
+        if(format != SOUND_FORMAT_XBOX_ADPCM && format != SOUND_FORMAT_IMA_ADPCM) {
+            throw std::runtime_error("Sound format is not ADPCM");
+        }
+        // Halo stores IMA ADPCM with the same block size as Xbox ADPCM
+        return xbox_format(channels);
+    }
+}
+
+#endif
@@ -0,0 +1,767 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_API__HELPERS__BITMAP_CODEC_HPP
+#define BALLTZE_API__HELPERS__BITMAP_CODEC_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include <string>
+#include "parallel.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BALLTZE_BITMAP_CODEC_SSE2
+#include <emmintrin.h>
+#endif
+
+/**
+ * Conversion of bitmap pixel data from and to RGBA8 (R, G, B, A byte order).
+ *
+ * DXT blocks are decoded with SSE2 when the compiler targets it; everything else
+ * is portable C++. Swizzled data and P8 bump maps are not supported.
+ */
+namespace Balltze::BitmapCodec {
+    /**
+     * Pixel format; the values are the ones of the bitmap data formats of bitmap tags
+     */
+    enum Format : std::uint16_t {
+        FORMAT_A8 = 0,
+        FORMAT_Y8,
+        FORMAT_AY8,
+        FORMAT_A8Y8,
+        FORMAT_UNUSED1,
+        FORMAT_UNUSED2,
+        FORMAT_R5G6B5,
+        FORMAT_UNUSED3,
+        FORMAT_A1R5G5B5,
+        FORMAT_A4R4G4B4,
+        FORMAT_X8R8G8B8,
+        FORMAT_A8R8G8B8,
+        FORMAT_UNUSED4,
+        FORMAT_UNUSED5,
+        FORMAT_DXT1,
+        FORMAT_DXT3,
+        FORMAT_DXT5,
+        FORMAT_P8_BUMP
+    };
+
+    /**
+     * RGBA8 image
+     */
+    struct Image {
+        std::uint32_t width = 0;
+        std::uint32_t height = 0;
+        std::vector<std::uint8_t> pixels;
+
+        Image() = default;
+        Image(std::uint32_t width, std::uint32_t height) : width(width), height(height), pixels(static_cast<std::size_t>(width) * height * 4) {}
+    };
+
+    /**
+     * Whether a format is stored in 4x4 blocks
+     */
+    constexpr bool is_block_compressed(Format format) noexcept {
+        return format == FORMAT_DXT1 || format == FORMAT_DXT3 || format == FORMAT_DXT5;
+    }
+
+    /**
+     * Get the number of bits per pixel of a format
+     * @return Bits per pixel; 0 if the format is not supported
+     */
+    constexpr std::size_t bits_per_pixel(Format format) noexcept {
+        switch(format) {
+            case FORMAT_DXT1:
+                return 4;
+            case FORMAT_A8:
+            case FORMAT_Y8:
+            case FORMAT_AY8:
+            case FORMAT_DXT3:
+            case FORMAT_DXT5:
+                return 8;
+            case FORMAT_A8Y8:
+            case FORMAT_R5G6B5:
+            case FORMAT_A1R5G5B5:
+            case FORMAT_A4R4G4B4:
+                return 16;
+            case FORMAT_X8R8G8B8:
+            case FORMAT_A8R8G8B8:
+                return 32;
+            default:
+                return 0;
+        }
+    }
+
+    /**
+     * Get the size of a surface
+     * @param format    format of the surface
+     * @param width     width in pixels
+     * @param height    height in pixels
+     * @return          size in bytes; block compressed surfaces are rounded up to whole blocks
+     */
+    constexpr std::size_t surface_size(Format format, std::uint32_t width, std::uint32_t height) noexcept {
+        if(is_block_compressed(format)) {
+            std::size_t blocks = static_cast<std::size_t>((width + 3) / 4) * ((height + 3) / 4);
+            return blocks * bits_per_pixel(format) * 2;
+        }
+        return static_cast<std::size_t>(width) * height * bits_per_pixel(format) / 8;
+    }
+
+    namespace Detail {
+        inline void check_format(Format format) {
+            if(bits_per_pixel(format) == 0) {
+                throw std::runtime_error("Unsupported bitmap data format " + std::to_string(format));
+            }
+        }
+
+        template<typename T>
+        inline T load(const std::uint8_t *data) noexcept {
+            T value;
+            std::memcpy(&value, data, sizeof(T));
+            return value;
+        }
+
+        template<typename T>
+        inline void store(std::uint8_t *data, T value) noexcept {
+            std::memcpy(data, &value, sizeof(T));
+        }
+
+        inline std::uint8_t expand5(std::uint32_t value) noexcept {
+            return static_cast<std::uint8_t>((value << 3) | (value >> 2));
+        }
+
+        inline std::uint8_t expand6(std::uint32_t value) noexcept {
+            return static_cast<std::uint8_t>((value << 2) | (value >> 4));
+        }
+
+        inline std::uint8_t expand4(std::uint32_t value) noexcept {
+            return static_cast<std::uint8_t>(value * 0x11);
+        }
+
+        inline std::uint32_t quantize(std::uint32_t value, std::uint32_t max) noexcept {
+            return (value * max + 127) / 255;
+        }
+
+        inline std::uint32_t pack_rgba(std::uint32_t r, std::uint32_t g, std::uint32_t b, std::uint32_t a) noexcept {
+            std::uint8_t bytes[4] = { static_cast<std::uint8_t>(r), static_cast<std::uint8_t>(g), static_cast<std::uint8_t>(b), static_cast<std::uint8_t>(a) };
+            return load<std::uint32_t>(bytes);
+        }
+
+        inline std::uint16_t to_565(const std::uint8_t *rgba) noexcept {
+            return static_cast<std::uint16_t>((quantize(rgba[0], 31) << 11) | (quantize(rgba[1], 63) << 5) | quantize(rgba[2], 31));
+        }
+
+        /**
+         * Build the 4 color palette of a DXT block as packed RGBA8
+         */
+        inline void color_palette(std::uint16_t color0, std::uint16_t color1, bool allow_transparent, std::uint32_t *palette) noexcept {
+            std::uint32_t r0 = expand5(color0 >> 11), g0 = expand6((color0 >> 5) & 0x3F), b0 = expand5(color0 & 0x1F);
+            std::uint32_t r1 = expand5(color1 >> 11), g1 = expand6((color1 >> 5) & 0x3F), b1 = expand5(color1 & 0x1F);
+            bool four_colors = !allow_transparent || color0 > color1;
+
+            #ifdef BALLTZE_BITMAP_CODEC_SSE2
+            __m128i c0 = _mm_setr_epi16(r0, g0, b0, 255, r0, g0, b0, 255);
+            __m128i c1 = _mm_setr_epi16(r1, g1, b1, 255, r1, g1, b1, 255);
+            __m128i interpolated;
+            if(four_colors) {
+                // (2a + b) / 3 and (a + 2b) / 3; the multiply-high by 21846 is an exact division by 3 in this range
+                __m128i lo = _mm_unpacklo_epi64(c0, c1);
+                __m128i hi = _mm_unpacklo_epi64(c1, c0);
+                __m128i sum = _mm_add_epi16(_mm_add_epi16(lo, lo), hi);
+                interpolated = _mm_mulhi_epu16(sum, _mm_set1_epi16(21846));
+            }
+            else {
+                interpolated = _mm_srli_epi16(_mm_add_epi16(c0, c1), 1);
+                interpolated = _mm_insert_epi16(interpolated, 0, 4);
+                interpolated = _mm_insert_epi16(interpolated, 0, 5);
+                interpolated = _mm_insert_epi16(interpolated, 0, 6);
+                interpolated = _mm_insert_epi16(interpolated, 0, 7);
+            }
+            __m128i endpoints = _mm_unpacklo_epi64(c0, c1);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(palette), _mm_packus_epi16(endpoints, interpolated));
+            #else
+            palette[0] = pack_rgba(r0, g0, b0, 255);
+            palette[1] = pack_rgba(r1, g1, b1, 255);
+            if(four_colors) {
+                palette[2] = pack_rgba((2 * r0 + r1) / 3, (2 * g0 + g1) / 3, (2 * b0 + b1) / 3, 255);
+                palette[3] = pack_rgba((r0 + 2 * r1) / 3, (g0 + 2 * g1) / 3, (b0 + 2 * b1) / 3, 255);
+            }
+            else {
+                palette[2] = pack_rgba((r0 + r1) / 2, (g0 + g1) / 2, (b0 + b1) / 2, 255);
+                palette[3] = 0;
+            }
+            #endif
+        }
+
+        /**
+         * Build the 8 alpha palette of a DXT5 block
+         */
+        inline void alpha_palette(std::uint32_t alpha0, std::uint32_t alpha1, std::uint8_t *palette) noexcept {
+            palette[0] = static_cast<std::uint8_t>(alpha0);
+            palette[1] = static_cast<std::uint8_t>(alpha1);
+            if(alpha0 > alpha1) {
+                for(std::uint32_t i = 1; i < 7; i++) {
+                    palette[i + 1] = static_cast<std::uint8_t>(((7 - i) * alpha0 + i * alpha1) / 7);
+                }
+            }
+            else {
+                for(std::uint32_t i = 1; i < 5; i++) {
+                    palette[i + 1] = static_cast<std::uint8_t>(((5 - i) * alpha0 + i * alpha1) / 5);
+                }
+                palette[6] = 0;
+                palette[7] = 255;
+            }
+        }
+
+        /**
+         * Decode a DXT block into a 4x4 array of packed RGBA8 pixels
+         */
+        inline void decode_block(Format format, const std::uint8_t *block, std::uint32_t *pixels) noexcept {
+            const std::uint8_t *color_block = format == FORMAT_DXT1 ? block : block + 8;
+            std::uint32_t palette[4];
+            color_palette(load<std::uint16_t>(color_block), load<std::uint16_t>(color_block + 2), format == FORMAT_DXT1, palette);
+            std::uint32_t indices = load<std::uint32_t>(color_block + 4);
+
+            for(std::size_t y = 0; y < 4; y++) {
+                std::uint32_t row = indices >> (y * 8);
+                #ifdef BALLTZE_BITMAP_CODEC_SSE2
+                __m128i colors = _mm_setr_epi32(palette[row & 3], palette[(row >> 2) & 3], palette[(row >> 4) & 3], palette[(row >> 6) & 3]);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(pixels + y * 4), colors);
+                #else
+                for(std::size_t x = 0; x < 4; x++) {
+                    pixels[y * 4 + x] = palette[(row >> (x * 2)) & 3];
+                }
+                #endif
+            }
+
+            if(format == FORMAT_DXT3) {
+                std::uint64_t alpha = load<std::uint64_t>(block);
+                for(std::size_t i = 0; i < 16; i++) {
+                    auto *pixel = reinterpret_cast<std::uint8_t *>(pixels + i);
+                    pixel[3] = expand4((alpha >> (i * 4)) & 0xF);
+                }
+            }
+            else if(format == FORMAT_DXT5) {
+                std::uint8_t alphas[8];
+                alpha_palette(block[0], block[1], alphas);
+                std::uint64_t alpha_indices = 0;
+                std::memcpy(&alpha_indices, block + 2, 6);
+                for(std::size_t i = 0; i < 16; i++) {
+                    auto *pixel = reinterpret_cast<std::uint8_t *>(pixels + i);
+                    pixel[3] = alphas[(alpha_indices >> (i * 3)) & 7];
+                }
+            }
+        }
+
+        inline std::uint32_t color_distance(std::uint32_t a, std::uint32_t b) noexcept {
+            auto *ca = reinterpret_cast<const std::uint8_t *>(&a);
+            auto *cb = reinterpret_cast<const std::uint8_t *>(&b);
+            std::uint32_t distance = 0;
+            for(std::size_t i = 0; i < 3; i++) {
+                std::int32_t delta = static_cast<std::int32_t>(ca[i]) - cb[i];
+                distance += delta * delta;
+            }
+            return distance;
+        }
+
+        /**
+         * Encode the color part of a DXT block with a range fit
+         */
+        inline void encode_color_block(const std::uint8_t *pixels, bool allow_transparent, std::uint8_t *output) noexcept {
+            std::uint8_t min[3] = { 255, 255, 255 };
+            std::uint8_t max[3] = { 0, 0, 0 };
+            bool transparent = false;
+            for(std::size_t i = 0; i < 16; i++) {
+                auto *pixel = pixels + i * 4;
+                if(allow_transparent && pixel[3] < 128) {
+                    transparent = true;
+                    continue;
+                }
+                for(std::size_t c = 0; c < 3; c++) {
+                    min[c] = std::min(min[c], pixel[c]);
+                    max[c] = std::max(max[c], pixel[c]);
+                }
+            }
+            if(min[0] > max[0]) {
+                std::memset(min, 0, sizeof(min));
+                std::memset(max, 0, sizeof(max));
+            }
+
+            // Inset the box to reduce the error of the extremes
+            std::uint8_t endpoint0[3], endpoint1[3];
+            for(std::size_t c = 0; c < 3; c++) {
+                std::uint32_t inset = (max[c] - min[c]) / 16;
+                endpoint0[c] = static_cast<std::uint8_t>(max[c] - inset);
+                endpoint1[c] = static_cast<std::uint8_t>(min[c] + inset);
+            }
+            std::uint16_t color0 = to_565(endpoint0);
+            std::uint16_t color1 = to_565(endpoint1);
+
+            // Four color mode needs color0 > color1 and three color mode the opposite
+            if(transparent ? color0 > color1 : color0 < color1) {
+                std::swap(color0, color1);
+            }
+            bool four_colors = !allow_transparent || color0 > color1;
+            if(!transparent && !four_colors) {
+                // Both endpoints quantized to the same color; any index decodes to it
+                store<std::uint16_t>(output, color0);
+                store<std::uint16_t>(output + 2, color1);
+                store<std::uint32_t>(output + 4, 0);
+                return;
+            }
+
+            std::uint32_t palette[4];
+            color_palette(color0, color1, allow_transparent, palette);
+            std::size_t colors = four_colors ? 4 : 3;
+            std::uint32_t indices = 0;
+            for(std::size_t i = 0; i < 16; i++) {
+                auto *pixel = pixels + i * 4;
+                std::uint32_t index = 3;
+                if(!(transparent && pixel[3] < 128)) {
+                    std::uint32_t color = pack_rgba(pixel[0], pixel[1], pixel[2], 255);
+                    std::uint32_t best = UINT32_MAX;
+                    for(std::uint32_t p = 0; p < colors; p++) {
+                        auto distance = color_distance(color, palette[p]);
+                        if(distance < best) {
+                            best = distance;
+                            index = p;
+                        }
+                    }
+                }
+                indices |= index << (i * 2);
+            }
+            store<std::uint16_t>(output, color0);
+            store<std::uint16_t>(output + 2, color1);
+            store<std::uint32_t>(output + 4, indices);
+        }
+
+        inline void encode_alpha_block(const std::uint8_t *pixels, std::uint8_t *output) noexcept {
+            std::uint8_t min = 255, max = 0;
+            for(std::size_t i = 0; i < 16; i++) {
+                min = std::min(min, pixels[i * 4 + 3]);
+                max = std::max(max, pixels[i * 4 + 3]);
+            }
+            output[0] = max;
+            output[1] = min;
+            std::uint8_t palette[8];
+            alpha_palette(max, min, palette);
+            std::uint64_t indices = 0;
+            if(max != min) {
+                for(std::size_t i = 0; i < 16; i++) {
+                    std::int32_t alpha = pixels[i * 4 + 3];
+                    std::uint64_t index = 0;
+                    std::int32_t best = INT32_MAX;
+                    for(std::uint32_t p = 0; p < 8; p++) {
+                        std::int32_t distance = std::abs(alpha - palette[p]);
+                        if(distance < best) {
+                            best = distance;
+                            index = p;
+                        }
+                    }
+                    indices |= index << (i * 3);
+                }
+            }
+            std::memcpy(output + 2, &indices, 6);
+        }
+
+        inline void decode_pixel(Format format, const std::uint8_t *input, std::uint8_t *output) noexcept {
+            switch(format) {
+                case FORMAT_A8:
+                    output[0] = output[1] = output[2] = 255;
+                    output[3] = input[0];
+                    break;
+                case FORMAT_Y8:
+                    output[0] = output[1] = output[2] = input[0];
+                    output[3] = 255;
+                    break;
+                case FORMAT_AY8:
+                    output[0] = output[1] = output[2] = output[3] = input[0];
+                    break;
+                case FORMAT_A8Y8:
+                    output[0] = output[1] = output[2] = input[0];
+                    output[3] = input[1];
+                    break;
+                case FORMAT_R5G6B5: {
+                    auto value = load<std::uint16_t>(input);
+                    output[0] = expand5(value >> 11);
+                    output[1] = expand6((value >> 5) & 0x3F);
+                    output[2] = expand5(value & 0x1F);
+                    output[3] = 255;
+                    break;
+                }
+                case FORMAT_A1R5G5B5: {
+                    auto value = load<std::uint16_t>(input);
+                    output[0] = expand5((value >> 10) & 0x1F);
+                    output[1] = expand5((value >> 5) & 0x1F);
+                    output[2] = expand5(value & 0x1F);
+                    output[3] = (value & 0x8000) ? 255 : 0;
+                    break;
+                }
+                case FORMAT_A4R4G4B4: {
+                    auto value = load<std::uint16_t>(input);
+                    output[0] = expand4((value >> 8) & 0xF);
+                    output[1] = expand4((value >> 4) & 0xF);
+                    output[2] = expand4(value & 0xF);
+                    output[3] = expand4(value >> 12);
+                    break;
+                }
+                case FORMAT_X8R8G8B8:
+                case FORMAT_A8R8G8B8:
+                    output[0] = input[2];
+                    output[1] = input[1];
+                    output[2] = input[0];
+                    output[3] = format == FORMAT_A8R8G8B8 ? input[3] : 255;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        inline void encode_pixel(Format format, const std::uint8_t *input, std::uint8_t *output) noexcept {
+            auto luminance = static_cast<std::uint8_t>((77 * input[0] + 150 * input[1] + 29 * input[2] + 128) >> 8);
+            switch(format) {
+                case FORMAT_A8:
+                    output[0] = input[3];
+                    break;
+                case FORMAT_Y8:
+                case FORMAT_AY8:
+                    output[0] = luminance;
+                    break;
+                case FORMAT_A8Y8:
+                    output[0] = luminance;
+                    output[1] = input[3];
+                    break;
+                case FORMAT_R5G6B5:
+                    store<std::uint16_t>(output, to_565(input));
+                    break;
+                case FORMAT_A1R5G5B5:
+                    store<std::uint16_t>(output, static_cast<std::uint16_t>((input[3] >= 128 ? 0x8000 : 0) | (quantize(input[0], 31) << 10) | (quantize(input[1], 31) << 5) | quantize(input[2], 31)));
+                    break;
+                case FORMAT_A4R4G4B4:
+                    store<std::uint16_t>(output, static_cast<std::uint16_t>((quantize(input[3], 15) << 12) | (quantize(input[0], 15) << 8) | (quantize(input[1], 15) << 4) | quantize(input[2], 15)));
+                    break;
+                case FORMAT_X8R8G8B8:
+                case FORMAT_A8R8G8B8:
+                    output[0] = input[2];
+                    output[1] = input[1];
+                    output[2] = input[0];
+                    output[3] = format == FORMAT_A8R8G8B8 ? input[3] : 255;
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    /**
+     * Decode rows of a surface to RGBA8
+     * @param format        format of the surface
+     * @param data          pixel data of the whole surface
+     * @param width         width of the surface
+     * @param height        height of the surface
+     * @param first_row     first row to decode; must be a multiple of 4 for block compressed formats
+     * @param last_row      row after the last one to decode
+     * @param output        RGBA8 pixels of the whole surface
+     * @throws std::runtime_error if the format is not supported
+     */
+    inline void decode_rows(Format format, const std::byte *data, std::uint32_t width, std::uint32_t height, std::uint32_t first_row, std::uint32_t last_row, std::uint8_t *output) {
+        Detail::check_format(format);
+        auto *input = reinterpret_cast<const std::uint8_t *>(data);
+        last_row = std::min(last_row, height);
+
+        if(is_block_compressed(format)) {
+            std::size_t block_size = bits_per_pixel(format) * 2;
+            std::size_t blocks_per_row = (width + 3) / 4;
+            for(std::uint32_t block_y = first_row / 4; block_y * 4 < last_row; block_y++) {
+                for(std::uint32_t block_x = 0; block_x < blocks_per_row; block_x++) {
+                    alignas(16) std::uint32_t pixels[16];
+                    Detail::decode_block(format, input + (block_y * blocks_per_row + block_x) * block_size, pixels);
+                    std::uint32_t copy_width = std::min<std::uint32_t>(4, width - block_x * 4);
+                    std::uint32_t copy_height = std::min<std::uint32_t>(4, last_row - block_y * 4);
+                    for(std::uint32_t y = 0; y < copy_height; y++) {
+                        auto *row = output + ((static_cast<std::size_t>(block_y) * 4 + y) * width + block_x * 4) * 4;
+                        std::memcpy(row, pixels + y * 4, copy_width * 4);
+                    }
+                }
+            }
+            return;
+        }
+
+        std::size_t pixel_size = bits_per_pixel(format) / 8;
+        for(std::size_t y = first_row; y < last_row; y++) {
+            const std::uint8_t *source = input + y * width * pixel_size;
+            std::uint8_t *destination = output + y * width * 4;
+            for(std::size_t x = 0; x < width; x++) {
+                Detail::decode_pixel(format, source + x * pixel_size, destination + x * 4);
+            }
+        }
+    }
+
+    /**
+     * Decode a surface to RGBA8
+     * @param format    format of the surface
+     * @param data      pixel data; must be at least surface_size(format, width, height) bytes
+     * @param width     width of the surface
+     * @param height    height of the surface
+     * @return          decoded image
+     * @throws std::runtime_error if the format is not supported
+     */
+    inline Image decode(Format format, const std::byte *data, std::uint32_t width, std::uint32_t height) {
+        Image image(width, height);
+        decode_rows(format, data, width, height, 0, height, image.pixels.data());
+        return image;
+    }
+
+    /**
+     * Encode an RGBA8 image
+     * @param format    format to encode to
+     * @param image     image to encode
+     * @param output    output buffer; must be at least surface_size(format, width, height) bytes
+     * @throws std::runtime_error if the format is not supported
+     */
+    inline void encode(Format format, Image const &image, std::byte *output) {
+        Detail::check_format(format);
+        auto *destination = reinterpret_cast<std::uint8_t *>(output);
+
+        if(is_block_compressed(format)) {
+            std::size_t block_size = bits_per_pixel(format) * 2;
+            std::size_t blocks_per_row = (image.width + 3) / 4;
+            for(std::uint32_t block_y = 0; block_y * 4 < image.height; block_y++) {
+                for(std::uint32_t block_x = 0; block_x * 4 < image.width; block_x++) {
+                    // Pad partial blocks by repeating the edge pixels
+                    std::uint8_t pixels[16 * 4];
+                    for(std::uint32_t y = 0; y < 4; y++) {
+                        for(std::uint32_t x = 0; x < 4; x++) {
+                            std::uint32_t source_x = std::min(block_x * 4 + x, image.width - 1);
+                            std::uint32_t source_y = std::min(block_y * 4 + y, image.height - 1);
+                            std::memcpy(pixels + (y * 4 + x) * 4, image.pixels.data() + (static_cast<std::size_t>(source_y) * image.width + source_x) * 4, 4);
+                        }
+                    }
+                    auto *block = destination + (block_y * blocks_per_row + block_x) * block_size;
+                    if(format == FORMAT_DXT1) {
+                        Detail::encode_color_block(pixels, true, block);
+                    }
+                    else {
+                        if(format == FORMAT_DXT3) {
+                            std::uint64_t alpha = 0;
+                            for(std::size_t i = 0; i < 16; i++) {
+                                alpha |= static_cast<std::uint64_t>(Detail::quantize(pixels[i * 4 + 3], 15)) << (i * 4);
+                            }
+                            Detail::store(block, alpha);
+                        }
+                        else {
+                            Detail::encode_alpha_block(pixels, block);
+                        }
+                        Detail::encode_color_block(pixels, false, block + 8);
+                    }
+                }
+            }
+            return;
+        }
+
+        std::size_t pixel_size = bits_per_pixel(format) / 8;
+        std::size_t pixel_count = static_cast<std::size_t>(image.width) * image.height;
+        for(std::size_t i = 0; i < pixel_count; i++) {
+            Detail::encode_pixel(format, image.pixels.data() + i * 4, destination + i * pixel_size);
+        }
+    }
+
+    /**
+     * Encode an RGBA8 image
+     * @param format    format to encode to
+     * @param image     image to encode
+     * @return          encoded pixel data
+     * @throws std::runtime_error if the format is not supported
+     */
+    inline std::vector<std::byte> encode(Format format, Image const &image) {
+        Detail::check_format(format);
+        std::vector<std::byte> output(surface_size(format, image.width, image.height));
+        encode(format, image, output.data());
+        return output;
+    }
+
+    /**
+     * Downsample an image to half its size with a 2x2 box filter: each pixel is the
+     * average of the four pixels it covers. Colors are weighted by alpha so fully
+     * transparent pixels do not bleed into their neighbors. A box filter is fast but
+     * blurs more and aliases more than wider kernels such as Kaiser or Lanczos; images
+     * with fine high-frequency detail may want their mipmaps generated offline.
+     * Odd sizes repeat the last row or column.
+     * @param image     image to downsample
+     * @param threads   number of threads to use; 0 to use every hardware thread
+     * @return          next mipmap
+     */
+    inline Image downsample(Image const &image, std::size_t threads = 0) {
+        Image mipmap(std::max<std::uint32_t>(1, image.width / 2), std::max<std::uint32_t>(1, image.height / 2));
+        constexpr std::uint32_t rows_per_task = 64;
+        std::size_t tasks = (mipmap.height + rows_per_task - 1) / rows_per_task;
+        parallel_for(tasks, [&](std::size_t task) {
+            std::uint32_t first_row = static_cast<std::uint32_t>(task) * rows_per_task;
+            std::uint32_t last_row = std::min(first_row + rows_per_task, mipmap.height);
+            for(std::uint32_t y = first_row; y < last_row; y++) {
+                std::uint32_t y0 = std::min(y * 2, image.height - 1);
+                std::uint32_t y1 = std::min(y * 2 + 1, image.height - 1);
+                for(std::uint32_t x = 0; x < mipmap.width; x++) {
+                    std::uint32_t x0 = std::min(x * 2, image.width - 1);
+                    std::uint32_t x1 = std::min(x * 2 + 1, image.width - 1);
+                    const std::uint8_t *samples[4] = {
+                        image.pixels.data() + (static_cast<std::size_t>(y0) * image.width + x0) * 4,
+                        image.pixels.data() + (static_cast<std::size_t>(y0) * image.width + x1) * 4,
+                        image.pixels.data() + (static_cast<std::size_t>(y1) * image.width + x0) * 4,
+                        image.pixels.data() + (static_cast<std::size_t>(y1) * image.width + x1) * 4
+                    };
+                    std::uint32_t alpha = 0;
+                    std::uint32_t weighted[3] = {};
+                    std::uint32_t plain[3] = {};
+                    for(auto *sample : samples) {
+                        alpha += sample[3];
+                        for(std::size_t c = 0; c < 3; c++) {
+                            weighted[c] += sample[c] * sample[3];
+                            plain[c] += sample[c];
+                        }
+                    }
+                    auto *output = mipmap.pixels.data() + (static_cast<std::size_t>(y) * mipmap.width + x) * 4;
+                    for(std::size_t c = 0; c < 3; c++) {
+                        output[c] = static_cast<std::uint8_t>(alpha > 0 ? (weighted[c] + alpha / 2) / alpha : (plain[c] + 2) / 4);
+                    }
+                    output[3] = static_cast<std::uint8_t>((alpha + 2) / 4);
+                }
+            }
+        }, threads);
+        return mipmap;
+    }
+
+    /**
+     * Generate a mipmap chain by repeatedly downsampling with the box filter of downsample()
+     * @param image     base level
+     * @param count     number of mipmaps to generate, not counting the base level;
+     *                  generation stops at 1x1 regardless
+     * @param threads   number of threads to use; 0 to use every hardware thread
+     * @return          mipmaps, from the largest to the smallest
+     */
+    inline std::vector<Image> generate_mipmaps(Image const &image, std::size_t count, std::size_t threads = 0) {
+        std::vector<Image> mipmaps;
+        Image const *previous = &image;
+        while(mipmaps.size() < count && (previous->width > 1 || previous->height > 1)) {
+            mipmaps.emplace_back(downsample(*previous, threads));
+            previous = &mipmaps.back();
+        }
+        return mipmaps;
+    }
+
+    /**
+     * A surface of a bitmap
+     */
+    struct Surface {
+        /** Mipmap level; 0 is the base level */
+        std::uint16_t mipmap;
+
+        /** Cube map face or 3D texture slice */
+        std::uint16_t layer;
+
+        std::uint32_t width;
+        std::uint32_t height;
+
+        /** Offset of the surface in the pixel data of the bitmap */
+        std::size_t offset;
+
+        /** Size of the surface in bytes */
+        std::size_t size;
+    };
+
+    /**
+     * Get the surfaces of a texture. Every mipmap holds its six cube map faces or
+     * its 3D texture slices one after another.
+     * @param format        format of the pixel data
+     * @param width         width of the base level
+     * @param height        height of the base level
+     * @param depth         depth of the base level of a 3D texture; 1 otherwise
+     * @param mipmap_count  number of mipmaps, not counting the base level
+     * @param cube_map      whether the texture is a cube map
+     * @return              surfaces in the order they are stored
+     */
+    inline std::vector<Surface> surfaces(Format format, std::uint32_t width, std::uint32_t height, std::uint32_t depth, std::uint16_t mipmap_count, bool cube_map) {
+        std::vector<Surface> result;
+        std::size_t offset = 0;
+        for(std::uint16_t mipmap = 0; mipmap <= mipmap_count; mipmap++) {
+            std::uint32_t mipmap_width = std::max<std::uint32_t>(1, width >> mipmap);
+            std::uint32_t mipmap_height = std::max<std::uint32_t>(1, height >> mipmap);
+            std::uint16_t layers = cube_map ? 6 : static_cast<std::uint16_t>(std::max<std::uint32_t>(1, depth >> mipmap));
+            std::size_t size = surface_size(format, mipmap_width, mipmap_height);
+            for(std::uint16_t layer = 0; layer < layers; layer++) {
+                result.push_back({ mipmap, layer, mipmap_width, mipmap_height, offset, size });
+                offset += size;
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Decode several surfaces of a texture. Work is split in row ranges so large and
+     * small mipmaps are decoded in parallel.
+     * @param format    format of the pixel data
+     * @param layout    surfaces to decode, e.g. from surfaces()
+     * @param pixels    pixel data of the texture
+     * @param size      size of the pixel data
+     * @param threads   number of threads to use; 0 to use every hardware thread
+     * @return          decoded surfaces, in the order of the layout
+     * @throws std::runtime_error if the format is not supported or the data is too small
+     */
+    inline std::vector<Image> decode_surfaces(Format format, std::vector<Surface> const &layout, const std::byte *pixels, std::size_t size, std::size_t threads = 0) {
+        Detail::check_format(format);
+        for(auto const &surface : layout) {
+            if(surface.offset + surface.size > size) {
+                throw std::runtime_error("Bitmap pixel data is too small");
+            }
+        }
+
+        std::vector<Image> images;
+        images.reserve(layout.size());
+        struct Task {
+            std::size_t surface;
+            std::uint32_t first_row;
+            std::uint32_t last_row;
+        };
+        std::vector<Task> tasks;
+        constexpr std::uint32_t rows_per_task = 64;
+        for(std::size_t i = 0; i < layout.size(); i++) {
+            images.emplace_back(layout[i].width, layout[i].height);
+            for(std::uint32_t row = 0; row < layout[i].height; row += rows_per_task) {
+                tasks.push_back({ i, row, std::min(row + rows_per_task, layout[i].height) });
+            }
+        }
+
+        parallel_for(tasks.size(), [&](std::size_t i) {
+            auto const &task = tasks[i];
+            auto const &surface = layout[task.surface];
+            decode_rows(format, pixels + surface.offset, surface.width, surface.height, task.first_row, task.last_row, images[task.surface].pixels.data());
+        }, threads);
+        return images;
+    }
+
+    /**
+     * Encode a mipmap chain to a bitmap format, one level per task
+     * @param format    format to encode to
+     * @param levels    images to encode, in the order they are stored
+     * @param threads   number of threads to use; 0 to use every hardware thread
+     * @return          pixel data of every level one after another
+     */
+    inline std::vector<std::byte> encode_levels(Format format, std::vector<Image> const &levels, std::size_t threads = 0) {
+        Detail::check_format(format);
+        std::vector<std::size_t> offsets;
+        std::size_t size = 0;
+        for(auto const &level : levels) {
+            offsets.push_back(size);
+            size += surface_size(format, level.width, level.height);
+        }
+        std::vector<std::byte> output(size);
+        parallel_for(levels.size(), [&](std::size_t i) {
+            encode(format, levels[i], output.data() + offsets[i]);
+        }, threads);
+        return output;
+    }
+}
+
+#endif
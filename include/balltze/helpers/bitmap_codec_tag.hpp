@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_API__HELPERS__BITMAP_CODEC_TAG_HPP
+#define BALLTZE_API__HELPERS__BITMAP_CODEC_TAG_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "../engine/tag_definitions/bitmap.hpp"
+#include "bitmap_codec.hpp"
+
+/**
+ * Bitmap codec entry points for the bitmap data of bitmap tags
+ */
+namespace Balltze::BitmapCodec {
+    using Engine::TagDefinitions::BitmapData;
+    using Engine::TagDefinitions::BitmapDataFormat;
+
+    static_assert(static_cast<std::uint16_t>(FORMAT_A8R8G8B8) == Engine::TagDefinitions::BITMAP_DATA_FORMAT_A8R8G8B8);
+    static_assert(static_cast<std::uint16_t>(FORMAT_DXT5) == Engine::TagDefinitions::BITMAP_DATA_FORMAT_DXT5);
+    static_assert(static_cast<std::uint16_t>(FORMAT_P8_BUMP) == Engine::TagDefinitions::BITMAP_DATA_FORMAT_P8_BUMP);
+
+    /**
+     * Get the codec format of a bitmap data format
+     */
+    constexpr Format format_of(BitmapDataFormat format) noexcept {
+        return static_cast<Format>(format);
+    }
+
+    /**
+     * Get the surfaces of a bitmap. Every mipmap holds its six cube map faces or
+     * its 3D texture slices one after another.
+     * @param bitmap    bitmap data
+     * @return          surfaces in the order they are stored
+     */
+    inline std::vector<Surface> surfaces(BitmapData const &bitmap) {
+        using namespace Engine::TagDefinitions;
+        std::uint32_t depth = bitmap.type == BITMAP_DATA_TYPE_3D_TEXTURE ? bitmap.depth : 1;
+        return surfaces(format_of(bitmap.format), bitmap.width, bitmap.height, depth, bitmap.mipmap_count, bitmap.type == BITMAP_DATA_TYPE_CUBE_MAP);
+    }
+
+    /**
+     * Decode every surface of a bitmap. Work is split in row ranges so large and small
+     * mipmaps are decoded in parallel.
+     * @param bitmap    bitmap data
+     * @param pixels    pixel data of the bitmap
+     * @param size      size of the pixel data
+     * @param threads   number of threads to use; 0 to use every hardware thread
+     * @return          decoded surfaces, in the order returned by surfaces()
+     * @throws std::runtime_error if the format is not supported, the data is swizzled or too small
+     */
+    inline std::vector<Image> decode_bitmap(BitmapData const &bitmap, const std::byte *pixels, std::size_t size, std::size_t threads = 0) {
+        Detail::check_format(format_of(bitmap.format));
+        if(bitmap.flags.swizzled) {
+            throw std::runtime_error("Swizzled bitmaps are not supported");
+        }
+        return decode_surfaces(format_of(bitmap.format), surfaces(bitmap), pixels, size, threads);
+    }
+
+    /**
+     * Decode several bitmaps at once
+     * @param bitmaps   bitmap data and its pixel data
+     * @param threads   number of threads to use; 0 to use every hardware thread
+     * @return          decoded surfaces of each bitmap
+     */
+    inline std::vector<std::vector<Image>> decode_bitmaps(std::vector<std::pair<BitmapData const *, std::vector<std::byte> const *>> const &bitmaps, std::size_t threads = 0) {
+        std::vector<std::vector<Image>> images(bitmaps.size());
+        parallel_for(bitmaps.size(), [&](std::size_t i) {
+            auto &[bitmap, pixels] = bitmaps[i];
+            images[i] = decode_bitmap(*bitmap, pixels->data(), pixels->size(), 1);
+        }, threads);
+        return images;
+    }
+}
+
+#endif
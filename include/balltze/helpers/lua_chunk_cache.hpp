@@ -0,0 +1,325 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_API__HELPERS__LUA_CHUNK_CACHE_HPP
+#define BALLTZE_API__HELPERS__LUA_CHUNK_CACHE_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+#include <fmt/format.h>
+#include <lua/lua.hpp>
+
+#ifdef _WIN32
+#include "../engine/core.hpp"
+#endif
+
+namespace Balltze {
+    /**
+     * Cache of compiled Lua chunks.
+     *
+     * Compiled chunks are stored in a cache directory owned by the loader, not next to
+     * their source, so a plugin cannot ship bytecode in place of its source. Each one
+     * has a header that records the hash and size of the source, the Lua version and
+     * number sizes of the interpreter, and the size and hash of the chunk itself. The
+     * chunk hash is keyed with a random key kept in the cache directory, so chunks the
+     * loader did not write itself, e.g. copied from another machine, never match.
+     *
+     * A cached chunk is used only if every field matches; otherwise the source is
+     * compiled as usual and the cache is rewritten. Failing to read or write the cache
+     * is never an error.
+     *
+     * Chunks are dumped with their debug information, so error messages and
+     * tracebacks are the same as when loading the source.
+     *
+     * Source files that are already precompiled are loaded as they are, like
+     * luaL_loadfile does, and are not cached.
+     */
+    class LuaChunkCache {
+    public:
+        /**
+         * Cache counters
+         */
+        struct Statistics {
+            std::size_t hits = 0;
+            std::size_t misses = 0;
+            std::size_t writes = 0;
+        };
+
+        /**
+         * @param directory directory where compiled chunks are kept; it is created when
+         *                  the first chunk is written and must only be writable by the user
+         */
+        LuaChunkCache(std::filesystem::path directory) : m_directory(std::move(directory)) {}
+
+        #ifdef _WIN32
+        /**
+         * Keep compiled chunks in the cache directory of Balltze in the profile of the user
+         */
+        LuaChunkCache() : LuaChunkCache(default_directory()) {}
+
+        /**
+         * Get the default cache directory
+         */
+        static std::filesystem::path default_directory() {
+            return Engine::get_path() / "balltze" / "lua_cache";
+        }
+        #endif
+
+        /**
+         * Load a Lua source file, using its compiled chunk if it is up to date
+         * @param state     Lua state
+         * @param path      path of the source file
+         * @return          status of the load like luaL_loadfile; the chunk or an error message is pushed
+         */
+        int load(lua_State *state, std::filesystem::path const &path) {
+            auto chunk_name = "@" + path.string();
+            std::vector<char> source;
+            if(!read_file(path, source)) {
+                lua_pushfstring(state, "cannot open %s", path.string().c_str());
+                return LUA_ERRFILE;
+            }
+
+            auto binary = binary_chunk_offset(source);
+            if(binary != std::string::npos) {
+                return luaL_loadbufferx(state, source.data() + binary, source.size() - binary, chunk_name.c_str(), "b");
+            }
+
+            Header expected = header(source);
+            auto cache = cache_path(path);
+            std::vector<char> cached;
+            if(read_file(cache, cached) && cached.size() >= sizeof(Header)) {
+                auto const *chunk = cached.data() + sizeof(Header);
+                auto chunk_size = cached.size() - sizeof(Header);
+                expected.chunk_size = chunk_size;
+                expected.chunk_hash = chunk_hash(chunk, chunk_size);
+                if(std::memcmp(cached.data(), &expected, sizeof(Header)) == 0) {
+                    if(luaL_loadbufferx(state, chunk, chunk_size, chunk_name.c_str(), "b") == LUA_OK) {
+                        m_statistics.hits++;
+                        return LUA_OK;
+                    }
+                    lua_pop(state, 1);
+                }
+            }
+
+            m_statistics.misses++;
+            skip_comment(source);
+            auto status = luaL_loadbufferx(state, source.data(), source.size(), chunk_name.c_str(), "t");
+            if(status != LUA_OK) {
+                return status;
+            }
+
+            std::vector<char> chunk(sizeof(Header));
+            if(lua_dump(state, write_chunk, &chunk, 0) == 0) {
+                expected.chunk_size = chunk.size() - sizeof(Header);
+                expected.chunk_hash = chunk_hash(chunk.data() + sizeof(Header), expected.chunk_size);
+                std::memcpy(chunk.data(), &expected, sizeof(Header));
+                std::error_code ec;
+                std::filesystem::create_directories(m_directory, ec);
+                if(write_file(cache, chunk)) {
+                    m_statistics.writes++;
+                }
+            }
+            return status;
+        }
+
+        /**
+         * Load and run a Lua source file, using its compiled chunk if it is up to date
+         * @param state     Lua state
+         * @param path      path of the source file
+         * @return          status like luaL_dofile; on error the message is pushed
+         */
+        int run(lua_State *state, std::filesystem::path const &path) {
+            auto status = load(state, path);
+            if(status != LUA_OK) {
+                return status;
+            }
+            return lua_pcall(state, 0, LUA_MULTRET, 0);
+        }
+
+        /**
+         * Get the path of the compiled chunk of a source file
+         * @param path  path of the source file
+         */
+        std::filesystem::path cache_path(std::filesystem::path const &path) const {
+            std::error_code ec;
+            auto absolute = std::filesystem::absolute(path, ec);
+            auto name = (ec ? path : absolute).lexically_normal().u8string();
+            return m_directory / fmt::format("{:016x}.luac", fnv1a(FNV_OFFSET_BASIS, name.data(), name.size()));
+        }
+
+        std::filesystem::path const &directory() const noexcept {
+            return m_directory;
+        }
+
+        Statistics const &statistics() const noexcept {
+            return m_statistics;
+        }
+
+    private:
+        static constexpr char MAGIC[8] = { 'B', 'L', 'T', 'Z', 'L', 'U', 'A', 'C' };
+        static constexpr std::uint32_t FORMAT_VERSION = 2;
+        static constexpr std::size_t KEY_SIZE = 16;
+        static constexpr std::uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+
+        struct Header {
+            char magic[8];
+            std::uint32_t format_version;
+            std::uint32_t lua_version;
+            std::uint8_t integer_size;
+            std::uint8_t number_size;
+            std::uint8_t size_t_size;
+            std::uint8_t instruction_size;
+            std::uint32_t pad;
+            std::uint64_t source_size;
+            std::uint64_t source_hash;
+            std::uint64_t chunk_size;
+            std::uint64_t chunk_hash;
+        };
+        static_assert(sizeof(Header) == 56);
+
+        std::filesystem::path m_directory;
+        std::vector<char> m_key;
+        Statistics m_statistics;
+
+        static std::uint64_t fnv1a(std::uint64_t hash, void const *data, std::size_t size) noexcept {
+            auto const *bytes = static_cast<unsigned char const *>(data);
+            for(std::size_t i = 0; i < size; i++) {
+                hash = (hash ^ bytes[i]) * 1099511628211ull;
+            }
+            return hash;
+        }
+
+        /**
+         * Hash a chunk with the key of the cache directory
+         */
+        std::uint64_t chunk_hash(char const *chunk, std::size_t size) {
+            auto const &key = cache_key();
+            return fnv1a(fnv1a(FNV_OFFSET_BASIS, key.data(), key.size()), chunk, size);
+        }
+
+        /**
+         * Get the key of the cache directory, creating it if there is none. If it cannot
+         * be saved, chunks written by this cache are only accepted until it is destroyed.
+         */
+        std::vector<char> const &cache_key() {
+            if(!m_key.empty()) {
+                return m_key;
+            }
+            auto key_path = m_directory / "key";
+            if(read_file(key_path, m_key) && m_key.size() == KEY_SIZE) {
+                return m_key;
+            }
+            std::random_device random;
+            m_key.resize(KEY_SIZE);
+            for(auto &byte : m_key) {
+                byte = static_cast<char>(random());
+            }
+            std::error_code ec;
+            std::filesystem::create_directories(m_directory, ec);
+            write_file(key_path, m_key);
+            return m_key;
+        }
+
+        static Header header(std::vector<char> const &source) noexcept {
+            Header result = {};
+            std::memcpy(result.magic, MAGIC, sizeof(MAGIC));
+            result.format_version = FORMAT_VERSION;
+            result.lua_version = LUA_VERSION_NUM;
+            result.integer_size = sizeof(lua_Integer);
+            result.number_size = sizeof(lua_Number);
+            result.size_t_size = sizeof(std::size_t);
+            result.instruction_size = sizeof(std::uint32_t);
+            result.source_size = source.size();
+            result.source_hash = fnv1a(FNV_OFFSET_BASIS, source.data(), source.size());
+            return result;
+        }
+
+        /**
+         * Blank a UTF-8 BOM and a first line starting with #, like luaL_loadfile does,
+         * keeping the line numbers
+         */
+        /**
+         * Get the offset of the chunk of a precompiled file, after the optional BOM and first line comment
+         * @return offset; std::string::npos if the file is source code
+         */
+        static std::size_t binary_chunk_offset(std::vector<char> const &source) noexcept {
+            std::size_t start = 0;
+            if(source.size() >= 3 && std::memcmp(source.data(), "\xEF\xBB\xBF", 3) == 0) {
+                start = 3;
+            }
+            if(start < source.size() && source[start] == '#') {
+                while(start < source.size() && source[start] != '\n') {
+                    start++;
+                }
+                if(start < source.size()) {
+                    start++;
+                }
+            }
+            if(start < source.size() && source[start] == LUA_SIGNATURE[0]) {
+                return start;
+            }
+            return std::string::npos;
+        }
+
+        static void skip_comment(std::vector<char> &source) noexcept {
+            std::size_t start = 0;
+            if(source.size() >= 3 && std::memcmp(source.data(), "\xEF\xBB\xBF", 3) == 0) {
+                start = 3;
+            }
+            std::fill(source.begin(), source.begin() + start, ' ');
+            if(start < source.size() && source[start] == '#') {
+                for(auto i = start; i < source.size() && source[i] != '\n'; i++) {
+                    source[i] = ' ';
+                }
+            }
+        }
+
+        static int write_chunk(lua_State *, void const *data, std::size_t size, void *user_data) {
+            auto *chunk = static_cast<std::vector<char> *>(user_data);
+            chunk->insert(chunk->end(), static_cast<char const *>(data), static_cast<char const *>(data) + size);
+            return 0;
+        }
+
+        static bool read_file(std::filesystem::path const &path, std::vector<char> &data) {
+            std::ifstream file(path, std::ios::binary);
+            if(!file.is_open()) {
+                return false;
+            }
+            data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            return !file.bad();
+        }
+
+        static bool write_file(std::filesystem::path const &path, std::vector<char> const &data) {
+            auto temp_path = path;
+            temp_path += ".tmp";
+            {
+                std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+                if(!file.is_open()) {
+                    return false;
+                }
+                file.write(data.data(), static_cast<std::streamsize>(data.size()));
+                file.flush();
+            }
+            std::error_code ec;
+            if(std::filesystem::file_size(temp_path, ec) != data.size()) {
+                std::filesystem::remove(temp_path, ec);
+                return false;
+            }
+            std::filesystem::rename(temp_path, path, ec);
+            if(ec) {
+                std::filesystem::remove(temp_path, ec);
+                return false;
+            }
+            return true;
+        }
+    };
+}
+
+#endif
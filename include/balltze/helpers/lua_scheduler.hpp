@@ -0,0 +1,436 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_API__HELPERS__LUA_SCHEDULER_HPP
+#define BALLTZE_API__HELPERS__LUA_SCHEDULER_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <list>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <lua/lua.hpp>
+
+#ifdef _WIN32
+#include "../events/map_load.hpp"
+#include "../events/tick.hpp"
+#endif
+
+namespace Balltze {
+    /**
+     * Cooperative scheduler for the coroutines of a Lua state.
+     *
+     * Coroutines run once per tick until they sleep, wait for an event or finish.
+     * Each tick has a time budget: once it is spent, the remaining coroutines are
+     * deferred to the next tick, where they run first. A coroutine that keeps running
+     * past the budget is preempted by a count hook when it is in a yieldable state.
+     *
+     * The scheduler is exposed to Lua through install():
+     *   - scheduler.spawn(function, ...)   run a function as a coroutine from the next tick
+     *   - scheduler.sleep(ticks)           suspend the current coroutine for a number of ticks
+     *   - scheduler.wait_for(event)        suspend the current coroutine until the event is signaled;
+     *                                      returns the values passed to the signal
+     *   - scheduler.statistics()           get the statistics as a table
+     */
+    class LuaScheduler {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        /**
+         * Scheduler counters
+         */
+        struct Statistics {
+            /** Ticks run */
+            std::uint64_t ticks = 0;
+
+            /** Ticks that took longer than the budget */
+            std::uint64_t overruns = 0;
+
+            /** Time spent past the budget across every tick */
+            std::chrono::microseconds overrun_time { 0 };
+
+            /** Longest tick */
+            std::chrono::microseconds worst_tick { 0 };
+
+            /** Coroutines deferred to a later tick because the budget was spent */
+            std::uint64_t deferrals = 0;
+
+            /** Coroutines suspended by the count hook */
+            std::uint64_t preemptions = 0;
+
+            /** Coroutines resumed */
+            std::uint64_t resumes = 0;
+
+            /** Coroutines that raised an error */
+            std::uint64_t errors = 0;
+        };
+
+        /**
+         * @param state     Lua state of the plugin
+         * @param budget    time the coroutines may run each tick
+         */
+        LuaScheduler(lua_State *state, std::chrono::microseconds budget) : m_state(state), m_budget(budget) {}
+
+        LuaScheduler(LuaScheduler const &) = delete;
+        LuaScheduler &operator=(LuaScheduler const &) = delete;
+
+        ~LuaScheduler() {
+            #ifdef _WIN32
+            detach();
+            #endif
+            clear();
+        }
+
+        /**
+         * Register the scheduler table in the Lua state
+         * @param name  name of the global table
+         */
+        void install(char const *name = "scheduler") {
+            static const luaL_Reg functions[] = {
+                { "spawn", lua_spawn },
+                { "sleep", lua_sleep },
+                { "wait_for", lua_wait_for },
+                { "statistics", lua_statistics },
+                { nullptr, nullptr }
+            };
+            lua_createtable(m_state, 0, 4);
+            lua_pushlightuserdata(m_state, this);
+            luaL_setfuncs(m_state, functions, 1);
+            lua_setglobal(m_state, name);
+        }
+
+        /**
+         * Spawn a coroutine; it runs from the next tick
+         * @param argument_count    number of arguments on top of the stack, after the function
+         * @throws std::runtime_error if there is no function below the arguments
+         */
+        void spawn(int argument_count) {
+            int function = lua_gettop(m_state) - argument_count;
+            if(function < 1 || !lua_isfunction(m_state, function)) {
+                throw std::runtime_error("Expected a function to spawn");
+            }
+            auto &coroutine = m_coroutines.emplace_back();
+            coroutine.thread = lua_newthread(m_state);
+            coroutine.reference = luaL_ref(m_state, LUA_REGISTRYINDEX);
+            coroutine.state = COROUTINE_READY;
+            coroutine.ready_since = m_tick;
+            coroutine.pending_arguments = argument_count;
+            lua_xmove(m_state, coroutine.thread, argument_count + 1);
+            lua_sethook(coroutine.thread, preemption_hook, LUA_MASKCOUNT, HOOK_INSTRUCTIONS);
+            m_threads[coroutine.thread] = std::prev(m_coroutines.end());
+        }
+
+        /**
+         * Wake the coroutines waiting for an event
+         * @param event             name of the event
+         * @param argument_count    number of values on top of the stack to pass to the coroutines; they are popped
+         * @return                  number of coroutines woken
+         */
+        std::size_t signal(std::string_view event, int argument_count = 0) {
+            std::size_t woken = 0;
+            int first = lua_gettop(m_state) - argument_count + 1;
+            for(auto &coroutine : m_coroutines) {
+                if(coroutine.state != COROUTINE_WAITING || coroutine.event != event) {
+                    continue;
+                }
+                for(int i = 0; i < argument_count; i++) {
+                    lua_pushvalue(m_state, first + i);
+                }
+                lua_xmove(m_state, coroutine.thread, argument_count);
+                coroutine.pending_arguments = argument_count;
+                coroutine.state = COROUTINE_READY;
+                coroutine.ready_since = m_tick;
+                coroutine.event.clear();
+                woken++;
+            }
+            lua_pop(m_state, argument_count);
+            return woken;
+        }
+
+        /**
+         * Run the coroutines that are due, until they yield or the budget is spent
+         */
+        void tick() {
+            auto start = Clock::now();
+            m_deadline = start + m_budget;
+
+            // Coroutines deferred from earlier ticks run first
+            m_queue.clear();
+            for(auto it = m_coroutines.begin(); it != m_coroutines.end(); it++) {
+                if(it->state == COROUTINE_SLEEPING && it->wake_tick <= m_tick) {
+                    it->state = COROUTINE_READY;
+                    it->ready_since = it->wake_tick;
+                }
+                if(it->state == COROUTINE_READY) {
+                    m_queue.push_back(it);
+                }
+            }
+            std::stable_sort(m_queue.begin(), m_queue.end(), [](auto const &a, auto const &b) {
+                return a->ready_since < b->ready_since;
+            });
+
+            for(std::size_t i = 0; i < m_queue.size(); i++) {
+                if(Clock::now() >= m_deadline) {
+                    m_statistics.deferrals += m_queue.size() - i;
+                    break;
+                }
+                resume(m_queue[i]);
+            }
+            m_queue.clear();
+
+            auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+            m_statistics.ticks++;
+            m_statistics.worst_tick = std::max(m_statistics.worst_tick, elapsed);
+            if(elapsed > m_budget) {
+                m_statistics.overruns++;
+                m_statistics.overrun_time += elapsed - m_budget;
+            }
+            m_tick++;
+        }
+
+        /**
+         * Kill every coroutine
+         */
+        void clear() {
+            for(auto &coroutine : m_coroutines) {
+                luaL_unref(m_state, LUA_REGISTRYINDEX, coroutine.reference);
+            }
+            m_coroutines.clear();
+            m_threads.clear();
+        }
+
+        /**
+         * Set the function called when a coroutine raises an error; the coroutine is killed
+         */
+        void set_error_handler(std::function<void(std::string const &message)> handler) {
+            m_error_handler = std::move(handler);
+        }
+
+        void set_budget(std::chrono::microseconds budget) noexcept {
+            m_budget = budget;
+        }
+
+        std::chrono::microseconds budget() const noexcept {
+            return m_budget;
+        }
+
+        std::size_t coroutine_count() const noexcept {
+            return m_coroutines.size();
+        }
+
+        std::uint64_t current_tick() const noexcept {
+            return m_tick;
+        }
+
+        Statistics const &statistics() const noexcept {
+            return m_statistics;
+        }
+
+        void reset_statistics() noexcept {
+            m_statistics = {};
+        }
+
+        #ifdef _WIN32
+        /**
+         * Run the scheduler on every tick and signal "map_load" after a map is loaded
+         */
+        void attach() {
+            if(m_attached) {
+                return;
+            }
+            m_attached = true;
+            m_tick_listener = Event::TickEvent::subscribe_const([this](Event::TickEvent const &event) {
+                if(event.time == Event::EVENT_TIME_AFTER) {
+                    tick();
+                }
+            });
+            m_map_load_listener = Event::MapLoadEvent::subscribe_const([this](Event::MapLoadEvent const &event) {
+                if(event.time == Event::EVENT_TIME_AFTER) {
+                    signal("map_load");
+                }
+            });
+        }
+
+        /**
+         * Stop running the scheduler on ticks
+         */
+        void detach() {
+            if(!m_attached) {
+                return;
+            }
+            m_attached = false;
+            m_tick_listener.remove();
+            m_map_load_listener.remove();
+        }
+        #endif
+
+    private:
+        static constexpr int HOOK_INSTRUCTIONS = 1000;
+
+        enum CoroutineState {
+            COROUTINE_READY,
+            COROUTINE_RUNNING,
+            COROUTINE_SLEEPING,
+            COROUTINE_WAITING
+        };
+
+        struct Coroutine {
+            lua_State *thread;
+            int reference;
+            CoroutineState state;
+            std::uint64_t wake_tick = 0;
+            std::uint64_t ready_since = 0;
+            int pending_arguments = 0;
+            std::string event;
+        };
+
+        using CoroutineIterator = std::list<Coroutine>::iterator;
+
+        lua_State *m_state;
+        std::chrono::microseconds m_budget;
+        Clock::time_point m_deadline;
+        std::uint64_t m_tick = 0;
+        std::list<Coroutine> m_coroutines;
+        std::unordered_map<lua_State *, CoroutineIterator> m_threads;
+        std::vector<CoroutineIterator> m_queue;
+        Statistics m_statistics;
+        std::function<void(std::string const &)> m_error_handler;
+
+        #ifdef _WIN32
+        Event::EventListenerHandle<Event::TickEvent> m_tick_listener;
+        Event::EventListenerHandle<Event::MapLoadEvent> m_map_load_listener;
+        bool m_attached = false;
+        #endif
+
+        /** Scheduler running a coroutine, for the count hook */
+        static LuaScheduler *&running() noexcept {
+            thread_local LuaScheduler *scheduler = nullptr;
+            return scheduler;
+        }
+
+        void resume(CoroutineIterator it) {
+            auto &coroutine = *it;
+            auto arguments = coroutine.pending_arguments;
+            coroutine.pending_arguments = 0;
+            coroutine.state = COROUTINE_RUNNING;
+            m_statistics.resumes++;
+
+            auto *previous = running();
+            running() = this;
+            auto status = lua_resume(coroutine.thread, m_state, arguments);
+            running() = previous;
+
+            if(status == LUA_YIELD) {
+                // Preempted coroutines yield from the hook with nothing on the stack
+                if(coroutine.state == COROUTINE_READY) {
+                    return;
+                }
+                // Drop the values passed to coroutine.yield
+                lua_settop(coroutine.thread, 0);
+                if(coroutine.state == COROUTINE_RUNNING) {
+                    // Plain coroutine.yield calls sleep for a tick
+                    coroutine.state = COROUTINE_SLEEPING;
+                    coroutine.wake_tick = m_tick + 1;
+                }
+                return;
+            }
+            if(status != LUA_OK) {
+                m_statistics.errors++;
+                if(m_error_handler) {
+                    auto const *message = lua_tostring(coroutine.thread, -1);
+                    m_error_handler(message ? message : "unknown error");
+                }
+            }
+            luaL_unref(m_state, LUA_REGISTRYINDEX, coroutine.reference);
+            m_threads.erase(coroutine.thread);
+            m_coroutines.erase(it);
+        }
+
+        Coroutine *current(lua_State *thread) {
+            auto it = m_threads.find(thread);
+            return it != m_threads.end() ? &*it->second : nullptr;
+        }
+
+        static LuaScheduler *self(lua_State *state) {
+            return static_cast<LuaScheduler *>(lua_touserdata(state, lua_upvalueindex(1)));
+        }
+
+        static void preemption_hook(lua_State *state, lua_Debug *) {
+            auto *scheduler = running();
+            if(!scheduler || !lua_isyieldable(state) || Clock::now() < scheduler->m_deadline) {
+                return;
+            }
+            auto *coroutine = scheduler->current(state);
+            if(!coroutine) {
+                return;
+            }
+            // Run again as soon as possible, before coroutines that became ready later
+            coroutine->state = COROUTINE_READY;
+            scheduler->m_statistics.preemptions++;
+            lua_yield(state, 0);
+        }
+
+        static int lua_spawn(lua_State *state) {
+            auto *scheduler = self(state);
+            luaL_checktype(state, 1, LUA_TFUNCTION);
+            int argument_count = lua_gettop(state) - 1;
+            if(state != scheduler->m_state) {
+                // Spawned from a coroutine; move the function and its arguments to the main state
+                lua_xmove(state, scheduler->m_state, argument_count + 1);
+            }
+            scheduler->spawn(argument_count);
+            return 0;
+        }
+
+        static Coroutine *check_coroutine(lua_State *state, LuaScheduler *scheduler) {
+            auto *coroutine = scheduler->current(state);
+            if(!coroutine || !lua_isyieldable(state)) {
+                luaL_error(state, "not called from a scheduled coroutine");
+            }
+            return coroutine;
+        }
+
+        static int lua_sleep(lua_State *state) {
+            auto *scheduler = self(state);
+            auto ticks = luaL_optinteger(state, 1, 1);
+            auto *coroutine = check_coroutine(state, scheduler);
+            coroutine->state = COROUTINE_SLEEPING;
+            coroutine->wake_tick = scheduler->m_tick + static_cast<std::uint64_t>(std::max<lua_Integer>(ticks, 1));
+            return lua_yield(state, 0);
+        }
+
+        static int lua_wait_for(lua_State *state) {
+            auto *scheduler = self(state);
+            auto const *event = luaL_checkstring(state, 1);
+            auto *coroutine = check_coroutine(state, scheduler);
+            coroutine->state = COROUTINE_WAITING;
+            coroutine->event = event;
+            return lua_yield(state, 0);
+        }
+
+        static int lua_statistics(lua_State *state) {
+            auto const &statistics = self(state)->m_statistics;
+            lua_createtable(state, 0, 8);
+            auto set = [state](char const *name, lua_Integer value) {
+                lua_pushinteger(state, value);
+                lua_setfield(state, -2, name);
+            };
+            set("ticks", static_cast<lua_Integer>(statistics.ticks));
+            set("overruns", static_cast<lua_Integer>(statistics.overruns));
+            set("overrun_time_us", static_cast<lua_Integer>(statistics.overrun_time.count()));
+            set("worst_tick_us", static_cast<lua_Integer>(statistics.worst_tick.count()));
+            set("deferrals", static_cast<lua_Integer>(statistics.deferrals));
+            set("preemptions", static_cast<lua_Integer>(statistics.preemptions));
+            set("resumes", static_cast<lua_Integer>(statistics.resumes));
+            set("errors", static_cast<lua_Integer>(statistics.errors));
+            return 1;
+        }
+    };
+}
+
+#endif
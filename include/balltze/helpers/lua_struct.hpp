@@ -0,0 +1,1046 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_API__HELPERS__LUA_STRUCT_HPP
+#define BALLTZE_API__HELPERS__LUA_STRUCT_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <type_traits>
+#include <lua/lua.hpp>
+#include "../engine/data_types.hpp"
+#include "../engine/game_state.hpp"
+
+/**
+ * Bindings that expose engine structures to Lua without copying them.
+ *
+ * A bound structure is pushed as a userdata that holds only a pointer to the
+ * structure. Its metatable is built once per Lua state and type and is cached in the
+ * registry. Reading or writing a field looks the field up in the metatable and
+ * accesses the memory of the structure directly. Nested structures, fixed arrays
+ * and tag reflexives are pushed as views into the same memory. Views are cached in
+ * the uservalue of the userdata they were accessed through, so reading the same
+ * nested field again does not allocate.
+ *
+ * A type is described by specializing Describe:
+ *
+ *     template<> struct Describe<Engine::Point3D> {
+ *         static constexpr char const *name = "Point3D";
+ *         static void describe(TypeBuilder<Engine::Point3D> &type) {
+ *             type.field("x", &Engine::Point3D::x).field("y", &Engine::Point3D::y).field("z", &Engine::Point3D::z);
+ *         }
+ *     };
+ *
+ * Descriptions of the common tag definition structs are generated into
+ * lua_struct_tags.hpp by tools/lua_struct_generator.cpp.
+ *
+ * Userdata and the views taken from them point into the memory of the object or
+ * tag and are not tracked. A userdata must not be used after its object is deleted
+ * or its map is unloaded, since it would read and write freed memory; scripts
+ * must look objects up again every tick instead of keeping them.
+ */
+namespace Balltze::LuaStruct {
+    enum FieldKind : std::uint8_t {
+        FIELD_INT8,
+        FIELD_INT16,
+        FIELD_INT32,
+        FIELD_UINT8,
+        FIELD_UINT16,
+        FIELD_UINT32,
+        FIELD_FLOAT,
+        FIELD_BOOL,
+        FIELD_BIT,
+        FIELD_HANDLE,
+        FIELD_TAG_STRING,
+        FIELD_STRUCT,
+        FIELD_REFLEXIVE,
+        FIELD_ARRAY
+    };
+
+    struct Type;
+
+    struct Field {
+        FieldKind kind;
+
+        /** Whether scripts may not write the field */
+        bool read_only = false;
+
+        /** Bit of FIELD_BIT fields */
+        std::uint8_t bit = 0;
+
+        /** Offset of the field in the structure */
+        std::uint32_t offset = 0;
+
+        /** Number of elements of FIELD_ARRAY fields */
+        std::uint32_t count = 0;
+
+        /** Size of the elements of FIELD_ARRAY fields */
+        std::uint32_t stride = 0;
+
+        /** Type of FIELD_STRUCT fields and of the elements of FIELD_REFLEXIVE fields */
+        Type const *type = nullptr;
+
+        /** Element of FIELD_ARRAY fields */
+        Field const *element = nullptr;
+    };
+
+    struct Type {
+        std::string name;
+        std::size_t size = 0;
+
+        /** Named fields, in declaration order */
+        std::deque<std::pair<std::string, Field>> fields;
+
+        /** Elements of array fields */
+        std::deque<Field> elements;
+
+        /** Type of the base structure; its fields are included in fields */
+        Type const *base = nullptr;
+
+        /** Offset of the base structure */
+        std::uint32_t base_offset = 0;
+    };
+
+    template<typename T>
+    struct Describe;
+
+    template<typename T>
+    Type const &type_of();
+
+    namespace Detail {
+        template<typename T>
+        struct IsReflexive : std::false_type {};
+
+        template<typename T>
+        struct IsReflexive<Engine::TagReflexive<T>> : std::true_type {
+            using Element = T;
+        };
+
+        template<typename M>
+        Field describe_field(std::uint32_t offset, bool read_only) {
+            Field field;
+            field.offset = offset;
+            field.read_only = read_only;
+            if constexpr(std::is_same_v<M, bool>) {
+                field.kind = FIELD_BOOL;
+            }
+            else if constexpr(std::is_enum_v<M>) {
+                field = describe_field<std::underlying_type_t<M>>(offset, read_only);
+            }
+            else if constexpr(std::is_integral_v<M>) {
+                static_assert(sizeof(M) <= 4, "64-bit fields are not supported");
+                if constexpr(std::is_signed_v<M>) {
+                    field.kind = sizeof(M) == 1 ? FIELD_INT8 : sizeof(M) == 2 ? FIELD_INT16 : FIELD_INT32;
+                }
+                else {
+                    field.kind = sizeof(M) == 1 ? FIELD_UINT8 : sizeof(M) == 2 ? FIELD_UINT16 : FIELD_UINT32;
+                }
+            }
+            else if constexpr(std::is_same_v<M, float>) {
+                field.kind = FIELD_FLOAT;
+            }
+            else if constexpr(std::is_same_v<M, Engine::ResourceHandle>) {
+                field.kind = FIELD_HANDLE;
+            }
+            else if constexpr(std::is_same_v<M, Engine::TagString>) {
+                field.kind = FIELD_TAG_STRING;
+            }
+            else if constexpr(IsReflexive<M>::value) {
+                field.kind = FIELD_REFLEXIVE;
+                field.type = &type_of<typename IsReflexive<M>::Element>();
+            }
+            else {
+                field.kind = FIELD_STRUCT;
+                field.type = &type_of<M>();
+            }
+            return field;
+        }
+
+        struct ArrayView {
+            std::byte *data;
+            std::uint32_t count;
+            std::uint32_t stride;
+            Field const *element;
+        };
+
+        inline char const *const ARRAY_METATABLE = "Balltze::LuaStruct::ArrayView";
+
+        /** Key of the Type of a structure metatable */
+        inline char const TYPE_KEY = 0;
+
+        void push_field(lua_State *state, std::byte *base, Field const &field);
+        void push_struct(lua_State *state, std::byte *data, Type const &type);
+    }
+
+    /**
+     * Builder used by Describe specializations
+     */
+    template<typename T>
+    class TypeBuilder {
+    public:
+        TypeBuilder(Type &type) : m_type(type) {}
+
+        /**
+         * Add a field
+         * @param name      name of the field in Lua
+         * @param member    member of the structure
+         * @param read_only whether scripts may not write the field
+         */
+        template<typename M>
+        TypeBuilder &field(char const *name, M T::*member, bool read_only = false) {
+            m_type.fields.emplace_back(name, Detail::describe_field<M>(offset_of(member), read_only));
+            return *this;
+        }
+
+        /**
+         * Add a fixed array field; arrays are indexed from 1 like Lua tables
+         * @param name      name of the field in Lua
+         * @param member    member of the structure
+         * @param read_only whether scripts may not write the elements
+         */
+        template<typename M, std::size_t N>
+        TypeBuilder &field(char const *name, M (T::*member)[N], bool read_only = false) {
+            auto &element = m_type.elements.emplace_back(Detail::describe_field<M>(0, read_only));
+            Field field;
+            field.kind = FIELD_ARRAY;
+            field.read_only = read_only;
+            field.offset = offset_of(member);
+            field.count = static_cast<std::uint32_t>(N);
+            field.stride = static_cast<std::uint32_t>(sizeof(M));
+            field.element = &element;
+            m_type.fields.emplace_back(name, field);
+            return *this;
+        }
+
+        /**
+         * Add the fields of the base structure
+         * @tparam B    base structure; it must have a Describe specialization
+         */
+        template<typename B>
+        TypeBuilder &base() {
+            static_assert(std::is_base_of_v<B, T>, "B is not a base of T");
+            auto const &base_type = type_of<B>();
+            auto offset = base_offset<B>();
+            for(auto const &[name, field] : base_type.fields) {
+                auto &copy = m_type.fields.emplace_back(name, field).second;
+                copy.offset += offset;
+            }
+            m_type.base = &base_type;
+            m_type.base_offset = offset;
+            return *this;
+        }
+
+        /**
+         * Add a one bit field of a member that holds bit fields
+         * @param name      name of the field in Lua
+         * @param member    member that holds the bit
+         * @param bit       index of the bit in the member
+         * @param read_only whether scripts may not write the field
+         */
+        template<typename M>
+        TypeBuilder &bit(char const *name, M T::*member, std::uint8_t bit, bool read_only = false) {
+            return this->bit(name, offset_of(member), bit, read_only);
+        }
+
+        /**
+         * Add a one bit field, for members declared as bit fields
+         * @param name      name of the field in Lua
+         * @param offset    offset of the byte that holds the bit
+         * @param bit       index of the bit in the byte
+         * @param read_only whether scripts may not write the field
+         */
+        TypeBuilder &bit(char const *name, std::uint32_t offset, std::uint8_t bit, bool read_only = false) {
+            Field field;
+            field.kind = FIELD_BIT;
+            field.read_only = read_only;
+            field.offset = offset + bit / 8;
+            field.bit = bit % 8;
+            m_type.fields.emplace_back(name, field);
+            return *this;
+        }
+
+    private:
+        Type &m_type;
+
+        template<typename M>
+        static std::uint32_t offset_of(M T::*member) noexcept {
+            alignas(T) static std::byte storage[sizeof(T)];
+            auto const *object = reinterpret_cast<T const *>(storage);
+            return static_cast<std::uint32_t>(reinterpret_cast<std::byte const *>(&(object->*member)) - storage);
+        }
+
+        template<typename B>
+        static std::uint32_t base_offset() noexcept {
+            alignas(T) static std::byte storage[sizeof(T)];
+            auto const *object = reinterpret_cast<T const *>(storage);
+            return static_cast<std::uint32_t>(reinterpret_cast<std::byte const *>(static_cast<B const *>(object)) - storage);
+        }
+    };
+
+    /**
+     * Get the description of a type; it is built on first use from Describe<T>
+     */
+    template<typename T>
+    Type const &type_of() {
+        static Type const type = []() {
+            Type type;
+            type.name = Describe<T>::name;
+            type.size = sizeof(T);
+            TypeBuilder<T> builder(type);
+            Describe<T>::describe(builder);
+            return type;
+        }();
+        return type;
+    }
+
+    /**
+     * Push a structure
+     * @param state     Lua state
+     * @param object    structure to push; nil is pushed if null
+     */
+    template<typename T>
+    void push(lua_State *state, T *object) {
+        if(!object) {
+            lua_pushnil(state);
+            return;
+        }
+        Detail::push_struct(state, reinterpret_cast<std::byte *>(const_cast<std::remove_const_t<T> *>(object)), type_of<std::remove_const_t<T>>());
+    }
+
+    /**
+     * Get a structure from the stack
+     * @param state     Lua state
+     * @param index     index of the value
+     * @return          pointer to the structure; nullptr if the value is not a T or a structure derived from T
+     */
+    template<typename T>
+    T *to(lua_State *state, int index) {
+        auto *data = lua_touserdata(state, index);
+        if(!data || !lua_getmetatable(state, index)) {
+            return nullptr;
+        }
+        lua_rawgetp(state, -1, &Detail::TYPE_KEY);
+        auto const *type = static_cast<Type const *>(lua_touserdata(state, -1));
+        lua_pop(state, 2);
+        std::uint32_t offset = 0;
+        for(; type; offset += type->base_offset, type = type->base) {
+            if(type == &type_of<T>()) {
+                return reinterpret_cast<T *>(*static_cast<std::byte **>(data) + offset);
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * Get a structure from the stack, raising a Lua error if the value is not a T
+     * @param state     Lua state
+     * @param index     index of the value
+     * @return          pointer to the structure
+     */
+    template<typename T>
+    T *check(lua_State *state, int index) {
+        auto *object = to<T>(state, index);
+        if(!object) {
+            luaL_error(state, "bad argument #%d (%s expected)", index, type_of<T>().name.c_str());
+        }
+        return object;
+    }
+
+    namespace Detail {
+        template<typename V>
+        V read(std::byte const *data) noexcept {
+            V value;
+            std::memcpy(&value, data, sizeof(V));
+            return value;
+        }
+
+        template<typename V>
+        void write(std::byte *data, V value) noexcept {
+            std::memcpy(data, &value, sizeof(V));
+        }
+
+        inline void push_array(lua_State *state, std::byte *data, std::uint32_t count, std::uint32_t stride, Field const *element);
+
+        inline void push_field(lua_State *state, std::byte *base, Field const &field) {
+            auto *data = base + field.offset;
+            switch(field.kind) {
+                case FIELD_INT8:
+                    lua_pushinteger(state, read<std::int8_t>(data));
+                    break;
+                case FIELD_INT16:
+                    lua_pushinteger(state, read<std::int16_t>(data));
+                    break;
+                case FIELD_INT32:
+                    lua_pushinteger(state, read<std::int32_t>(data));
+                    break;
+                case FIELD_UINT8:
+                    lua_pushinteger(state, read<std::uint8_t>(data));
+                    break;
+                case FIELD_UINT16:
+                    lua_pushinteger(state, read<std::uint16_t>(data));
+                    break;
+                case FIELD_UINT32:
+                case FIELD_HANDLE:
+                    lua_pushinteger(state, read<std::uint32_t>(data));
+                    break;
+                case FIELD_FLOAT:
+                    lua_pushnumber(state, read<float>(data));
+                    break;
+                case FIELD_BOOL:
+                    lua_pushboolean(state, read<std::uint8_t>(data) != 0);
+                    break;
+                case FIELD_BIT:
+                    lua_pushboolean(state, (read<std::uint8_t>(data) >> field.bit) & 1);
+                    break;
+                case FIELD_TAG_STRING: {
+                    auto const *string = reinterpret_cast<char const *>(data);
+                    lua_pushlstring(state, string, strnlen(string, sizeof(Engine::TagString)));
+                    break;
+                }
+                case FIELD_STRUCT:
+                    push_struct(state, data, *field.type);
+                    break;
+                case FIELD_REFLEXIVE: {
+                    auto const &reflexive = *reinterpret_cast<Engine::TagReflexive<std::byte> *>(data);
+                    auto *element = &field;
+                    push_array(state, reflexive.offset, reflexive.offset ? reflexive.count : 0, static_cast<std::uint32_t>(field.type->size), element);
+                    break;
+                }
+                case FIELD_ARRAY:
+                    push_array(state, data, field.count, field.stride, field.element);
+                    break;
+            }
+        }
+
+        inline void write_field(lua_State *state, std::byte *base, Field const &field, int value, char const *name) {
+            if(field.read_only) {
+                luaL_error(state, "field %s is read-only", name);
+            }
+            auto *data = base + field.offset;
+            switch(field.kind) {
+                case FIELD_INT8:
+                    write(data, static_cast<std::int8_t>(luaL_checkinteger(state, value)));
+                    break;
+                case FIELD_INT16:
+                    write(data, static_cast<std::int16_t>(luaL_checkinteger(state, value)));
+                    break;
+                case FIELD_INT32:
+                    write(data, static_cast<std::int32_t>(luaL_checkinteger(state, value)));
+                    break;
+                case FIELD_UINT8:
+                    write(data, static_cast<std::uint8_t>(luaL_checkinteger(state, value)));
+                    break;
+                case FIELD_UINT16:
+                    write(data, static_cast<std::uint16_t>(luaL_checkinteger(state, value)));
+                    break;
+                case FIELD_UINT32:
+                case FIELD_HANDLE:
+                    write(data, static_cast<std::uint32_t>(luaL_checkinteger(state, value)));
+                    break;
+                case FIELD_FLOAT:
+                    write(data, static_cast<float>(luaL_checknumber(state, value)));
+                    break;
+                case FIELD_BOOL:
+                    write<std::uint8_t>(data, lua_toboolean(state, value) ? 1 : 0);
+                    break;
+                case FIELD_BIT: {
+                    auto byte = read<std::uint8_t>(data);
+                    auto mask = static_cast<std::uint8_t>(1 << field.bit);
+                    write<std::uint8_t>(data, lua_toboolean(state, value) ? byte | mask : byte & ~mask);
+                    break;
+                }
+                case FIELD_TAG_STRING: {
+                    std::size_t length;
+                    auto const *string = luaL_checklstring(state, value, &length);
+                    Engine::TagString tag_string;
+                    std::memcpy(tag_string.string, string, std::min(length, sizeof(tag_string.string) - 1));
+                    std::memcpy(data, &tag_string, sizeof(tag_string));
+                    break;
+                }
+                default:
+                    luaL_error(state, "field %s cannot be assigned", name);
+            }
+        }
+
+        /**
+         * __index and __newindex of structures. Upvalue 1 is the table of fields, which
+         * maps field names to light userdata pointing to their Field.
+         */
+        inline Field const *find_field(lua_State *state) {
+            lua_pushvalue(state, 2);
+            lua_rawget(state, lua_upvalueindex(1));
+            auto const *field = static_cast<Field const *>(lua_touserdata(state, -1));
+            lua_pop(state, 1);
+            if(!field) {
+                auto const *type = static_cast<Type const *>(lua_touserdata(state, lua_upvalueindex(2)));
+                luaL_error(state, "%s has no field %s", type->name.c_str(), luaL_tolstring(state, 2, nullptr));
+            }
+            return field;
+        }
+
+        /**
+         * Push a view of a structure, array or reflexive, reusing the view cached in the
+         * uservalue table of the userdata it was accessed through
+         * @param owner     absolute index of the userdata the view is accessed through
+         * @param key       key of the view in the cache
+         * @param base      memory the field is relative to
+         * @param field     field to push
+         */
+        inline void push_cached_view(lua_State *state, int owner, void const *key, std::byte *base, Field const &field) {
+            if(lua_getuservalue(state, owner) != LUA_TTABLE) {
+                lua_pop(state, 1);
+                lua_newtable(state);
+                lua_pushvalue(state, -1);
+                lua_setuservalue(state, owner);
+            }
+            if(lua_rawgetp(state, -1, key) == LUA_TUSERDATA) {
+                if(field.kind == FIELD_REFLEXIVE && key == &field) {
+                    // Reflexives may be resized or moved
+                    auto const &reflexive = *reinterpret_cast<Engine::TagReflexive<std::byte> *>(base + field.offset);
+                    auto *view = static_cast<ArrayView *>(lua_touserdata(state, -1));
+                    view->data = reflexive.offset;
+                    view->count = reflexive.offset ? reflexive.count : 0;
+                }
+                lua_remove(state, -2);
+                return;
+            }
+            lua_pop(state, 1);
+            if(field.kind == FIELD_REFLEXIVE && key != &field) {
+                // Elements of reflexives are structures
+                push_struct(state, base, *field.type);
+            }
+            else {
+                push_field(state, base, field);
+            }
+            lua_pushvalue(state, -1);
+            lua_rawsetp(state, -3, key);
+            lua_remove(state, -2);
+        }
+
+        inline bool is_view(FieldKind kind) noexcept {
+            return kind == FIELD_STRUCT || kind == FIELD_REFLEXIVE || kind == FIELD_ARRAY;
+        }
+
+        inline int struct_index(lua_State *state) {
+            auto const *field = find_field(state);
+            auto *data = *static_cast<std::byte **>(lua_touserdata(state, 1));
+            if(is_view(field->kind)) {
+                push_cached_view(state, 1, field, data, *field);
+            }
+            else {
+                push_field(state, data, *field);
+            }
+            return 1;
+        }
+
+        inline int struct_new_index(lua_State *state) {
+            auto const *field = find_field(state);
+            write_field(state, *static_cast<std::byte **>(lua_touserdata(state, 1)), *field, 3, lua_tostring(state, 2));
+            return 0;
+        }
+
+        inline int struct_equal(lua_State *state) {
+            lua_pushboolean(state, *static_cast<std::byte **>(lua_touserdata(state, 1)) == *static_cast<std::byte **>(lua_touserdata(state, 2)));
+            return 1;
+        }
+
+        inline int struct_to_string(lua_State *state) {
+            auto const *type = static_cast<Type const *>(lua_touserdata(state, lua_upvalueindex(1)));
+            lua_pushfstring(state, "%s: %p", type->name.c_str(), *static_cast<void **>(lua_touserdata(state, 1)));
+            return 1;
+        }
+
+        inline void push_metatable(lua_State *state, Type const &type) {
+            if(lua_rawgetp(state, LUA_REGISTRYINDEX, &type) == LUA_TTABLE) {
+                return;
+            }
+            lua_pop(state, 1);
+
+            lua_createtable(state, 0, 5);
+
+            lua_createtable(state, 0, static_cast<int>(type.fields.size()));
+            for(auto const &[name, field] : type.fields) {
+                lua_pushlightuserdata(state, const_cast<Field *>(&field));
+                lua_setfield(state, -2, name.c_str());
+            }
+            lua_pushlightuserdata(state, const_cast<Type *>(&type));
+            lua_pushvalue(state, -2);
+            lua_pushvalue(state, -2);
+            lua_pushcclosure(state, struct_index, 2);
+            lua_setfield(state, -4, "__index");
+            lua_pushcclosure(state, struct_new_index, 2);
+            lua_setfield(state, -2, "__newindex");
+
+            lua_pushcfunction(state, struct_equal);
+            lua_setfield(state, -2, "__eq");
+            lua_pushlightuserdata(state, const_cast<Type *>(&type));
+            lua_pushcclosure(state, struct_to_string, 1);
+            lua_setfield(state, -2, "__tostring");
+            lua_pushstring(state, type.name.c_str());
+            lua_setfield(state, -2, "__name");
+            lua_pushlightuserdata(state, const_cast<Type *>(&type));
+            lua_rawsetp(state, -2, &TYPE_KEY);
+
+            lua_pushvalue(state, -1);
+            lua_rawsetp(state, LUA_REGISTRYINDEX, &type);
+        }
+
+        inline void push_struct(lua_State *state, std::byte *data, Type const &type) {
+            *static_cast<std::byte **>(lua_newuserdata(state, sizeof(std::byte *))) = data;
+            push_metatable(state, type);
+            lua_setmetatable(state, -2);
+        }
+
+        inline ArrayView *check_array(lua_State *state) {
+            return static_cast<ArrayView *>(luaL_checkudata(state, 1, ARRAY_METATABLE));
+        }
+
+        inline std::byte *array_element(lua_State *state, ArrayView *view) {
+            auto index = luaL_checkinteger(state, 2);
+            if(index < 1 || index > view->count) {
+                luaL_error(state, "index %d is out of bounds (1-%d)", static_cast<int>(index), static_cast<int>(view->count));
+            }
+            return view->data + (index - 1) * view->stride;
+        }
+
+        inline int array_index(lua_State *state) {
+            auto *view = check_array(state);
+            auto *element = array_element(state, view);
+            if(is_view(view->element->kind)) {
+                // Elements are cached by address, so the cache stays right if a reflexive moves
+                push_cached_view(state, 1, element, element, *view->element);
+            }
+            else {
+                push_field(state, element, *view->element);
+            }
+            return 1;
+        }
+
+        inline int array_new_index(lua_State *state) {
+            auto *view = check_array(state);
+            write_field(state, array_element(state, view), *view->element, 3, "element");
+            return 0;
+        }
+
+        inline int array_length(lua_State *state) {
+            lua_pushinteger(state, check_array(state)->count);
+            return 1;
+        }
+
+        inline void push_array(lua_State *state, std::byte *data, std::uint32_t count, std::uint32_t stride, Field const *element) {
+            auto *view = static_cast<ArrayView *>(lua_newuserdata(state, sizeof(ArrayView)));
+            *view = { data, count, stride, element };
+            if(luaL_newmetatable(state, ARRAY_METATABLE)) {
+                lua_pushcfunction(state, array_index);
+                lua_setfield(state, -2, "__index");
+                lua_pushcfunction(state, array_new_index);
+                lua_setfield(state, -2, "__newindex");
+                lua_pushcfunction(state, array_length);
+                lua_setfield(state, -2, "__len");
+            }
+            lua_setmetatable(state, -2);
+        }
+    }
+
+    template<> struct Describe<Engine::Point2D> {
+        static constexpr char const *name = "Point2D";
+        static void describe(TypeBuilder<Engine::Point2D> &type) {
+            type.field("x", &Engine::Point2D::x).field("y", &Engine::Point2D::y);
+        }
+    };
+
+    template<> struct Describe<Engine::Point3D> {
+        static constexpr char const *name = "Point3D";
+        static void describe(TypeBuilder<Engine::Point3D> &type) {
+            type.field("x", &Engine::Point3D::x).field("y", &Engine::Point3D::y).field("z", &Engine::Point3D::z);
+        }
+    };
+
+    template<> struct Describe<Engine::Vector2D> {
+        static constexpr char const *name = "Vector2D";
+        static void describe(TypeBuilder<Engine::Vector2D> &type) {
+            type.field("i", &Engine::Vector2D::i).field("j", &Engine::Vector2D::j);
+        }
+    };
+
+    template<> struct Describe<Engine::Vector3D> {
+        static constexpr char const *name = "Vector3D";
+        static void describe(TypeBuilder<Engine::Vector3D> &type) {
+            type.field("i", &Engine::Vector3D::i).field("j", &Engine::Vector3D::j).field("k", &Engine::Vector3D::k);
+        }
+    };
+
+    template<> struct Describe<Engine::Euler2D> {
+        static constexpr char const *name = "Euler2D";
+        static void describe(TypeBuilder<Engine::Euler2D> &type) {
+            type.field("yaw", &Engine::Euler2D::yaw).field("pitch", &Engine::Euler2D::pitch);
+        }
+    };
+
+    template<> struct Describe<Engine::Euler3D> {
+        static constexpr char const *name = "Euler3D";
+        static void describe(TypeBuilder<Engine::Euler3D> &type) {
+            type.field("yaw", &Engine::Euler3D::yaw).field("pitch", &Engine::Euler3D::pitch).field("roll", &Engine::Euler3D::roll);
+        }
+    };
+
+    template<> struct Describe<Engine::Euler3DPYR> {
+        static constexpr char const *name = "Euler3DPYR";
+        static void describe(TypeBuilder<Engine::Euler3DPYR> &type) {
+            type.field("pitch", &Engine::Euler3DPYR::pitch).field("yaw", &Engine::Euler3DPYR::yaw).field("roll", &Engine::Euler3DPYR::roll);
+        }
+    };
+
+    template<> struct Describe<Engine::ColorRGB> {
+        static constexpr char const *name = "ColorRGB";
+        static void describe(TypeBuilder<Engine::ColorRGB> &type) {
+            type.field("red", &Engine::ColorRGB::red).field("green", &Engine::ColorRGB::green).field("blue", &Engine::ColorRGB::blue);
+        }
+    };
+
+    template<> struct Describe<Engine::ColorARGB> {
+        static constexpr char const *name = "ColorARGB";
+        static void describe(TypeBuilder<Engine::ColorARGB> &type) {
+            type.field("alpha", &Engine::ColorARGB::alpha).field("red", &Engine::ColorARGB::red).field("green", &Engine::ColorARGB::green).field("blue", &Engine::ColorARGB::blue);
+        }
+    };
+
+    template<> struct Describe<Engine::Quaternion> {
+        static constexpr char const *name = "Quaternion";
+        static void describe(TypeBuilder<Engine::Quaternion> &type) {
+            type.field("i", &Engine::Quaternion::i).field("j", &Engine::Quaternion::j).field("k", &Engine::Quaternion::k).field("w", &Engine::Quaternion::w);
+        }
+    };
+
+    template<> struct Describe<Engine::Point2DInt> {
+        static constexpr char const *name = "Point2DInt";
+        static void describe(TypeBuilder<Engine::Point2DInt> &type) {
+            type.field("x", &Engine::Point2DInt::x).field("y", &Engine::Point2DInt::y);
+        }
+    };
+
+    template<> struct Describe<Engine::ColorARGBInt> {
+        static constexpr char const *name = "ColorARGBInt";
+        static void describe(TypeBuilder<Engine::ColorARGBInt> &type) {
+            type.field("alpha", &Engine::ColorARGBInt::alpha).field("red", &Engine::ColorARGBInt::red).field("green", &Engine::ColorARGBInt::green).field("blue", &Engine::ColorARGBInt::blue);
+        }
+    };
+
+    template<> struct Describe<Engine::Plane2D> {
+        static constexpr char const *name = "Plane2D";
+        static void describe(TypeBuilder<Engine::Plane2D> &type) {
+            type.field("vector", &Engine::Plane2D::vector).field("w", &Engine::Plane2D::w);
+        }
+    };
+
+    template<> struct Describe<Engine::Plane3D> {
+        static constexpr char const *name = "Plane3D";
+        static void describe(TypeBuilder<Engine::Plane3D> &type) {
+            type.field("vector", &Engine::Plane3D::vector).field("w", &Engine::Plane3D::w);
+        }
+    };
+
+    template<> struct Describe<Engine::Rectangle2D> {
+        static constexpr char const *name = "Rectangle2D";
+        static void describe(TypeBuilder<Engine::Rectangle2D> &type) {
+            type.field("top", &Engine::Rectangle2D::top).field("left", &Engine::Rectangle2D::left).field("bottom", &Engine::Rectangle2D::bottom).field("right", &Engine::Rectangle2D::right);
+        }
+    };
+
+    template<> struct Describe<Engine::Rectangle2DF> {
+        static constexpr char const *name = "Rectangle2DF";
+        static void describe(TypeBuilder<Engine::Rectangle2DF> &type) {
+            type.field("top", &Engine::Rectangle2DF::top).field("left", &Engine::Rectangle2DF::left).field("bottom", &Engine::Rectangle2DF::bottom).field("right", &Engine::Rectangle2DF::right);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDataOffset> {
+        static constexpr char const *name = "TagDataOffset";
+        static void describe(TypeBuilder<Engine::TagDataOffset> &type) {
+            type.field("size", &Engine::TagDataOffset::size, true);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDependency> {
+        static constexpr char const *name = "TagDependency";
+        static void describe(TypeBuilder<Engine::TagDependency> &type) {
+            type.field("tag_fourcc", &Engine::TagDependency::tag_fourcc, true).field("tag_handle", &Engine::TagDependency::tag_handle, true);
+        }
+    };
+
+    template<> struct Describe<Engine::BaseObjectVitals> {
+        static constexpr char const *name = "BaseObjectVitals";
+        static void describe(TypeBuilder<Engine::BaseObjectVitals> &type) {
+            using V = Engine::BaseObjectVitals;
+            type.field("base_health", &V::base_health)
+                .field("base_shield", &V::base_shield)
+                .field("health", &V::health)
+                .field("shield", &V::shield)
+                .field("current_shield_damage", &V::current_shield_damage)
+                .field("current_health_damage", &V::current_health_damage)
+                .field("entangled_object", &V::entangled_object)
+                .field("recent_shield_damage", &V::recent_shield_damage)
+                .field("recent_health_damage", &V::recent_health_damage)
+                .field("recent_shield_damage_time", &V::recent_shield_damage_time)
+                .field("recent_health_damage_time", &V::recent_health_damage_time)
+                .field("shield_stun_time", &V::shield_stun_time);
+        }
+    };
+
+    template<> struct Describe<Engine::BaseObject> {
+        static constexpr char const *name = "BaseObject";
+        static void describe(TypeBuilder<Engine::BaseObject> &type) {
+            using O = Engine::BaseObject;
+            type.field("tag_handle", &O::tag_handle, true)
+                .field("network_role", &O::network_role, true)
+                .field("existence_time", &O::existence_time, true)
+                .field("object_marker_id", &O::object_marker_id)
+                .field("position", &O::position)
+                .field("velocity", &O::velocity)
+                .field("orientation", &O::orientation)
+                .field("rotation_velocity", &O::rotation_velocity)
+                .field("center_position", &O::center_position)
+                .field("bounding_radius", &O::bounding_radius)
+                .field("scale", &O::scale)
+                .field("type", &O::type, true)
+                .field("name_list_index", &O::name_list_index)
+                .field("moving_time", &O::moving_time)
+                .field("variant_index", &O::variant_index)
+                .field("player", &O::player, true)
+                .field("owner_object", &O::owner_object)
+                .field("animation_tag_handle", &O::animation_tag_handle)
+                .field("animation_index", &O::animation_index)
+                .field("animation_frame", &O::animation_frame)
+                .field("vitals", &O::vitals)
+                .field("next_object", &O::next_object, true)
+                .field("first_object", &O::first_object, true)
+                .field("parent_object", &O::parent_object, true)
+                .field("parent_attachment_node", &O::parent_attachment_node)
+                .field("force_shield_update", &O::force_shield_update);
+        }
+    };
+
+    template<> struct Describe<Engine::UnitRecentDamager> {
+        static constexpr char const *name = "UnitRecentDamager";
+        static void describe(TypeBuilder<Engine::UnitRecentDamager> &type) {
+            using D = Engine::UnitRecentDamager;
+            type.field("last_damage_time", &D::last_damage_time)
+                .field("total_damage", &D::total_damage)
+                .field("object", &D::object)
+                .field("player", &D::player);
+        }
+    };
+
+    template<> struct Describe<Engine::UnitObject> {
+        static constexpr char const *name = "UnitObject";
+        static void describe(TypeBuilder<Engine::UnitObject> &type) {
+            using U = Engine::UnitObject;
+            type.base<Engine::BaseObject>()
+                .field("actor", &U::actor)
+                .field("shield_snapping", &U::shield_snapping)
+                .field("base_seat_index", &U::base_seat_index)
+                .field("controlling_player", &U::controlling_player, true)
+                .field("desired_facing_vector", &U::desired_facing_vector)
+                .field("desired_aiming_vector", &U::desired_aiming_vector)
+                .field("aiming_vector", &U::aiming_vector)
+                .field("aiming_velocity", &U::aiming_velocity)
+                .field("looking_angles", &U::looking_angles)
+                .field("looking_vector", &U::looking_vector)
+                .field("looking_velocity", &U::looking_velocity)
+                .field("throttle", &U::throttle)
+                .field("primary_trigger", &U::primary_trigger)
+                .field("aiming_speed", &U::aiming_speed)
+                .field("melee_state", &U::melee_state)
+                .field("melee_timer", &U::melee_timer)
+                .field("grenade_state", &U::grenade_state)
+                .field("grenade_projectile", &U::grenade_projectile)
+                .field("ambient", &U::ambient)
+                .field("illumination", &U::illumination)
+                .field("mouth_factor", &U::mouth_factor)
+                .field("vehicle_seat_id", &U::vehicle_seat_id, true)
+                .field("current_weapon_id", &U::current_weapon_id)
+                .field("next_weapon_id", &U::next_weapon_id)
+                .field("weapons", &U::weapons, true)
+                .field("weapon_ready_ticks", &U::weapon_ready_ticks)
+                .field("current_grenade_index", &U::current_grenade_index)
+                .field("next_grenade_index", &U::next_grenade_index)
+                .field("grenade_counts", &U::grenade_counts)
+                .field("zoom_level", &U::zoom_level)
+                .field("desired_zoom_level", &U::desired_zoom_level)
+                .field("powered_seats_riders", &U::powered_seats_riders, true)
+                .field("encounter_id", &U::encounter_id)
+                .field("squad_id", &U::squad_id)
+                .field("powered_seats_power", &U::powered_seats_power)
+                .field("integrated_light_power", &U::integrated_light_power)
+                .field("camo_power", &U::camo_power)
+                .field("dialogue_definition", &U::dialogue_definition)
+                .field("object_flame_causer", &U::object_flame_causer)
+                .field("died_at_tick", &U::died_at_tick)
+                .field("feign_death_timer", &U::feign_death_timer)
+                .field("camo_regrowth", &U::camo_regrowth)
+                .field("stun", &U::stun)
+                .field("stun_ticks", &U::stun_ticks)
+                .field("spree_count", &U::spree_count)
+                .field("spree_starting_time", &U::spree_starting_time)
+                .field("recent_damage", &U::recent_damage);
+        }
+    };
+
+    template<> struct Describe<Engine::BipedObject> {
+        static constexpr char const *name = "BipedObject";
+        static void describe(TypeBuilder<Engine::BipedObject> &type) {
+            using B = Engine::BipedObject;
+            type.base<Engine::UnitObject>()
+                .bit("airborne", &B::biped_flags, 0)
+                .bit("slipping", &B::biped_flags, 1)
+                .bit("absolute_movement", &B::biped_flags, 2)
+                .bit("no_collision", &B::biped_flags, 3)
+                .bit("passes_through_other_bipeds", &B::biped_flags, 4)
+                .bit("limping", &B::biped_flags, 5)
+                .field("landing_timer", &B::landing_timer)
+                .field("landing_force", &B::landing_force)
+                .field("movement_state", &B::movement_state)
+                .field("action_flags", &B::action_flags)
+                .field("biped_position", &B::biped_position)
+                .field("walking_counter", &B::walking_counter)
+                .field("bump_object", &B::bump_object)
+                .field("ticks_since_last_bump", &B::ticks_since_last_bump)
+                .field("airborne_ticks", &B::airborne_ticks)
+                .field("slipping_ticks", &B::slipping_ticks)
+                .field("digital_throttle", &B::digital_throttle)
+                .field("jump_ticks", &B::jump_ticks)
+                .field("melee_ticks", &B::melee_ticks)
+                .field("melee_inflict_ticks", &B::melee_inflict_ticks)
+                .field("crouch_scale", &B::crouch_scale);
+        }
+    };
+
+    template<> struct Describe<Engine::VehicleObject> {
+        static constexpr char const *name = "VehicleObject";
+        static void describe(TypeBuilder<Engine::VehicleObject> &type) {
+            using V = Engine::VehicleObject;
+            type.base<Engine::UnitObject>()
+                .bit("hovering", &V::vehicle_flags, 1)
+                .bit("crouched", &V::vehicle_flags, 2)
+                .bit("jumping", &V::vehicle_flags, 3)
+                .field("speed", &V::speed)
+                .field("slide", &V::slide)
+                .field("turn", &V::turn)
+                .field("tire_position", &V::tire_position)
+                .field("thread_position_left", &V::thread_position_left)
+                .field("thread_position_right", &V::thread_position_right)
+                .field("hover", &V::hover)
+                .field("thrust", &V::thrust)
+                .field("suspension_states", &V::suspension_states)
+                .field("hover_position", &V::hover_position);
+        }
+    };
+
+    template<> struct Describe<Engine::ItemObject> {
+        static constexpr char const *name = "ItemObject";
+        static void describe(TypeBuilder<Engine::ItemObject> &type) {
+            using I = Engine::ItemObject;
+            type.base<Engine::BaseObject>()
+                .field("item_flags", &I::flags)
+                .field("ticks_until_detonation", &I::ticks_until_detonation)
+                .field("dropped_by_unit", &I::dropped_by_unit, true)
+                .field("last_update_tick", &I::last_update_tick);
+        }
+    };
+
+    template<> struct Describe<Engine::WeaponMagazine> {
+        static constexpr char const *name = "WeaponMagazine";
+        static void describe(TypeBuilder<Engine::WeaponMagazine> &type) {
+            using M = Engine::WeaponMagazine;
+            type.field("state", &M::state)
+                .field("reload_ticks_remaining", &M::reload_ticks_remaining)
+                .field("reload_ticks", &M::reload_ticks)
+                .field("rounds_unloaded", &M::rounds_unloaded)
+                .field("rounds_loaded", &M::rounds_loaded)
+                .field("rounds_left_to_recharge", &M::rounds_left_to_recharge);
+        }
+    };
+
+    template<> struct Describe<Engine::WeaponObject> {
+        static constexpr char const *name = "WeaponObject";
+        static void describe(TypeBuilder<Engine::WeaponObject> &type) {
+            using W = Engine::WeaponObject;
+            type.base<Engine::ItemObject>()
+                .field("weapon_flags", &W::flags)
+                .field("owner_unit_flags", &W::owner_unit_flags)
+                .field("primary_trigger", &W::primary_trigger)
+                .field("weapon_state", &W::weapon_state)
+                .field("ready_ticks", &W::ready_ticks)
+                .field("heat", &W::heat)
+                .field("age", &W::age)
+                .field("illumination_fraction", &W::illumination_fraction)
+                .field("integrated_light_power", &W::integrated_light_power)
+                .field("tracked_object", &W::tracked_object)
+                .field("alt_shots_loaded", &W::alt_shots_loaded)
+                .field("magazines", &W::magazines)
+                .field("last_trigger_fire_tick", &W::last_trigger_fire_tick);
+        }
+    };
+
+    template<> struct Describe<Engine::Player> {
+        static constexpr char const *name = "Player";
+        static void describe(TypeBuilder<Engine::Player> &type) {
+            using P = Engine::Player;
+            type.field("player_id", &P::player_id, true)
+                .field("local_handle", &P::local_handle, true)
+                .field("team", &P::team)
+                .field("interaction_object_handle", &P::interaction_object_handle)
+                .field("interaction_object_type", &P::interaction_object_type)
+                .field("interaction_object_seat", &P::interaction_object_seat)
+                .field("respawn_time", &P::respawn_time)
+                .field("respawn_time_growth", &P::respawn_time_growth)
+                .field("object_handle", &P::object_handle, true)
+                .field("prev_object_handle", &P::prev_object_handle, true)
+                .field("bsp_cluster_id", &P::bsp_cluster_id, true)
+                .field("auto_aim_target_object", &P::auto_aim_target_object)
+                .field("last_fire_time", &P::last_fire_time)
+                .field("color", &P::color)
+                .field("icon_index", &P::icon_index)
+                .field("machine_index", &P::machine_index, true)
+                .field("controller_index", &P::controller_index, true)
+                .field("index", &P::index, true)
+                .field("invisibility_time", &P::invisibility_time)
+                .field("other_powerup_time_left", &P::other_powerup_time_left)
+                .field("speed", &P::speed)
+                .field("objective_mode", &P::objective_mode)
+                .field("target_player", &P::target_player)
+                .field("last_death_time", &P::last_death_time)
+                .field("slayer_target", &P::slayer_target)
+                .field("odd_man_out", &P::odd_man_out)
+                .field("kill_streak", &P::kill_streak)
+                .field("multikill", &P::multikill)
+                .field("last_kill_time", &P::last_kill_time)
+                .field("kills", &P::kills)
+                .field("assists", &P::assists)
+                .field("betrays", &P::betrays)
+                .field("deaths", &P::deaths)
+                .field("suicides", &P::suicides)
+                .field("team_kills", &P::team_kills)
+                .field("telefrag_timer", &P::telefrag_timer)
+                .field("quit_time", &P::quit_time)
+                .field("telefrag_danger", &P::telefrag_danger)
+                .field("quit", &P::quit)
+                .field("ping", &P::ping, true)
+                .field("team_kill_count", &P::team_kill_count)
+                .field("position", &P::position)
+                .field("baseline_update_xy_aim", &P::baseline_update_xy_aim, true)
+                .field("baseline_update_z_aim", &P::baseline_update_z_aim, true)
+                .field("baseline_update_forward", &P::baseline_update_forward, true)
+                .field("baseline_update_left", &P::baseline_update_left, true)
+                .field("baseline_update_rate_of_fire", &P::baseline_update_rate_of_fire, true)
+                .field("baseline_update_weapon_slot", &P::baseline_update_weapon_slot, true)
+                .field("baseline_update_grenade_slot", &P::baseline_update_grenade_slot, true)
+                .field("update_aiming", &P::update_aiming, true)
+                .field("update_position", &P::update_position, true);
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,866 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// This file is auto-generated by tools/lua_struct_generator.cpp. DO NOT EDIT!
+
+#ifndef BALLTZE_API__HELPERS__LUA_STRUCT_TAGS_HPP
+#define BALLTZE_API__HELPERS__LUA_STRUCT_TAGS_HPP
+
+#include "lua_struct.hpp"
+#include "../engine/tag_definitions/biped.hpp"
+#include "../engine/tag_definitions/bitfield.hpp"
+#include "../engine/tag_definitions/equipment.hpp"
+#include "../engine/tag_definitions/garbage.hpp"
+#include "../engine/tag_definitions/item.hpp"
+#include "../engine/tag_definitions/object.hpp"
+#include "../engine/tag_definitions/projectile.hpp"
+#include "../engine/tag_definitions/scenery.hpp"
+#include "../engine/tag_definitions/unit.hpp"
+#include "../engine/tag_definitions/vehicle.hpp"
+#include "../engine/tag_definitions/weapon.hpp"
+
+namespace Balltze::LuaStruct {
+    template<> struct Describe<Engine::TagDefinitions::ObjectFlags> {
+        static constexpr char const *name = "ObjectFlags";
+        static void describe(TypeBuilder<Engine::TagDefinitions::ObjectFlags> &type) {
+            type.bit("does_not_cast_shadow", 0, 0)
+                .bit("transparent_self_occlusion", 0, 1)
+                .bit("brighter_than_it_should_be", 0, 2)
+                .bit("not_a_pathfinding_obstacle", 0, 3)
+                .bit("extension_of_parent", 0, 4)
+                .bit("cast_shadow_by_default", 0, 5)
+                .bit("does_not_have_anniversary_geometry", 0, 6);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::ObjectAttachment> {
+        static constexpr char const *name = "ObjectAttachment";
+        static void describe(TypeBuilder<Engine::TagDefinitions::ObjectAttachment> &type) {
+            using T = Engine::TagDefinitions::ObjectAttachment;
+            type.field("type", &T::type)
+                .field("marker", &T::marker)
+                .field("primary_scale", &T::primary_scale)
+                .field("secondary_scale", &T::secondary_scale)
+                .field("change_color", &T::change_color);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::ObjectWidget> {
+        static constexpr char const *name = "ObjectWidget";
+        static void describe(TypeBuilder<Engine::TagDefinitions::ObjectWidget> &type) {
+            using T = Engine::TagDefinitions::ObjectWidget;
+            type.field("reference", &T::reference);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::ObjectFunctionFlags> {
+        static constexpr char const *name = "ObjectFunctionFlags";
+        static void describe(TypeBuilder<Engine::TagDefinitions::ObjectFunctionFlags> &type) {
+            type.bit("invert", 0, 0)
+                .bit("additive", 0, 1)
+                .bit("always_active", 0, 2);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::ObjectFunction> {
+        static constexpr char const *name = "ObjectFunction";
+        static void describe(TypeBuilder<Engine::TagDefinitions::ObjectFunction> &type) {
+            using T = Engine::TagDefinitions::ObjectFunction;
+            type.field("flags", &T::flags)
+                .field("period", &T::period)
+                .field("scale_period_by", &T::scale_period_by)
+                .field("function", &T::function)
+                .field("scale_function_by", &T::scale_function_by)
+                .field("wobble_function", &T::wobble_function)
+                .field("wobble_period", &T::wobble_period)
+                .field("wobble_magnitude", &T::wobble_magnitude)
+                .field("square_wave_threshold", &T::square_wave_threshold)
+                .field("step_count", &T::step_count)
+                .field("map_to", &T::map_to)
+                .field("sawtooth_count", &T::sawtooth_count)
+                .field("add", &T::add)
+                .field("scale_result_by", &T::scale_result_by)
+                .field("bounds_mode", &T::bounds_mode)
+                .field("bounds", &T::bounds)
+                .field("turn_off_with", &T::turn_off_with)
+                .field("scale_by", &T::scale_by)
+                .field("inverse_bounds", &T::inverse_bounds)
+                .field("inverse_sawtooth", &T::inverse_sawtooth)
+                .field("inverse_step", &T::inverse_step)
+                .field("inverse_period", &T::inverse_period)
+                .field("usage", &T::usage);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::ColorInterpolationFlags> {
+        static constexpr char const *name = "ColorInterpolationFlags";
+        static void describe(TypeBuilder<Engine::TagDefinitions::ColorInterpolationFlags> &type) {
+            type.bit("blend_in_hsv", 0, 0)
+                .bit("more_colors", 0, 1);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::ObjectChangeColorsPermutation> {
+        static constexpr char const *name = "ObjectChangeColorsPermutation";
+        static void describe(TypeBuilder<Engine::TagDefinitions::ObjectChangeColorsPermutation> &type) {
+            using T = Engine::TagDefinitions::ObjectChangeColorsPermutation;
+            type.field("weight", &T::weight)
+                .field("color_lower_bound", &T::color_lower_bound)
+                .field("color_upper_bound", &T::color_upper_bound);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::ObjectChangeColors> {
+        static constexpr char const *name = "ObjectChangeColors";
+        static void describe(TypeBuilder<Engine::TagDefinitions::ObjectChangeColors> &type) {
+            using T = Engine::TagDefinitions::ObjectChangeColors;
+            type.field("darken_by", &T::darken_by)
+                .field("scale_by", &T::scale_by)
+                .field("flags", &T::flags)
+                .field("color_lower_bound", &T::color_lower_bound)
+                .field("color_upper_bound", &T::color_upper_bound)
+                .field("permutations", &T::permutations);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::PredictedResource> {
+        static constexpr char const *name = "PredictedResource";
+        static void describe(TypeBuilder<Engine::TagDefinitions::PredictedResource> &type) {
+            using T = Engine::TagDefinitions::PredictedResource;
+            type.field("type", &T::type)
+                .field("resource_index", &T::resource_index)
+                .field("tag", &T::tag);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::Object> {
+        static constexpr char const *name = "Object";
+        static void describe(TypeBuilder<Engine::TagDefinitions::Object> &type) {
+            using T = Engine::TagDefinitions::Object;
+            type.field("object_type", &T::object_type)
+                .field("flags", &T::flags)
+                .field("bounding_radius", &T::bounding_radius)
+                .field("bounding_offset", &T::bounding_offset)
+                .field("origin_offset", &T::origin_offset)
+                .field("acceleration_scale", &T::acceleration_scale)
+                .field("scales_change_colors", &T::scales_change_colors)
+                .field("model", &T::model)
+                .field("animation_graph", &T::animation_graph)
+                .field("collision_model", &T::collision_model)
+                .field("physics", &T::physics)
+                .field("modifier_shader", &T::modifier_shader)
+                .field("creation_effect", &T::creation_effect)
+                .field("render_bounding_radius", &T::render_bounding_radius)
+                .field("a_in", &T::a_in)
+                .field("b_in", &T::b_in)
+                .field("c_in", &T::c_in)
+                .field("d_in", &T::d_in)
+                .field("hud_text_message_index", &T::hud_text_message_index)
+                .field("forced_shader_permutation_index", &T::forced_shader_permutation_index)
+                .field("attachments", &T::attachments)
+                .field("widgets", &T::widgets)
+                .field("functions", &T::functions)
+                .field("change_colors", &T::change_colors)
+                .field("predicted_resources", &T::predicted_resources);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::UnitFlags> {
+        static constexpr char const *name = "UnitFlags";
+        static void describe(TypeBuilder<Engine::TagDefinitions::UnitFlags> &type) {
+            type.bit("circular_aiming", 0, 0)
+                .bit("destroyed_after_dying", 0, 1)
+                .bit("half_speed_interpolation", 0, 2)
+                .bit("fires_from_camera", 0, 3)
+                .bit("entrance_inside_bounding_sphere", 0, 4)
+                .bit("unused", 0, 5)
+                .bit("causes_passenger_dialogue", 0, 6)
+                .bit("resists_pings", 0, 7)
+                .bit("melee_attack_is_fatal", 0, 8)
+                .bit("dont_reface_during_pings", 0, 9)
+                .bit("has_no_aiming", 0, 10)
+                .bit("simple_creature", 0, 11)
+                .bit("impact_melee_attaches_to_unit", 0, 12)
+                .bit("impact_melee_dies_on_shields", 0, 13)
+                .bit("cannot_open_doors_automatically", 0, 14)
+                .bit("melee_attackers_cannot_attach", 0, 15)
+                .bit("not_instantly_killed_by_melee", 0, 16)
+                .bit("shield_sapping", 0, 17)
+                .bit("runs_around_flaming", 0, 18)
+                .bit("inconsequential", 0, 19)
+                .bit("special_cinematic_unit", 0, 20)
+                .bit("ignored_by_autoaiming", 0, 21)
+                .bit("shields_fry_infection_forms", 0, 22)
+                .bit("integrated_light_cntrls_weapon", 0, 23)
+                .bit("integrated_light_lasts_forever", 0, 24);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::UnitCameraTrack> {
+        static constexpr char const *name = "UnitCameraTrack";
+        static void describe(TypeBuilder<Engine::TagDefinitions::UnitCameraTrack> &type) {
+            using T = Engine::TagDefinitions::UnitCameraTrack;
+            type.field("track", &T::track);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::UnitUnitHudInterface> {
+        static constexpr char const *name = "UnitUnitHudInterface";
+        static void describe(TypeBuilder<Engine::TagDefinitions::UnitUnitHudInterface> &type) {
+            using T = Engine::TagDefinitions::UnitUnitHudInterface;
+            type.field("hud", &T::hud);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::UnitDialogueVariant> {
+        static constexpr char const *name = "UnitDialogueVariant";
+        static void describe(TypeBuilder<Engine::TagDefinitions::UnitDialogueVariant> &type) {
+            using T = Engine::TagDefinitions::UnitDialogueVariant;
+            type.field("variant_number", &T::variant_number)
+                .field("dialogue", &T::dialogue);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::UnitPoweredSeat> {
+        static constexpr char const *name = "UnitPoweredSeat";
+        static void describe(TypeBuilder<Engine::TagDefinitions::UnitPoweredSeat> &type) {
+            using T = Engine::TagDefinitions::UnitPoweredSeat;
+            type.field("driver_powerup_time", &T::driver_powerup_time)
+                .field("driver_powerdown_time", &T::driver_powerdown_time);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::UnitWeapon> {
+        static constexpr char const *name = "UnitWeapon";
+        static void describe(TypeBuilder<Engine::TagDefinitions::UnitWeapon> &type) {
+            using T = Engine::TagDefinitions::UnitWeapon;
+            type.field("weapon", &T::weapon);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::UnitSeatFlags> {
+        static constexpr char const *name = "UnitSeatFlags";
+        static void describe(TypeBuilder<Engine::TagDefinitions::UnitSeatFlags> &type) {
+            type.bit("invisible", 0, 0)
+                .bit("locked", 0, 1)
+                .bit("driver", 0, 2)
+                .bit("gunner", 0, 3)
+                .bit("third_person_camera", 0, 4)
+                .bit("allows_weapons", 0, 5)
+                .bit("third_person_on_enter", 0, 6)
+                .bit("first_person_camera_slaved_to_gun", 0, 7)
+                .bit("allow_vehicle_communication_animations", 0, 8)
+                .bit("not_valid_without_driver", 0, 9)
+                .bit("allow_ai_noncombatants", 0, 10);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::UnitSeat> {
+        static constexpr char const *name = "UnitSeat";
+        static void describe(TypeBuilder<Engine::TagDefinitions::UnitSeat> &type) {
+            using T = Engine::TagDefinitions::UnitSeat;
+            type.field("flags", &T::flags)
+                .field("label", &T::label)
+                .field("marker_name", &T::marker_name)
+                .field("acceleration_scale", &T::acceleration_scale)
+                .field("yaw_rate", &T::yaw_rate)
+                .field("pitch_rate", &T::pitch_rate)
+                .field("camera_marker_name", &T::camera_marker_name)
+                .field("camera_submerged_marker_name", &T::camera_submerged_marker_name)
+                .field("pitch_auto_level", &T::pitch_auto_level)
+                .field("pitch_range", &T::pitch_range)
+                .field("camera_tracks", &T::camera_tracks)
+                .field("unit_hud_interface", &T::unit_hud_interface)
+                .field("hud_text_message_index", &T::hud_text_message_index)
+                .field("yaw_minimum", &T::yaw_minimum)
+                .field("yaw_maximum", &T::yaw_maximum)
+                .field("built_in_gunner", &T::built_in_gunner);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::Unit> {
+        static constexpr char const *name = "Unit";
+        static void describe(TypeBuilder<Engine::TagDefinitions::Unit> &type) {
+            using T = Engine::TagDefinitions::Unit;
+            type.base<Engine::TagDefinitions::Object>()
+                .field("unit_flags", &T::unit_flags)
+                .field("default_team", &T::default_team)
+                .field("constant_sound_volume", &T::constant_sound_volume)
+                .field("rider_damage_fraction", &T::rider_damage_fraction)
+                .field("integrated_light_toggle", &T::integrated_light_toggle)
+                .field("unit_a_in", &T::unit_a_in)
+                .field("unit_b_in", &T::unit_b_in)
+                .field("unit_c_in", &T::unit_c_in)
+                .field("unit_d_in", &T::unit_d_in)
+                .field("camera_field_of_view", &T::camera_field_of_view)
+                .field("camera_stiffness", &T::camera_stiffness)
+                .field("camera_marker_name", &T::camera_marker_name)
+                .field("camera_submerged_marker_name", &T::camera_submerged_marker_name)
+                .field("pitch_auto_level", &T::pitch_auto_level)
+                .field("pitch_range", &T::pitch_range)
+                .field("camera_tracks", &T::camera_tracks)
+                .field("seat_acceleration_scale", &T::seat_acceleration_scale)
+                .field("soft_ping_threshold", &T::soft_ping_threshold)
+                .field("soft_ping_interrupt_time", &T::soft_ping_interrupt_time)
+                .field("hard_ping_threshold", &T::hard_ping_threshold)
+                .field("hard_ping_interrupt_time", &T::hard_ping_interrupt_time)
+                .field("hard_death_threshold", &T::hard_death_threshold)
+                .field("feign_death_threshold", &T::feign_death_threshold)
+                .field("feign_death_time", &T::feign_death_time)
+                .field("distance_of_evade_anim", &T::distance_of_evade_anim)
+                .field("distance_of_dive_anim", &T::distance_of_dive_anim)
+                .field("stunned_movement_threshold", &T::stunned_movement_threshold)
+                .field("feign_death_chance", &T::feign_death_chance)
+                .field("feign_repeat_chance", &T::feign_repeat_chance)
+                .field("spawned_actor", &T::spawned_actor)
+                .field("spawned_actor_count", &T::spawned_actor_count)
+                .field("spawned_velocity", &T::spawned_velocity)
+                .field("aiming_velocity_maximum", &T::aiming_velocity_maximum)
+                .field("aiming_acceleration_maximum", &T::aiming_acceleration_maximum)
+                .field("casual_aiming_modifier", &T::casual_aiming_modifier)
+                .field("looking_velocity_maximum", &T::looking_velocity_maximum)
+                .field("looking_acceleration_maximum", &T::looking_acceleration_maximum)
+                .field("ai_vehicle_radius", &T::ai_vehicle_radius)
+                .field("ai_danger_radius", &T::ai_danger_radius)
+                .field("melee_damage", &T::melee_damage)
+                .field("motion_sensor_blip_size", &T::motion_sensor_blip_size)
+                .field("metagame_type", &T::metagame_type)
+                .field("metagame_class", &T::metagame_class)
+                .field("new_hud_interfaces", &T::new_hud_interfaces)
+                .field("dialogue_variants", &T::dialogue_variants)
+                .field("grenade_velocity", &T::grenade_velocity)
+                .field("grenade_type", &T::grenade_type)
+                .field("grenade_count", &T::grenade_count)
+                .field("soft_ping_interrupt_ticks", &T::soft_ping_interrupt_ticks)
+                .field("hard_ping_interrupt_ticks", &T::hard_ping_interrupt_ticks)
+                .field("powered_seats", &T::powered_seats)
+                .field("weapons", &T::weapons)
+                .field("seats", &T::seats);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::BipedFlags> {
+        static constexpr char const *name = "BipedFlags";
+        static void describe(TypeBuilder<Engine::TagDefinitions::BipedFlags> &type) {
+            type.bit("turns_without_animating", 0, 0)
+                .bit("uses_player_physics", 0, 1)
+                .bit("flying", 0, 2)
+                .bit("physics_pill_centered_at_origin", 0, 3)
+                .bit("spherical", 0, 4)
+                .bit("passes_through_other_bipeds", 0, 5)
+                .bit("can_climb_any_surface", 0, 6)
+                .bit("immune_to_falling_damage", 0, 7)
+                .bit("rotate_while_airborne", 0, 8)
+                .bit("uses_limp_body_physics", 0, 9)
+                .bit("has_no_dying_airborne", 0, 10)
+                .bit("random_speed_increase", 0, 11)
+                .bit("unit_uses_old_ntsc_player_physics", 0, 12);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::BipedContactPoint> {
+        static constexpr char const *name = "BipedContactPoint";
+        static void describe(TypeBuilder<Engine::TagDefinitions::BipedContactPoint> &type) {
+            using T = Engine::TagDefinitions::BipedContactPoint;
+            type.field("marker_name", &T::marker_name);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::Biped> {
+        static constexpr char const *name = "Biped";
+        static void describe(TypeBuilder<Engine::TagDefinitions::Biped> &type) {
+            using T = Engine::TagDefinitions::Biped;
+            type.base<Engine::TagDefinitions::Unit>()
+                .field("moving_turning_speed", &T::moving_turning_speed)
+                .field("biped_flags", &T::biped_flags)
+                .field("stationary_turning_threshold", &T::stationary_turning_threshold)
+                .field("biped_a_in", &T::biped_a_in)
+                .field("biped_b_in", &T::biped_b_in)
+                .field("biped_c_in", &T::biped_c_in)
+                .field("biped_d_in", &T::biped_d_in)
+                .field("dont_use", &T::dont_use)
+                .field("bank_angle", &T::bank_angle)
+                .field("bank_apply_time", &T::bank_apply_time)
+                .field("bank_decay_time", &T::bank_decay_time)
+                .field("pitch_ratio", &T::pitch_ratio)
+                .field("max_velocity", &T::max_velocity)
+                .field("max_sidestep_velocity", &T::max_sidestep_velocity)
+                .field("acceleration", &T::acceleration)
+                .field("deceleration", &T::deceleration)
+                .field("angular_velocity_maximum", &T::angular_velocity_maximum)
+                .field("angular_acceleration_maximum", &T::angular_acceleration_maximum)
+                .field("crouch_velocity_modifier", &T::crouch_velocity_modifier)
+                .field("maximum_slope_angle", &T::maximum_slope_angle)
+                .field("downhill_falloff_angle", &T::downhill_falloff_angle)
+                .field("downhill_cutoff_angle", &T::downhill_cutoff_angle)
+                .field("downhill_velocity_scale", &T::downhill_velocity_scale)
+                .field("uphill_falloff_angle", &T::uphill_falloff_angle)
+                .field("uphill_cutoff_angle", &T::uphill_cutoff_angle)
+                .field("uphill_velocity_scale", &T::uphill_velocity_scale)
+                .field("footsteps", &T::footsteps)
+                .field("jump_velocity", &T::jump_velocity)
+                .field("maximum_soft_landing_time", &T::maximum_soft_landing_time)
+                .field("maximum_hard_landing_time", &T::maximum_hard_landing_time)
+                .field("minimum_soft_landing_velocity", &T::minimum_soft_landing_velocity)
+                .field("minimum_hard_landing_velocity", &T::minimum_hard_landing_velocity)
+                .field("maximum_hard_landing_velocity", &T::maximum_hard_landing_velocity)
+                .field("death_hard_landing_velocity", &T::death_hard_landing_velocity)
+                .field("standing_camera_height", &T::standing_camera_height)
+                .field("crouching_camera_height", &T::crouching_camera_height)
+                .field("crouch_transition_time", &T::crouch_transition_time)
+                .field("standing_collision_height", &T::standing_collision_height)
+                .field("crouching_collision_height", &T::crouching_collision_height)
+                .field("collision_radius", &T::collision_radius)
+                .field("autoaim_width", &T::autoaim_width)
+                .field("cosine_stationary_turning_threshold", &T::cosine_stationary_turning_threshold)
+                .field("crouch_camera_velocity", &T::crouch_camera_velocity)
+                .field("cosine_maximum_slope_angle", &T::cosine_maximum_slope_angle)
+                .field("negative_sine_downhill_falloff_angle", &T::negative_sine_downhill_falloff_angle)
+                .field("negative_sine_downhill_cutoff_angle", &T::negative_sine_downhill_cutoff_angle)
+                .field("sine_uphill_falloff_angle", &T::sine_uphill_falloff_angle)
+                .field("sine_uphill_cutoff_angle", &T::sine_uphill_cutoff_angle)
+                .field("pelvis_model_node_index", &T::pelvis_model_node_index)
+                .field("head_model_node_index", &T::head_model_node_index)
+                .field("contact_point", &T::contact_point);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::VehicleFlags> {
+        static constexpr char const *name = "VehicleFlags";
+        static void describe(TypeBuilder<Engine::TagDefinitions::VehicleFlags> &type) {
+            type.bit("speed_wakes_physics", 0, 0)
+                .bit("turn_wakes_physics", 0, 1)
+                .bit("driver_power_wakes_physics", 0, 2)
+                .bit("gunner_power_wakes_physics", 0, 3)
+                .bit("control_opposite_speed_sets_brake", 0, 4)
+                .bit("slide_wakes_physics", 0, 5)
+                .bit("kills_riders_at_terminal_velocity", 0, 6)
+                .bit("causes_collision_damage", 0, 7)
+                .bit("ai_weapon_cannot_rotate", 0, 8)
+                .bit("ai_does_not_require_driver", 0, 9)
+                .bit("ai_unused", 0, 10)
+                .bit("ai_driver_enable", 0, 11)
+                .bit("ai_driver_flying", 0, 12)
+                .bit("ai_driver_can_sidestep", 0, 13)
+                .bit("ai_driver_hovering", 0, 14)
+                .bit("vehicle_steers_directly", 0, 15)
+                .bit("unused", 0, 16)
+                .bit("has_ebrake", 0, 17)
+                .bit("noncombat_vehicle", 0, 18)
+                .bit("no_friction_with_driver", 0, 19)
+                .bit("can_trigger_automatic_opening_doors", 0, 20)
+                .bit("autoaim_when_teamless", 0, 21);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::Vehicle> {
+        static constexpr char const *name = "Vehicle";
+        static void describe(TypeBuilder<Engine::TagDefinitions::Vehicle> &type) {
+            using T = Engine::TagDefinitions::Vehicle;
+            type.base<Engine::TagDefinitions::Unit>()
+                .field("vehicle_flags", &T::vehicle_flags)
+                .field("vehicle_type", &T::vehicle_type)
+                .field("maximum_forward_speed", &T::maximum_forward_speed)
+                .field("maximum_reverse_speed", &T::maximum_reverse_speed)
+                .field("speed_acceleration", &T::speed_acceleration)
+                .field("speed_deceleration", &T::speed_deceleration)
+                .field("maximum_left_turn", &T::maximum_left_turn)
+                .field("maximum_right_turn", &T::maximum_right_turn)
+                .field("wheel_circumference", &T::wheel_circumference)
+                .field("turn_rate", &T::turn_rate)
+                .field("blur_speed", &T::blur_speed)
+                .field("vehicle_a_in", &T::vehicle_a_in)
+                .field("vehicle_b_in", &T::vehicle_b_in)
+                .field("vehicle_c_in", &T::vehicle_c_in)
+                .field("vehicle_d_in", &T::vehicle_d_in)
+                .field("maximum_left_slide", &T::maximum_left_slide)
+                .field("maximum_right_slide", &T::maximum_right_slide)
+                .field("slide_acceleration", &T::slide_acceleration)
+                .field("slide_deceleration", &T::slide_deceleration)
+                .field("minimum_flipping_angular_velocity", &T::minimum_flipping_angular_velocity)
+                .field("maximum_flipping_angular_velocity", &T::maximum_flipping_angular_velocity)
+                .field("fixed_gun_yaw", &T::fixed_gun_yaw)
+                .field("fixed_gun_pitch", &T::fixed_gun_pitch)
+                .field("ai_sideslip_distance", &T::ai_sideslip_distance)
+                .field("ai_destination_radius", &T::ai_destination_radius)
+                .field("ai_avoidance_distance", &T::ai_avoidance_distance)
+                .field("ai_pathfinding_radius", &T::ai_pathfinding_radius)
+                .field("ai_charge_repeat_timeout", &T::ai_charge_repeat_timeout)
+                .field("ai_strafing_abort_range", &T::ai_strafing_abort_range)
+                .field("ai_oversteering_bounds", &T::ai_oversteering_bounds)
+                .field("ai_steering_maximum", &T::ai_steering_maximum)
+                .field("ai_throttle_maximum", &T::ai_throttle_maximum)
+                .field("ai_move_position_time", &T::ai_move_position_time)
+                .field("suspension_sound", &T::suspension_sound)
+                .field("crash_sound", &T::crash_sound)
+                .field("material_effects", &T::material_effects)
+                .field("effect", &T::effect);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::ItemFlags> {
+        static constexpr char const *name = "ItemFlags";
+        static void describe(TypeBuilder<Engine::TagDefinitions::ItemFlags> &type) {
+            type.bit("always_maintains_z_up", 0, 0)
+                .bit("destroyed_by_explosions", 0, 1)
+                .bit("unaffected_by_gravity", 0, 2);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::Item> {
+        static constexpr char const *name = "Item";
+        static void describe(TypeBuilder<Engine::TagDefinitions::Item> &type) {
+            using T = Engine::TagDefinitions::Item;
+            type.base<Engine::TagDefinitions::Object>()
+                .field("item_flags", &T::item_flags)
+                .field("pickup_text_index", &T::pickup_text_index)
+                .field("sort_order", &T::sort_order)
+                .field("scale", &T::scale)
+                .field("hud_message_value_scale", &T::hud_message_value_scale)
+                .field("item_a_in", &T::item_a_in)
+                .field("item_b_in", &T::item_b_in)
+                .field("item_c_in", &T::item_c_in)
+                .field("item_d_in", &T::item_d_in)
+                .field("material_effects", &T::material_effects)
+                .field("collision_sound", &T::collision_sound)
+                .field("detonation_delay", &T::detonation_delay)
+                .field("detonating_effect", &T::detonating_effect)
+                .field("detonation_effect", &T::detonation_effect);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::WeaponFlags> {
+        static constexpr char const *name = "WeaponFlags";
+        static void describe(TypeBuilder<Engine::TagDefinitions::WeaponFlags> &type) {
+            type.bit("vertical_heat_display", 0, 0)
+                .bit("mutually_exclusive_triggers", 0, 1)
+                .bit("attacks_automatically_on_bump", 0, 2)
+                .bit("must_be_readied", 0, 3)
+                .bit("doesnt_count_toward_maximum", 0, 4)
+                .bit("aim_assists_only_when_zoomed", 0, 5)
+                .bit("prevents_grenade_throwing", 0, 6)
+                .bit("must_be_picked_up", 0, 7)
+                .bit("holds_triggers_when_dropped", 0, 8)
+                .bit("prevents_melee_attack", 0, 9)
+                .bit("detonates_when_dropped", 0, 10)
+                .bit("cannot_fire_at_maximum_age", 0, 11)
+                .bit("secondary_trigger_overrides_grenades", 0, 12)
+                .bit("obsolete_does_not_depower_active_camo_in_multilplayer", 0, 13)
+                .bit("enables_integrated_night_vision", 0, 14)
+                .bit("ais_use_weapon_melee_damage", 0, 15);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::WeaponMagazineFlags> {
+        static constexpr char const *name = "WeaponMagazineFlags";
+        static void describe(TypeBuilder<Engine::TagDefinitions::WeaponMagazineFlags> &type) {
+            type.bit("wastes_rounds_when_reloaded", 0, 0)
+                .bit("every_round_must_be_chambered", 0, 1);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::WeaponMagazineObject> {
+        static constexpr char const *name = "WeaponMagazineObject";
+        static void describe(TypeBuilder<Engine::TagDefinitions::WeaponMagazineObject> &type) {
+            using T = Engine::TagDefinitions::WeaponMagazineObject;
+            type.field("rounds", &T::rounds)
+                .field("equipment", &T::equipment);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::WeaponMagazine> {
+        static constexpr char const *name = "WeaponMagazine";
+        static void describe(TypeBuilder<Engine::TagDefinitions::WeaponMagazine> &type) {
+            using T = Engine::TagDefinitions::WeaponMagazine;
+            type.field("flags", &T::flags)
+                .field("rounds_recharged", &T::rounds_recharged)
+                .field("rounds_total_initial", &T::rounds_total_initial)
+                .field("rounds_reserved_maximum", &T::rounds_reserved_maximum)
+                .field("rounds_loaded_maximum", &T::rounds_loaded_maximum)
+                .field("reload_time", &T::reload_time)
+                .field("rounds_reloaded", &T::rounds_reloaded)
+                .field("chamber_time", &T::chamber_time)
+                .field("reloading_effect", &T::reloading_effect)
+                .field("chambering_effect", &T::chambering_effect)
+                .field("magazine_objects", &T::magazine_objects);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::WeaponTriggerFlags> {
+        static constexpr char const *name = "WeaponTriggerFlags";
+        static void describe(TypeBuilder<Engine::TagDefinitions::WeaponTriggerFlags> &type) {
+            type.bit("tracks_fired_projectile", 0, 0)
+                .bit("random_firing_effects", 0, 1)
+                .bit("can_fire_with_partial_ammo", 0, 2)
+                .bit("does_not_repeat_automatically", 0, 3)
+                .bit("locks_in_on_off_state", 0, 4)
+                .bit("projectiles_use_weapon_origin", 0, 5)
+                .bit("sticks_when_dropped", 0, 6)
+                .bit("ejects_during_chamber", 0, 7)
+                .bit("discharging_spews", 0, 8)
+                .bit("analog_rate_of_fire", 0, 9)
+                .bit("use_error_when_unzoomed", 0, 10)
+                .bit("projectile_vector_cannot_be_adjusted", 0, 11)
+                .bit("projectiles_have_identical_error", 0, 12)
+                .bit("projectile_is_client_side_only", 0, 13)
+                .bit("use_original_unit_adjust_projectile_ray", 0, 14);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::WeaponTriggerFiringEffect> {
+        static constexpr char const *name = "WeaponTriggerFiringEffect";
+        static void describe(TypeBuilder<Engine::TagDefinitions::WeaponTriggerFiringEffect> &type) {
+            using T = Engine::TagDefinitions::WeaponTriggerFiringEffect;
+            type.field("shot_count_lower_bound", &T::shot_count_lower_bound)
+                .field("shot_count_upper_bound", &T::shot_count_upper_bound)
+                .field("firing_effect", &T::firing_effect)
+                .field("misfire_effect", &T::misfire_effect)
+                .field("empty_effect", &T::empty_effect)
+                .field("firing_damage", &T::firing_damage)
+                .field("misfire_damage", &T::misfire_damage)
+                .field("empty_damage", &T::empty_damage);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::WeaponTrigger> {
+        static constexpr char const *name = "WeaponTrigger";
+        static void describe(TypeBuilder<Engine::TagDefinitions::WeaponTrigger> &type) {
+            using T = Engine::TagDefinitions::WeaponTrigger;
+            type.field("flags", &T::flags)
+                .field("maximum_rate_of_fire", &T::maximum_rate_of_fire)
+                .field("acceleration_time", &T::acceleration_time)
+                .field("deceleration_time", &T::deceleration_time)
+                .field("blurred_rate_of_fire", &T::blurred_rate_of_fire)
+                .field("magazine", &T::magazine)
+                .field("rounds_per_shot", &T::rounds_per_shot)
+                .field("minimum_rounds_loaded", &T::minimum_rounds_loaded)
+                .field("projectiles_between_contrails", &T::projectiles_between_contrails)
+                .field("prediction_type", &T::prediction_type)
+                .field("firing_noise", &T::firing_noise)
+                .field("error", &T::error)
+                .field("error_acceleration_time", &T::error_acceleration_time)
+                .field("error_deceleration_time", &T::error_deceleration_time)
+                .field("charging_time", &T::charging_time)
+                .field("charged_time", &T::charged_time)
+                .field("overcharged_action", &T::overcharged_action)
+                .field("charged_illumination", &T::charged_illumination)
+                .field("spew_time", &T::spew_time)
+                .field("charging_effect", &T::charging_effect)
+                .field("distribution_function", &T::distribution_function)
+                .field("projectiles_per_shot", &T::projectiles_per_shot)
+                .field("distribution_angle", &T::distribution_angle)
+                .field("minimum_error", &T::minimum_error)
+                .field("error_angle", &T::error_angle)
+                .field("first_person_offset", &T::first_person_offset)
+                .field("projectile", &T::projectile)
+                .field("ejection_port_recovery_time", &T::ejection_port_recovery_time)
+                .field("illumination_recovery_time", &T::illumination_recovery_time)
+                .field("heat_generated_per_round", &T::heat_generated_per_round)
+                .field("age_generated_per_round", &T::age_generated_per_round)
+                .field("overload_time", &T::overload_time)
+                .field("illumination_recovery_rate", &T::illumination_recovery_rate)
+                .field("ejection_port_recovery_rate", &T::ejection_port_recovery_rate)
+                .field("firing_acceleration_rate", &T::firing_acceleration_rate)
+                .field("firing_deceleration_rate", &T::firing_deceleration_rate)
+                .field("error_acceleration_rate", &T::error_acceleration_rate)
+                .field("error_deceleration_rate", &T::error_deceleration_rate)
+                .field("firing_effects", &T::firing_effects);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::Weapon> {
+        static constexpr char const *name = "Weapon";
+        static void describe(TypeBuilder<Engine::TagDefinitions::Weapon> &type) {
+            using T = Engine::TagDefinitions::Weapon;
+            type.base<Engine::TagDefinitions::Item>()
+                .field("weapon_flags", &T::weapon_flags)
+                .field("label", &T::label)
+                .field("secondary_trigger_mode", &T::secondary_trigger_mode)
+                .field("maximum_alternate_shots_loaded", &T::maximum_alternate_shots_loaded)
+                .field("weapon_a_in", &T::weapon_a_in)
+                .field("weapon_b_in", &T::weapon_b_in)
+                .field("weapon_c_in", &T::weapon_c_in)
+                .field("weapon_d_in", &T::weapon_d_in)
+                .field("ready_time", &T::ready_time)
+                .field("ready_effect", &T::ready_effect)
+                .field("heat_recovery_threshold", &T::heat_recovery_threshold)
+                .field("overheated_threshold", &T::overheated_threshold)
+                .field("heat_detonation_threshold", &T::heat_detonation_threshold)
+                .field("heat_detonation_fraction", &T::heat_detonation_fraction)
+                .field("heat_loss_rate", &T::heat_loss_rate)
+                .field("heat_illumination", &T::heat_illumination)
+                .field("overheated", &T::overheated)
+                .field("overheat_detonation", &T::overheat_detonation)
+                .field("player_melee_damage", &T::player_melee_damage)
+                .field("player_melee_response", &T::player_melee_response)
+                .field("actor_firing_parameters", &T::actor_firing_parameters)
+                .field("near_reticle_range", &T::near_reticle_range)
+                .field("far_reticle_range", &T::far_reticle_range)
+                .field("intersection_reticle_range", &T::intersection_reticle_range)
+                .field("zoom_levels", &T::zoom_levels)
+                .field("zoom_magnification_range", &T::zoom_magnification_range)
+                .field("autoaim_angle", &T::autoaim_angle)
+                .field("autoaim_range", &T::autoaim_range)
+                .field("magnetism_angle", &T::magnetism_angle)
+                .field("magnetism_range", &T::magnetism_range)
+                .field("deviation_angle", &T::deviation_angle)
+                .field("movement_penalized", &T::movement_penalized)
+                .field("forward_movement_penalty", &T::forward_movement_penalty)
+                .field("sideways_movement_penalty", &T::sideways_movement_penalty)
+                .field("minimum_target_range", &T::minimum_target_range)
+                .field("looking_time_modifier", &T::looking_time_modifier)
+                .field("light_power_on_time", &T::light_power_on_time)
+                .field("light_power_off_time", &T::light_power_off_time)
+                .field("light_power_on_effect", &T::light_power_on_effect)
+                .field("light_power_off_effect", &T::light_power_off_effect)
+                .field("age_heat_recovery_penalty", &T::age_heat_recovery_penalty)
+                .field("age_rate_of_fire_penalty", &T::age_rate_of_fire_penalty)
+                .field("age_misfire_start", &T::age_misfire_start)
+                .field("age_misfire_chance", &T::age_misfire_chance)
+                .field("first_person_model", &T::first_person_model)
+                .field("first_person_animations", &T::first_person_animations)
+                .field("hud_interface", &T::hud_interface)
+                .field("pickup_sound", &T::pickup_sound)
+                .field("zoom_in_sound", &T::zoom_in_sound)
+                .field("zoom_out_sound", &T::zoom_out_sound)
+                .field("active_camo_ding", &T::active_camo_ding)
+                .field("active_camo_regrowth_rate", &T::active_camo_regrowth_rate)
+                .field("weapon_type", &T::weapon_type)
+                .field("more_predicted_resources", &T::more_predicted_resources)
+                .field("magazines", &T::magazines)
+                .field("triggers", &T::triggers);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::Equipment> {
+        static constexpr char const *name = "Equipment";
+        static void describe(TypeBuilder<Engine::TagDefinitions::Equipment> &type) {
+            using T = Engine::TagDefinitions::Equipment;
+            type.base<Engine::TagDefinitions::Item>()
+                .field("powerup_type", &T::powerup_type)
+                .field("grenade_type", &T::grenade_type)
+                .field("powerup_time", &T::powerup_time)
+                .field("pickup_sound", &T::pickup_sound);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::Garbage> {
+        static constexpr char const *name = "Garbage";
+        static void describe(TypeBuilder<Engine::TagDefinitions::Garbage> &type) {
+            type.base<Engine::TagDefinitions::Item>();
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::ProjectileFlags> {
+        static constexpr char const *name = "ProjectileFlags";
+        static void describe(TypeBuilder<Engine::TagDefinitions::ProjectileFlags> &type) {
+            type.bit("oriented_along_velocity", 0, 0)
+                .bit("ai_must_use_ballistic_aiming", 0, 1)
+                .bit("detonation_max_time_if_attached", 0, 2)
+                .bit("has_super_combining_explosion", 0, 3)
+                .bit("combine_initial_velocity_with_parent_velocity", 0, 4)
+                .bit("random_attached_detonation_time", 0, 5)
+                .bit("minimum_unattached_detonation_time", 0, 6);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::ProjectileMaterialResponseFlags> {
+        static constexpr char const *name = "ProjectileMaterialResponseFlags";
+        static void describe(TypeBuilder<Engine::TagDefinitions::ProjectileMaterialResponseFlags> &type) {
+            type.bit("cannot_be_overpenetrated", 0, 0);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::ProjectileMaterialResponsePotentialFlags> {
+        static constexpr char const *name = "ProjectileMaterialResponsePotentialFlags";
+        static void describe(TypeBuilder<Engine::TagDefinitions::ProjectileMaterialResponsePotentialFlags> &type) {
+            type.bit("only_against_units", 0, 0)
+                .bit("never_against_units", 0, 1);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::ProjectileMaterialResponse> {
+        static constexpr char const *name = "ProjectileMaterialResponse";
+        static void describe(TypeBuilder<Engine::TagDefinitions::ProjectileMaterialResponse> &type) {
+            using T = Engine::TagDefinitions::ProjectileMaterialResponse;
+            type.field("flags", &T::flags)
+                .field("default_response", &T::default_response)
+                .field("default_effect", &T::default_effect)
+                .field("potential_response", &T::potential_response)
+                .field("potential_flags", &T::potential_flags)
+                .field("potential_skip_fraction", &T::potential_skip_fraction)
+                .field("potential_between", &T::potential_between)
+                .field("potential_and", &T::potential_and)
+                .field("potential_effect", &T::potential_effect)
+                .field("scale_effects_by", &T::scale_effects_by)
+                .field("angular_noise", &T::angular_noise)
+                .field("velocity_noise", &T::velocity_noise)
+                .field("detonation_effect", &T::detonation_effect)
+                .field("initial_friction", &T::initial_friction)
+                .field("maximum_distance", &T::maximum_distance)
+                .field("parallel_friction", &T::parallel_friction)
+                .field("perpendicular_friction", &T::perpendicular_friction);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::Projectile> {
+        static constexpr char const *name = "Projectile";
+        static void describe(TypeBuilder<Engine::TagDefinitions::Projectile> &type) {
+            using T = Engine::TagDefinitions::Projectile;
+            type.base<Engine::TagDefinitions::Object>()
+                .field("projectile_flags", &T::projectile_flags)
+                .field("detonation_timer_starts", &T::detonation_timer_starts)
+                .field("impact_noise", &T::impact_noise)
+                .field("projectile_a_in", &T::projectile_a_in)
+                .field("projectile_b_in", &T::projectile_b_in)
+                .field("projectile_c_in", &T::projectile_c_in)
+                .field("projectile_d_in", &T::projectile_d_in)
+                .field("super_detonation", &T::super_detonation)
+                .field("ai_perception_radius", &T::ai_perception_radius)
+                .field("collision_radius", &T::collision_radius)
+                .field("arming_time", &T::arming_time)
+                .field("danger_radius", &T::danger_radius)
+                .field("effect", &T::effect)
+                .field("timer", &T::timer)
+                .field("minimum_velocity", &T::minimum_velocity)
+                .field("maximum_range", &T::maximum_range)
+                .field("air_gravity_scale", &T::air_gravity_scale)
+                .field("air_damage_range", &T::air_damage_range)
+                .field("water_gravity_scale", &T::water_gravity_scale)
+                .field("water_damage_range", &T::water_damage_range)
+                .field("initial_velocity", &T::initial_velocity)
+                .field("final_velocity", &T::final_velocity)
+                .field("guided_angular_velocity", &T::guided_angular_velocity)
+                .field("detonation_noise", &T::detonation_noise)
+                .field("detonation_started", &T::detonation_started)
+                .field("flyby_sound", &T::flyby_sound)
+                .field("attached_detonation_damage", &T::attached_detonation_damage)
+                .field("impact_damage", &T::impact_damage)
+                .field("projectile_material_response", &T::projectile_material_response);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::BaseObjectFlags> {
+        static constexpr char const *name = "BaseObjectFlags";
+        static void describe(TypeBuilder<Engine::TagDefinitions::BaseObjectFlags> &type) {
+            type.bit("off_in_pegasus", 0, 0);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::BasicObject> {
+        static constexpr char const *name = "BasicObject";
+        static void describe(TypeBuilder<Engine::TagDefinitions::BasicObject> &type) {
+            using T = Engine::TagDefinitions::BasicObject;
+            type.base<Engine::TagDefinitions::Object>()
+                .field("more_flags", &T::more_flags);
+        }
+    };
+
+    template<> struct Describe<Engine::TagDefinitions::Scenery> {
+        static constexpr char const *name = "Scenery";
+        static void describe(TypeBuilder<Engine::TagDefinitions::Scenery> &type) {
+            type.base<Engine::TagDefinitions::BasicObject>();
+        }
+    };
+
+}
+
+#endif
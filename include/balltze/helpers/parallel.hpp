@@ -0,0 +1,233 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_API__HELPERS__PARALLEL_HPP
+#define BALLTZE_API__HELPERS__PARALLEL_HPP
+
+#include <cstddef>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Balltze {
+    /**
+     * Persistent pool of worker threads used by parallel_for. Workers are started when a
+     * job first needs them and then wait for the next job.
+     *
+     * The pool runs one job at a time. A job started from inside a job, or while another
+     * thread's job is running, runs on the calling thread instead of waiting.
+     *
+     * Call shutdown() when the plugin is unloaded. Threads cannot be joined while the
+     * loader lock is held, so the destructor only tells the workers to stop and detaches them.
+     */
+    class ThreadPool {
+    public:
+        /**
+         * Get the pool of the current module
+         */
+        static ThreadPool &get() noexcept {
+            static ThreadPool pool;
+            return pool;
+        }
+
+        /**
+         * Run a function for every index in [0, count); the calling thread takes part
+         * @param count     number of items
+         * @param function  function to call; called concurrently
+         * @param threads   number of threads to use, counting the calling thread; 0 to use every hardware thread
+         * @throws          the first exception thrown by the function
+         */
+        void run(std::size_t count, std::function<void(std::size_t)> const &function, std::size_t threads = 0) {
+            if(threads == 0) {
+                threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+            }
+            threads = std::min(threads, count);
+            // Checked before locking; the thread running a job already holds the lock
+            std::unique_lock<std::mutex> job_lock(m_job_mutex, std::defer_lock);
+            if(threads <= 1 || in_job() || !job_lock.try_lock()) {
+                for(std::size_t i = 0; i < count; i++) {
+                    function(i);
+                }
+                return;
+            }
+            JobGuard guard;
+
+            while(m_threads.size() < threads - 1) {
+                m_threads.emplace_back(&ThreadPool::work, m_state);
+            }
+
+            auto &state = *m_state;
+            {
+                std::lock_guard<std::mutex> lock(state.mutex);
+                state.function = &function;
+                state.count = count;
+                state.next.store(0, std::memory_order_relaxed);
+                state.exception = nullptr;
+                state.wanted = threads - 1;
+                state.job++;
+            }
+            state.work_condition.notify_all();
+            execute(state);
+
+            std::exception_ptr exception;
+            {
+                // Workers that have not picked the job up yet must not start it after this returns
+                std::unique_lock<std::mutex> lock(state.mutex);
+                state.wanted = 0;
+                state.done_condition.wait(lock, [&state]() {
+                    return state.active == 0;
+                });
+                state.function = nullptr;
+                exception = state.exception;
+                state.exception = nullptr;
+            }
+            if(exception) {
+                std::rethrow_exception(exception);
+            }
+        }
+
+        /**
+         * Stop and join the workers. Call it when the plugin is being unloaded, before
+         * returning from the unload function. A later job starts them again.
+         */
+        void shutdown() {
+            std::lock_guard<std::mutex> job_lock(m_job_mutex);
+            stop();
+            for(auto &thread : m_threads) {
+                thread.join();
+            }
+            m_threads.clear();
+            m_state = std::make_shared<State>();
+        }
+
+        /**
+         * Get the number of worker threads started
+         */
+        std::size_t size() noexcept {
+            std::lock_guard<std::mutex> job_lock(m_job_mutex);
+            return m_threads.size();
+        }
+
+        ThreadPool(ThreadPool const &) = delete;
+        ThreadPool &operator=(ThreadPool const &) = delete;
+
+        ~ThreadPool() {
+            stop();
+            for(auto &thread : m_threads) {
+                thread.detach();
+            }
+        }
+
+    private:
+        /**
+         * State shared with the workers; they keep it alive after the pool is destroyed
+         */
+        struct State {
+            std::mutex mutex;
+            std::condition_variable work_condition;
+            std::condition_variable done_condition;
+            std::function<void(std::size_t)> const *function = nullptr;
+            std::size_t count = 0;
+            std::atomic<std::size_t> next = 0;
+            std::exception_ptr exception;
+
+            /** Incremented for every job */
+            std::size_t job = 0;
+
+            /** Number of workers that may still join the current job */
+            std::size_t wanted = 0;
+
+            /** Number of workers running the current job */
+            std::size_t active = 0;
+
+            bool stop = false;
+        };
+
+        std::shared_ptr<State> m_state = std::make_shared<State>();
+        std::vector<std::thread> m_threads;
+        std::mutex m_job_mutex;
+
+        ThreadPool() = default;
+
+        /** Whether the current thread is a worker or is running a job of the pool */
+        static bool &in_job() noexcept {
+            thread_local bool in_job = false;
+            return in_job;
+        }
+
+        struct JobGuard {
+            JobGuard() noexcept {
+                in_job() = true;
+            }
+
+            ~JobGuard() {
+                in_job() = false;
+            }
+        };
+
+        void stop() {
+            {
+                std::lock_guard<std::mutex> lock(m_state->mutex);
+                m_state->stop = true;
+            }
+            m_state->work_condition.notify_all();
+        }
+
+        static void execute(State &state) {
+            std::size_t i;
+            while((i = state.next.fetch_add(1, std::memory_order_relaxed)) < state.count) {
+                try {
+                    (*state.function)(i);
+                }
+                catch(...) {
+                    std::lock_guard<std::mutex> lock(state.mutex);
+                    if(!state.exception) {
+                        state.exception = std::current_exception();
+                    }
+                    state.next.store(state.count, std::memory_order_relaxed);
+                }
+            }
+        }
+
+        static void work(std::shared_ptr<State> state) {
+            in_job() = true;
+            std::size_t last_job = 0;
+            std::unique_lock<std::mutex> lock(state->mutex);
+            while(true) {
+                state->work_condition.wait(lock, [&]() {
+                    return state->stop || (state->job != last_job && state->wanted > 0);
+                });
+                if(state->stop) {
+                    return;
+                }
+                last_job = state->job;
+                state->wanted--;
+                state->active++;
+                lock.unlock();
+                execute(*state);
+                lock.lock();
+                if(--state->active == 0) {
+                    state->done_condition.notify_all();
+                }
+            }
+        }
+    };
+
+    /**
+     * Run a function for every index in [0, count) on the thread pool of the current module
+     * @param count     number of items
+     * @param function  function to call; called concurrently
+     * @param threads   number of threads to use; 0 to use every hardware thread
+     * @throws          the first exception thrown by the function
+     */
+    inline void parallel_for(std::size_t count, std::function<void(std::size_t)> const &function, std::size_t threads = 0) {
+        ThreadPool::get().run(count, function, threads);
+    }
+}
+
+#endif
@@ -0,0 +1,255 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_API__HELPERS__PLAYER_LIST_TRACKER_HPP
+#define BALLTZE_API__HELPERS__PLAYER_LIST_TRACKER_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <optional>
+#include <vector>
+#include "../engine/multiplayer.hpp"
+
+#ifdef _WIN32
+#include "../events/tick.hpp"
+#endif
+
+namespace Balltze {
+    enum PlayerListChangeType : std::uint8_t {
+        PLAYER_LIST_CHANGE_JOIN = 1 << 0,
+        PLAYER_LIST_CHANGE_LEAVE = 1 << 1,
+        PLAYER_LIST_CHANGE_TEAM = 1 << 2,
+        PLAYER_LIST_CHANGE_RENAME = 1 << 3,
+        PLAYER_LIST_CHANGE_ALL = 0xF
+    };
+
+    /**
+     * Change of a slot of the server player list
+     */
+    struct PlayerListChange {
+        PlayerListChangeType type;
+
+        /** Index of the slot in the player list */
+        std::uint8_t slot;
+
+        /** Slot before the change; not present for joins */
+        Engine::ServerInfoPlayer previous;
+
+        /** Slot after the change; not present for leaves */
+        Engine::ServerInfoPlayer current;
+
+        /** 
+         * Machine of the player, copied when the change is found; the machine of the 
+         * previous player for leaves, which may already be reused or cleared. 
+         * Not present if no server info was given or the player has no machine.
+         */
+        std::optional<Engine::ServerInfoMachine> machine;
+    };
+
+    /**
+     * Tracker of the server player list.
+     *
+     * The list is snapshotted once per tick and compared slot by slot with the
+     * snapshot of the previous tick. Each change is dispatched to the listeners
+     * subscribed to its type. If a slot is reused by another player within a single
+     * tick, a leave and then a join are dispatched. The machine of the player is 
+     * looked up only for changed slots.
+     *
+     * Deduplication is per plugin only: every module has its own tracker, so each 
+     * plugin that uses it still snapshots and compares the list once per tick.
+     */
+    class PlayerListTracker {
+    public:
+        using ServerInfoPlayer = Engine::ServerInfoPlayer;
+        using Listener = std::function<void(PlayerListChange const &change)>;
+
+        static constexpr std::size_t MAX_PLAYERS = sizeof(Engine::ServerInfoPlayerList::players) / sizeof(ServerInfoPlayer);
+
+        PlayerListTracker() {
+            reset();
+        }
+
+        PlayerListTracker(PlayerListTracker const &) = delete;
+        PlayerListTracker &operator=(PlayerListTracker const &) = delete;
+
+        /**
+         * Subscribe to changes
+         * @param listener  function to call for each change
+         * @param types     mask of the PlayerListChangeType values to listen to
+         * @return          handle of the listener
+         */
+        std::size_t subscribe(Listener listener, std::uint8_t types = PLAYER_LIST_CHANGE_ALL) {
+            auto handle = m_next_handle++;
+            m_listeners.push_back({ handle, types, std::move(listener) });
+            return handle;
+        }
+
+        /**
+         * Unsubscribe a listener; it may be called from a listener
+         * @param handle    handle of the listener
+         */
+        void unsubscribe(std::size_t handle) noexcept {
+            for(auto &listener : m_listeners) {
+                if(listener.handle == handle) {
+                    listener.types = 0;
+                }
+            }
+            m_removed = true;
+        }
+
+        /**
+         * Compare the player list with the previous snapshot and dispatch the changes
+         * @param list    player list; null if there is none, which counts as an empty list
+         * @param server  server info to get the machines of the players from; null to leave them out
+         * @return        number of changes dispatched
+         */
+        std::size_t update(Engine::ServerInfoPlayerList const *list, Engine::ServerInfo *server = nullptr) {
+            std::array<ServerInfoPlayer, MAX_PLAYERS> players;
+            if(list) {
+                std::memcpy(players.data(), list->players, sizeof(players));
+            }
+            else {
+                std::memset(players.data(), 0xFF, sizeof(players));
+            }
+            if(std::memcmp(players.data(), m_players.data(), sizeof(players)) == 0) {
+                return 0;
+            }
+
+            std::size_t count = 0;
+            m_changes.clear();
+            for(std::size_t i = 0; i < MAX_PLAYERS; i++) {
+                auto const &previous = m_players[i];
+                auto const &current = players[i];
+                if(std::memcmp(&previous, &current, sizeof(ServerInfoPlayer)) == 0) {
+                    continue;
+                }
+                bool was_present = is_present(previous);
+                bool present = is_present(current);
+                auto slot = static_cast<std::uint8_t>(i);
+                if(was_present && present && (previous.player_id != current.player_id || previous.machine_index != current.machine_index)) {
+                    m_changes.push_back({ PLAYER_LIST_CHANGE_LEAVE, slot, previous, current, std::nullopt });
+                    m_changes.push_back({ PLAYER_LIST_CHANGE_JOIN, slot, previous, current, std::nullopt });
+                }
+                else if(was_present && present) {
+                    if(previous.team != current.team) {
+                        m_changes.push_back({ PLAYER_LIST_CHANGE_TEAM, slot, previous, current, std::nullopt });
+                    }
+                    if(std::memcmp(previous.name, current.name, sizeof(previous.name)) != 0) {
+                        m_changes.push_back({ PLAYER_LIST_CHANGE_RENAME, slot, previous, current, std::nullopt });
+                    }
+                }
+                else if(present) {
+                    m_changes.push_back({ PLAYER_LIST_CHANGE_JOIN, slot, previous, current, std::nullopt });
+                }
+                else if(was_present) {
+                    m_changes.push_back({ PLAYER_LIST_CHANGE_LEAVE, slot, previous, current, std::nullopt });
+                }
+            }
+            m_players = players;
+
+            if(server) {
+                for(auto &change : m_changes) {
+                    auto const &player = change.type == PLAYER_LIST_CHANGE_LEAVE ? change.previous : change.current;
+                    if(player.machine_index != 0xFF) {
+                        change.machine = server->get_machine(player.machine_index);
+                    }
+                }
+            }
+
+            // Listeners may subscribe while changes are dispatched; new ones get the next changes
+            auto listener_count = m_listeners.size();
+            for(auto const &change : m_changes) {
+                for(std::size_t i = 0; i < listener_count; i++) {
+                    if(m_listeners[i].types & change.type) {
+                        auto callback = m_listeners[i].callback;
+                        callback(change);
+                    }
+                }
+                count++;
+            }
+            if(m_removed) {
+                m_listeners.erase(std::remove_if(m_listeners.begin(), m_listeners.end(), [](auto const &listener) {
+                    return listener.types == 0;
+                }), m_listeners.end());
+                m_removed = false;
+            }
+            return count;
+        }
+
+        /**
+         * Forget the snapshot; the players in the list on the next update are reported as joins
+         */
+        void reset() noexcept {
+            std::memset(m_players.data(), 0xFF, sizeof(m_players));
+        }
+
+        /**
+         * Get a slot of the last snapshot
+         * @param slot  index of the slot
+         * @return      player; nullptr if the slot is empty or out of range
+         */
+        ServerInfoPlayer const *player(std::size_t slot) const noexcept {
+            if(slot >= MAX_PLAYERS || !is_present(m_players[slot])) {
+                return nullptr;
+            }
+            return &m_players[slot];
+        }
+
+        /**
+         * Get the number of players in the last snapshot
+         */
+        std::size_t player_count() const noexcept {
+            std::size_t count = 0;
+            for(auto const &player : m_players) {
+                count += is_present(player);
+            }
+            return count;
+        }
+
+        static bool is_present(ServerInfoPlayer const &player) noexcept {
+            return player.player_id != 0xFF;
+        }
+
+        #ifdef _WIN32
+        /**
+         * Get the tracker of the current module. It is updated before every tick, with 
+         * the machines of the players.
+         */
+        static PlayerListTracker &get() {
+            static PlayerListTracker tracker(true);
+            return tracker;
+        }
+        #endif
+
+    private:
+        struct ListenerEntry {
+            std::size_t handle;
+            std::uint8_t types;
+            Listener callback;
+        };
+
+        std::array<ServerInfoPlayer, MAX_PLAYERS> m_players;
+        std::vector<ListenerEntry> m_listeners;
+        std::vector<PlayerListChange> m_changes;
+        std::size_t m_next_handle = 0;
+        bool m_removed = false;
+
+        #ifdef _WIN32
+        Event::EventListenerHandle<Event::TickEvent> m_tick_listener;
+
+        PlayerListTracker(bool) {
+            reset();
+            m_tick_listener = Event::TickEvent::subscribe_const([](Event::TickEvent const &event) {
+                if(event.time == Event::EVENT_TIME_BEFORE) {
+                    PlayerListTracker::get().update(Engine::ServerInfoPlayerList::get_server_info_player_list(), Engine::ServerInfo::get_server_info());
+                }
+            });
+        }
+        #endif
+    };
+}
+
+#endif
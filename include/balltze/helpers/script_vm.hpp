@@ -0,0 +1,1370 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_API__HELPERS__SCRIPT_VM_HPP
+#define BALLTZE_API__HELPERS__SCRIPT_VM_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <fmt/format.h>
+
+/**
+ * Compiler and interpreter for the script node graphs of scenario tags.
+ *
+ * The compiler flattens the node graph of every script and global initializer into
+ * register based bytecode. Special forms (begin, if, set, and, or, arithmetic,
+ * comparisons, sleep, sleep_until and wake) are compiled inline; every other function
+ * becomes a call to a native function that the host may bind by name. Unbound native
+ * functions return zero, which is enough to simulate most mission scripts.
+ *
+ * The interpreter runs startup, dormant and continuous scripts as threads, one tick
+ * at a time, and keeps per-script counters to find scripts that burn tick budget.
+ *
+ * This header does not depend on the engine, so scripts can be compiled and run by
+ * tools; script_vm_tag.hpp gets the script data of a scenario tag.
+ */
+namespace Balltze::ScriptVM {
+    /**
+     * Value type of a script node; the same values as the scenario tag. Types after
+     * VALUE_TYPE_SCRIPT (objects, tags, AI...) are handled as integers.
+     */
+    enum ValueType : std::uint16_t {
+        VALUE_TYPE_UNPARSED = 0,
+        VALUE_TYPE_SPECIAL_FORM,
+        VALUE_TYPE_FUNCTION_NAME,
+        VALUE_TYPE_PASSTHROUGH,
+        VALUE_TYPE_VOID,
+        VALUE_TYPE_BOOLEAN,
+        VALUE_TYPE_REAL,
+        VALUE_TYPE_SHORT,
+        VALUE_TYPE_LONG,
+        VALUE_TYPE_STRING,
+        VALUE_TYPE_SCRIPT
+    };
+
+    /**
+     * Type of a script; the same values as the scenario tag
+     */
+    enum ScriptType : std::uint16_t {
+        SCRIPT_TYPE_STARTUP = 0,
+        SCRIPT_TYPE_DORMANT,
+        SCRIPT_TYPE_CONTINUOUS,
+        SCRIPT_TYPE_STATIC,
+        SCRIPT_TYPE_STUB
+    };
+
+    /**
+     * Value of a register. Booleans, shorts, longs, strings (offsets into the string
+     * data) and object or tag references are stored as integers; reals as floats.
+     */
+    union Value {
+        std::int32_t integer;
+        float real;
+
+        static Value from_integer(std::int32_t value) noexcept {
+            Value result;
+            result.integer = value;
+            return result;
+        }
+
+        static Value from_real(float value) noexcept {
+            Value result;
+            result.real = value;
+            return result;
+        }
+    };
+    static_assert(sizeof(Value) == 4);
+
+    constexpr std::uint32_t NULL_NODE = 0xFFFFFFFF;
+    constexpr std::uint16_t NO_SCRIPT = 0xFFFF;
+
+    struct NodeFlags {
+        std::uint16_t is_primitive : 1;
+        std::uint16_t is_script_call : 1;
+        std::uint16_t is_global : 1;
+        std::uint16_t is_garbage_collectable : 1;
+        std::uint16_t is_local_variable : 1;
+    };
+    static_assert(sizeof(NodeFlags) == sizeof(std::uint16_t));
+
+    /**
+     * Script node; the same layout as the nodes of the script syntax data of a scenario tag
+     */
+    struct Node {
+        std::uint16_t salt;
+        std::uint16_t index_union;
+        ValueType type;
+        NodeFlags flags;
+        std::uint32_t next_node;
+        std::uint32_t string_offset;
+        union {
+            std::int8_t bool_int;
+            std::int16_t short_int;
+            std::int32_t long_int;
+            float real;
+        } data;
+    };
+    static_assert(sizeof(Node) == 20);
+
+    /**
+     * Script data of a scenario
+     */
+    struct Source {
+        struct Script {
+            std::string name;
+            ScriptType type;
+            ValueType return_type;
+            std::uint32_t root_expression;
+            std::uint16_t parameter_count;
+        };
+
+        struct Global {
+            std::string name;
+            ValueType type;
+
+            /** Node of the initializer; NULL_NODE if the global has no initializer */
+            std::uint32_t initializer_expression;
+        };
+
+        std::vector<Node> nodes;
+        std::vector<char> strings;
+        std::vector<Script> scripts;
+        std::vector<Global> globals;
+
+        /**
+         * Write the script data to a stream, so it can be loaded by a tool
+         * @param stream    binary output stream
+         */
+        void write(std::ostream &stream) const {
+            put(stream, DUMP_MAGIC, sizeof(DUMP_MAGIC));
+            put_value<std::uint32_t>(stream, DUMP_VERSION);
+            put_value<std::uint32_t>(stream, static_cast<std::uint32_t>(nodes.size()));
+            put_value<std::uint32_t>(stream, static_cast<std::uint32_t>(strings.size()));
+            put_value<std::uint32_t>(stream, static_cast<std::uint32_t>(scripts.size()));
+            put_value<std::uint32_t>(stream, static_cast<std::uint32_t>(globals.size()));
+            put(stream, nodes.data(), nodes.size() * sizeof(Node));
+            put(stream, strings.data(), strings.size());
+            for(auto const &script : scripts) {
+                put_string(stream, script.name);
+                put_value<std::uint16_t>(stream, script.type);
+                put_value<std::uint16_t>(stream, script.return_type);
+                put_value<std::uint32_t>(stream, script.root_expression);
+                put_value<std::uint16_t>(stream, script.parameter_count);
+            }
+            for(auto const &global : globals) {
+                put_string(stream, global.name);
+                put_value<std::uint16_t>(stream, global.type);
+                put_value<std::uint32_t>(stream, global.initializer_expression);
+            }
+        }
+
+        /**
+         * Read script data written by write()
+         * @param stream    binary input stream
+         * @return          script data
+         * @throws std::runtime_error if the data is truncated or was not written by write()
+         */
+        static Source read(std::istream &stream) {
+            char magic[sizeof(DUMP_MAGIC)];
+            get(stream, magic, sizeof(magic));
+            if(std::memcmp(magic, DUMP_MAGIC, sizeof(magic)) != 0 || get_value<std::uint32_t>(stream) != DUMP_VERSION) {
+                throw std::runtime_error("Not a script data dump");
+            }
+            std::uint64_t node_count = get_value<std::uint32_t>(stream);
+            std::uint64_t string_size = get_value<std::uint32_t>(stream);
+            std::uint64_t script_count = get_value<std::uint32_t>(stream);
+            std::uint64_t global_count = get_value<std::uint32_t>(stream);
+
+            // Nodes, scripts and globals are referenced by 16-bit indices
+            if(node_count > 0x10000 || script_count > 0x10000 || global_count > 0x10000) {
+                throw std::runtime_error("Script data dump has too many nodes, scripts or globals");
+            }
+
+            // Check the counts against what is left before allocating anything
+            auto needed = node_count * sizeof(Node) + string_size + script_count * SCRIPT_RECORD_SIZE + global_count * GLOBAL_RECORD_SIZE;
+            if(needed > remaining(stream)) {
+                throw std::runtime_error("Script data dump is truncated");
+            }
+
+            Source source;
+            source.nodes.resize(node_count);
+            source.strings.resize(string_size);
+            source.scripts.resize(script_count);
+            source.globals.resize(global_count);
+            get(stream, source.nodes.data(), source.nodes.size() * sizeof(Node));
+            get(stream, source.strings.data(), source.strings.size());
+            for(auto &script : source.scripts) {
+                script.name = get_string(stream);
+                script.type = static_cast<ScriptType>(get_value<std::uint16_t>(stream));
+                script.return_type = static_cast<ValueType>(get_value<std::uint16_t>(stream));
+                script.root_expression = get_value<std::uint32_t>(stream);
+                script.parameter_count = get_value<std::uint16_t>(stream);
+            }
+            for(auto &global : source.globals) {
+                global.name = get_string(stream);
+                global.type = static_cast<ValueType>(get_value<std::uint16_t>(stream));
+                global.initializer_expression = get_value<std::uint32_t>(stream);
+            }
+            return source;
+        }
+
+    private:
+        // Values are stored in host byte order, which is little endian like the game
+        static constexpr char DUMP_MAGIC[8] = { 'B', 'L', 'T', 'Z', 'H', 'S', 'C', 0 };
+        static constexpr std::uint32_t DUMP_VERSION = 1;
+
+        // Smallest size of a script and a global in a dump, with empty names
+        static constexpr std::uint64_t SCRIPT_RECORD_SIZE = 2 + 2 + 2 + 4 + 2;
+        static constexpr std::uint64_t GLOBAL_RECORD_SIZE = 2 + 2 + 4;
+
+        static void put(std::ostream &stream, void const *data, std::size_t size) {
+            stream.write(static_cast<char const *>(data), static_cast<std::streamsize>(size));
+        }
+
+        template<typename T>
+        static void put_value(std::ostream &stream, T value) {
+            put(stream, &value, sizeof(value));
+        }
+
+        static void put_string(std::ostream &stream, std::string const &string) {
+            put_value<std::uint16_t>(stream, static_cast<std::uint16_t>(std::min<std::size_t>(string.size(), 0xFFFF)));
+            put(stream, string.data(), std::min<std::size_t>(string.size(), 0xFFFF));
+        }
+
+        static void get(std::istream &stream, void *data, std::size_t size) {
+            if(!stream.read(static_cast<char *>(data), static_cast<std::streamsize>(size))) {
+                throw std::runtime_error("Script data dump is truncated");
+            }
+        }
+
+        template<typename T>
+        static T get_value(std::istream &stream) {
+            T value;
+            get(stream, &value, sizeof(value));
+            return value;
+        }
+
+        /**
+         * Get the number of bytes left in a stream; unbounded if it cannot seek
+         */
+        static std::uint64_t remaining(std::istream &stream) {
+            auto position = stream.tellg();
+            if(position == std::istream::pos_type(-1) || !stream.seekg(0, std::ios::end)) {
+                stream.clear();
+                return std::numeric_limits<std::uint64_t>::max();
+            }
+            auto end = stream.tellg();
+            stream.seekg(position);
+            if(end == std::istream::pos_type(-1) || end < position) {
+                return 0;
+            }
+            return static_cast<std::uint64_t>(end - position);
+        }
+
+        static std::string get_string(std::istream &stream) {
+            std::string string(get_value<std::uint16_t>(stream), '\0');
+            get(stream, string.data(), string.size());
+            return string;
+        }
+    };
+
+    enum Opcode : std::uint8_t {
+        /** a = immediate b | c << 16 */
+        OP_LOAD,
+        /** a = b */
+        OP_MOVE,
+        /** a = global b */
+        OP_LOAD_GLOBAL,
+        /** global a = b */
+        OP_STORE_GLOBAL,
+        /** a = engine global b */
+        OP_LOAD_EXTERNAL,
+        /** engine global a = b */
+        OP_STORE_EXTERNAL,
+        /** a = real(b) */
+        OP_INT_TO_REAL,
+        /** a = integer(b) */
+        OP_REAL_TO_INT,
+        /** a = b <op> c, reals */
+        OP_ADD,
+        OP_SUBTRACT,
+        OP_MULTIPLY,
+        OP_DIVIDE,
+        OP_MIN,
+        OP_MAX,
+        /** a = b <op> c, integers */
+        OP_EQUAL_INT,
+        OP_NOT_EQUAL_INT,
+        OP_LESS_INT,
+        OP_GREATER_INT,
+        OP_LESS_EQUAL_INT,
+        OP_GREATER_EQUAL_INT,
+        /** a = b <op> c, reals */
+        OP_EQUAL_REAL,
+        OP_NOT_EQUAL_REAL,
+        OP_LESS_REAL,
+        OP_GREATER_REAL,
+        OP_LESS_EQUAL_REAL,
+        OP_GREATER_EQUAL_REAL,
+        /** a = !b */
+        OP_NOT,
+        /** pc = b | c << 16 */
+        OP_JUMP,
+        /** if(!a) pc = b | c << 16 */
+        OP_JUMP_IF_FALSE,
+        /** if(a) pc = b | c << 16 */
+        OP_JUMP_IF_TRUE,
+        /** a = script b, arguments from c */
+        OP_CALL_SCRIPT,
+        /** a = native call site b | c << 16 */
+        OP_CALL_NATIVE,
+        /** sleep script b (NO_SCRIPT for the current thread) for a ticks */
+        OP_SLEEP,
+        /** wake script b */
+        OP_WAKE,
+        /** return a */
+        OP_RETURN
+    };
+
+    struct Instruction {
+        Opcode op;
+        std::uint8_t pad = 0;
+        std::uint16_t a = 0;
+        std::uint16_t b = 0;
+        std::uint16_t c = 0;
+
+        std::uint32_t wide() const noexcept {
+            return b | static_cast<std::uint32_t>(c) << 16;
+        }
+    };
+    static_assert(sizeof(Instruction) == 8);
+
+    /**
+     * Compiled script, or global initializer
+     */
+    struct Function {
+        std::string name;
+        ScriptType type;
+        ValueType return_type;
+        std::uint32_t entry;
+        std::uint16_t register_count;
+        std::uint16_t parameter_count;
+    };
+
+    struct Global {
+        std::string name;
+        ValueType type;
+
+        /** Index of the initializer function; -1 if the global has no initializer */
+        std::int32_t initializer;
+    };
+
+    struct Native {
+        std::string name;
+    };
+
+    struct CallSite {
+        std::uint32_t native;
+        std::uint16_t first_argument;
+        std::uint16_t argument_count;
+    };
+
+    /**
+     * Bytecode of a scenario
+     */
+    struct Program {
+        std::vector<Instruction> code;
+        std::vector<Function> functions;
+        std::vector<Global> globals;
+        std::vector<Native> natives;
+        std::vector<CallSite> call_sites;
+        std::vector<char> strings;
+
+        /** Number of scripts; the functions after them are global initializers */
+        std::size_t script_count = 0;
+
+        /**
+         * Find a script
+         * @param name  name of the script
+         * @return      index of the script; -1 if not found
+         */
+        std::int32_t find_script(std::string_view name) const noexcept {
+            for(std::size_t i = 0; i < script_count; i++) {
+                if(functions[i].name == name) {
+                    return static_cast<std::int32_t>(i);
+                }
+            }
+            return -1;
+        }
+
+        /**
+         * Find a global
+         * @param name  name of the global
+         * @return      index of the global; -1 if not found
+         */
+        std::int32_t find_global(std::string_view name) const noexcept {
+            for(std::size_t i = 0; i < globals.size(); i++) {
+                if(globals[i].name == name) {
+                    return static_cast<std::int32_t>(i);
+                }
+            }
+            return -1;
+        }
+
+        /**
+         * Get a string value
+         * @param value string value
+         * @return      string; empty if the offset is out of bounds
+         */
+        char const *string(Value value) const noexcept {
+            auto offset = static_cast<std::size_t>(value.integer);
+            return offset < strings.size() ? strings.data() + offset : "";
+        }
+    };
+
+    /**
+     * Compiler from script node graphs to bytecode
+     */
+    class Compiler {
+    public:
+        /**
+         * Compile the scripts and global initializers of a scenario
+         * @param source    script data of the scenario
+         * @return          program
+         * @throws std::runtime_error if the node graph is malformed
+         */
+        static Program compile(Source const &source) {
+            Compiler compiler(source);
+            return compiler.compile();
+        }
+
+    private:
+        static constexpr std::size_t MAX_DEPTH = 1024;
+
+        Source const &m_source;
+        Program m_program;
+        std::unordered_map<std::string_view, std::uint32_t> m_natives;
+        std::uint32_t m_next_register = 0;
+        std::uint32_t m_register_count = 0;
+        std::uint32_t m_parameter_count = 0;
+        std::size_t m_depth = 0;
+
+        Compiler(Source const &source) : m_source(source) {}
+
+        Program compile() {
+
+            m_program.strings = m_source.strings;
+            m_program.strings.push_back('\0');
+            m_program.script_count = m_source.scripts.size();
+
+            for(auto const &script : m_source.scripts) {
+                auto &function = m_program.functions.emplace_back();
+                function.name = script.name;
+                function.type = script.type;
+                function.return_type = script.return_type;
+                function.parameter_count = script.parameter_count;
+            }
+            for(auto const &global : m_source.globals) {
+                m_program.globals.push_back({ global.name, global.type, -1 });
+            }
+
+            for(std::size_t i = 0; i < m_source.scripts.size(); i++) {
+                compile_function(i, m_source.scripts[i].root_expression);
+            }
+            for(std::size_t i = 0; i < m_source.globals.size(); i++) {
+                auto expression = m_source.globals[i].initializer_expression;
+                if(expression == NULL_NODE) {
+                    continue;
+                }
+                auto index = m_program.functions.size();
+                auto &function = m_program.functions.emplace_back();
+                function.name = m_program.globals[i].name;
+                function.type = SCRIPT_TYPE_STATIC;
+                function.return_type = m_program.globals[i].type;
+                function.parameter_count = 0;
+                m_program.globals[i].initializer = static_cast<std::int32_t>(index);
+                compile_function(index, expression);
+            }
+            return std::move(m_program);
+        }
+
+        void compile_function(std::size_t index, std::uint32_t root) {
+            auto &function = m_program.functions[index];
+            function.entry = static_cast<std::uint32_t>(m_program.code.size());
+            m_parameter_count = function.parameter_count;
+            m_next_register = function.parameter_count;
+            m_register_count = m_next_register;
+            auto result = allocate();
+            expression(root, result);
+            emit(OP_RETURN, result);
+            m_program.functions[index].register_count = static_cast<std::uint16_t>(m_register_count);
+        }
+
+        Node const &node(std::uint32_t id) const {
+            auto index = id & 0xFFFF;
+            if(id == NULL_NODE || index >= m_source.nodes.size()) {
+                throw std::runtime_error(fmt::format("Invalid script node {:#010x}", id));
+            }
+            return m_source.nodes[index];
+        }
+
+        std::string_view string(std::uint32_t offset) const noexcept {
+            if(offset >= m_source.strings.size()) {
+                return {};
+            }
+            auto const *string = m_source.strings.data() + offset;
+            return std::string_view(string, strnlen(string, m_source.strings.size() - offset));
+        }
+
+        std::uint16_t allocate() {
+            if(m_next_register >= std::numeric_limits<std::uint16_t>::max()) {
+                throw std::runtime_error("Script needs too many registers");
+            }
+            auto index = m_next_register++;
+            m_register_count = std::max(m_register_count, m_next_register);
+            return static_cast<std::uint16_t>(index);
+        }
+
+        std::size_t emit(Opcode op, std::uint16_t a = 0, std::uint16_t b = 0, std::uint16_t c = 0) {
+            m_program.code.push_back({ op, 0, a, b, c });
+            return m_program.code.size() - 1;
+        }
+
+        void emit_load(std::uint16_t dst, std::uint32_t immediate) {
+            emit(OP_LOAD, dst, static_cast<std::uint16_t>(immediate), static_cast<std::uint16_t>(immediate >> 16));
+        }
+
+        std::size_t emit_jump(Opcode op, std::uint16_t condition = 0) {
+            return emit(op, condition);
+        }
+
+        void patch_jump(std::size_t jump) {
+            auto target = static_cast<std::uint32_t>(m_program.code.size());
+            m_program.code[jump].b = static_cast<std::uint16_t>(target);
+            m_program.code[jump].c = static_cast<std::uint16_t>(target >> 16);
+        }
+
+        static bool is_integer(ValueType type) noexcept {
+            return type == VALUE_TYPE_SHORT || type == VALUE_TYPE_LONG;
+        }
+
+        void convert(std::uint16_t reg, ValueType from, ValueType to) {
+            if(from == VALUE_TYPE_REAL && is_integer(to)) {
+                emit(OP_REAL_TO_INT, reg, reg);
+            }
+            else if(is_integer(from) && to == VALUE_TYPE_REAL) {
+                emit(OP_INT_TO_REAL, reg, reg);
+            }
+        }
+
+        std::vector<std::uint32_t> arguments(Node const &call) const {
+            std::vector<std::uint32_t> result;
+            // The first child is the function name
+            auto id = node(static_cast<std::uint32_t>(call.data.long_int)).next_node;
+            while(id != NULL_NODE) {
+                if(result.size() > m_source.nodes.size()) {
+                    throw std::runtime_error("Script argument list loops");
+                }
+                result.push_back(id);
+                id = node(id).next_node;
+            }
+            return result;
+        }
+
+        /**
+         * Compile an expression
+         * @param id    node of the expression
+         * @param dst   register where to store the result
+         */
+        void expression(std::uint32_t id, std::uint16_t dst) {
+            if(++m_depth > MAX_DEPTH) {
+                throw std::runtime_error("Script node graph is too deep");
+            }
+            auto const &n = node(id);
+            auto saved_register = m_next_register;
+            ValueType result_type = n.type;
+
+            if(n.flags.is_primitive) {
+                result_type = primitive(n, dst);
+            }
+            else if(n.flags.is_script_call) {
+                result_type = script_call(n, dst);
+            }
+            else {
+                auto name = string(node(static_cast<std::uint32_t>(n.data.long_int)).string_offset);
+                result_type = call(n, name, dst);
+            }
+            convert(dst, result_type, n.type);
+
+            m_next_register = saved_register;
+            m_depth--;
+        }
+
+        ValueType primitive(Node const &n, std::uint16_t dst) {
+            if(n.flags.is_global) {
+                auto index = static_cast<std::uint16_t>(n.data.short_int);
+                // Engine globals have the high bit set
+                if(index & 0x8000) {
+                    emit(OP_LOAD_EXTERNAL, dst, index & 0x7FFF);
+                    return n.type;
+                }
+                if(index >= m_program.globals.size()) {
+                    throw std::runtime_error(fmt::format("Invalid script global {}", index));
+                }
+                emit(OP_LOAD_GLOBAL, dst, index);
+                return m_program.globals[index].type;
+            }
+            if(n.flags.is_local_variable) {
+                // Locals are the parameters of the script, which take the first registers
+                auto index = static_cast<std::uint16_t>(n.data.short_int);
+                if(index >= m_parameter_count) {
+                    throw std::runtime_error(fmt::format("Invalid script parameter {}", index));
+                }
+                emit(OP_MOVE, dst, index);
+                return n.type;
+            }
+            switch(n.type) {
+                case VALUE_TYPE_BOOLEAN:
+                    emit_load(dst, n.data.bool_int != 0);
+                    break;
+                case VALUE_TYPE_SHORT:
+                case VALUE_TYPE_SCRIPT:
+                    emit_load(dst, static_cast<std::uint32_t>(static_cast<std::int32_t>(n.data.short_int)));
+                    break;
+                case VALUE_TYPE_STRING:
+                    emit_load(dst, n.string_offset);
+                    break;
+                default:
+                    emit_load(dst, static_cast<std::uint32_t>(n.data.long_int));
+                    break;
+            }
+            return n.type;
+        }
+
+        ValueType script_call(Node const &n, std::uint16_t dst) {
+            auto script = n.index_union;
+            if(script >= m_program.script_count) {
+                throw std::runtime_error(fmt::format("Invalid script index {}", script));
+            }
+            auto args = arguments(n);
+            auto first = m_next_register;
+            for(auto arg : args) {
+                expression(arg, allocate());
+            }
+            emit(OP_CALL_SCRIPT, dst, script, static_cast<std::uint16_t>(first));
+            return m_program.functions[script].return_type;
+        }
+
+        ValueType call(Node const &n, std::string_view name, std::uint16_t dst) {
+            auto args = arguments(n);
+
+            if(name == "begin" || name == "begin_random") {
+                if(args.empty()) {
+                    emit_load(dst, 0);
+                }
+                for(auto arg : args) {
+                    expression(arg, dst);
+                }
+                return n.type;
+            }
+            if(name == "if") {
+                if(args.size() < 2) {
+                    throw std::runtime_error("if needs a condition and an expression");
+                }
+                auto condition = allocate();
+                expression(args[0], condition);
+                auto to_else = emit_jump(OP_JUMP_IF_FALSE, condition);
+                expression(args[1], dst);
+                auto to_end = emit_jump(OP_JUMP);
+                patch_jump(to_else);
+                if(args.size() > 2) {
+                    expression(args[2], dst);
+                }
+                else {
+                    emit_load(dst, 0);
+                }
+                patch_jump(to_end);
+                return n.type;
+            }
+            if(name == "set") {
+                if(args.size() != 2) {
+                    throw std::runtime_error("set needs a global and a value");
+                }
+                auto const &global = node(args[0]);
+                if(!global.flags.is_global) {
+                    throw std::runtime_error("set needs a global");
+                }
+                auto index = static_cast<std::uint16_t>(global.data.short_int);
+                expression(args[1], dst);
+                if(index & 0x8000) {
+                    emit(OP_STORE_EXTERNAL, index & 0x7FFF, dst);
+                    return node(args[1]).type;
+                }
+                if(index >= m_program.globals.size()) {
+                    throw std::runtime_error(fmt::format("Invalid script global {}", index));
+                }
+                auto value_type = node(args[1]).type;
+                auto global_type = m_program.globals[index].type;
+                convert(dst, value_type, global_type);
+                emit(OP_STORE_GLOBAL, index, dst);
+                return global_type;
+            }
+            if(name == "and" || name == "or") {
+                std::vector<std::size_t> jumps;
+                emit_load(dst, name == "and");
+                for(auto arg : args) {
+                    expression(arg, dst);
+                    jumps.push_back(emit_jump(name == "and" ? OP_JUMP_IF_FALSE : OP_JUMP_IF_TRUE, dst));
+                }
+                for(auto jump : jumps) {
+                    patch_jump(jump);
+                }
+                return VALUE_TYPE_BOOLEAN;
+            }
+            if(name == "not") {
+                if(args.size() != 1) {
+                    throw std::runtime_error("not needs one argument");
+                }
+                expression(args[0], dst);
+                emit(OP_NOT, dst, dst);
+                return VALUE_TYPE_BOOLEAN;
+            }
+
+            static const std::pair<std::string_view, Opcode> arithmetic[] = {
+                { "+", OP_ADD }, { "-", OP_SUBTRACT }, { "*", OP_MULTIPLY }, { "/", OP_DIVIDE }, { "min", OP_MIN }, { "max", OP_MAX }
+            };
+            for(auto const &[operator_name, op] : arithmetic) {
+                if(name != operator_name) {
+                    continue;
+                }
+                if(args.empty()) {
+                    throw std::runtime_error(fmt::format("{} needs arguments", name));
+                }
+                expression(args[0], dst);
+                convert(dst, node(args[0]).type, VALUE_TYPE_REAL);
+                auto operand = allocate();
+                for(std::size_t i = 1; i < args.size(); i++) {
+                    expression(args[i], operand);
+                    convert(operand, node(args[i]).type, VALUE_TYPE_REAL);
+                    emit(op, dst, dst, operand);
+                }
+                return VALUE_TYPE_REAL;
+            }
+
+            static const std::pair<std::string_view, Opcode> comparisons[] = {
+                { "=", OP_EQUAL_INT }, { "!=", OP_NOT_EQUAL_INT }, { "<", OP_LESS_INT }, { ">", OP_GREATER_INT }, { "<=", OP_LESS_EQUAL_INT }, { ">=", OP_GREATER_EQUAL_INT }
+            };
+            for(auto const &[operator_name, op] : comparisons) {
+                if(name != operator_name) {
+                    continue;
+                }
+                if(args.size() != 2) {
+                    throw std::runtime_error(fmt::format("{} needs two arguments", name));
+                }
+                auto left_type = node(args[0]).type;
+                auto right_type = node(args[1]).type;
+                bool real = left_type == VALUE_TYPE_REAL || right_type == VALUE_TYPE_REAL;
+                auto operand = allocate();
+                expression(args[0], dst);
+                expression(args[1], operand);
+                if(real) {
+                    convert(dst, left_type, VALUE_TYPE_REAL);
+                    convert(operand, right_type, VALUE_TYPE_REAL);
+                }
+                emit(static_cast<Opcode>(op + (real ? OP_EQUAL_REAL - OP_EQUAL_INT : 0)), dst, dst, operand);
+                return VALUE_TYPE_BOOLEAN;
+            }
+
+            if(name == "sleep") {
+                if(args.empty() || args.size() > 2) {
+                    throw std::runtime_error("sleep needs a time and optionally a script");
+                }
+                expression(args[0], dst);
+                auto script = NO_SCRIPT;
+                if(args.size() == 2) {
+                    script = script_argument(args[1]);
+                }
+                emit(OP_SLEEP, dst, script);
+                return VALUE_TYPE_VOID;
+            }
+            if(name == "sleep_until") {
+                if(args.empty()) {
+                    throw std::runtime_error("sleep_until needs a condition");
+                }
+                // The timeout is not simulated
+                auto period = allocate();
+                if(args.size() > 1) {
+                    expression(args[1], period);
+                }
+                else {
+                    emit_load(period, 30);
+                }
+                auto loop = static_cast<std::uint32_t>(m_program.code.size());
+                expression(args[0], dst);
+                auto to_end = emit_jump(OP_JUMP_IF_TRUE, dst);
+                emit(OP_SLEEP, period, NO_SCRIPT);
+                emit(OP_JUMP, 0, static_cast<std::uint16_t>(loop), static_cast<std::uint16_t>(loop >> 16));
+                patch_jump(to_end);
+                return VALUE_TYPE_VOID;
+            }
+            if(name == "wake") {
+                if(args.size() != 1) {
+                    throw std::runtime_error("wake needs a script");
+                }
+                emit(OP_WAKE, 0, script_argument(args[0]));
+                return VALUE_TYPE_VOID;
+            }
+
+            // Anything else is up to the host
+            auto [it, inserted] = m_natives.try_emplace(name, static_cast<std::uint32_t>(m_program.natives.size()));
+            if(inserted) {
+                m_program.natives.push_back({ std::string(name) });
+            }
+            auto first = m_next_register;
+            for(auto arg : args) {
+                expression(arg, allocate());
+            }
+            auto site = static_cast<std::uint32_t>(m_program.call_sites.size());
+            m_program.call_sites.push_back({ it->second, static_cast<std::uint16_t>(first), static_cast<std::uint16_t>(args.size()) });
+            emit(OP_CALL_NATIVE, dst, static_cast<std::uint16_t>(site), static_cast<std::uint16_t>(site >> 16));
+            return n.type;
+        }
+
+        std::uint16_t script_argument(std::uint32_t id) const {
+            auto const &n = node(id);
+            auto script = static_cast<std::uint16_t>(n.data.short_int);
+            if(!n.flags.is_primitive || script >= m_program.script_count) {
+                throw std::runtime_error("Expected a script name");
+            }
+            return script;
+        }
+    };
+
+    /**
+     * Interpreter for compiled scripts
+     */
+    class Machine {
+    public:
+        /**
+         * Function called for functions that are not compiled inline
+         * @param machine   machine running the script
+         * @param arguments arguments of the call
+         * @param count     number of arguments
+         * @return          return value
+         */
+        using NativeFunction = std::function<Value(Machine &machine, Value const *arguments, std::size_t count)>;
+
+        /**
+         * Counters of a script
+         */
+        struct ScriptProfile {
+            /** Times the script was started as a thread or called */
+            std::uint64_t runs = 0;
+
+            /** Instructions run by the thread of the script, including the scripts it called */
+            std::uint64_t instructions = 0;
+
+            /** Time spent in the thread of the script, including the scripts it called */
+            std::chrono::nanoseconds time { 0 };
+
+            /** Longest time spent in the thread in a single tick */
+            std::chrono::nanoseconds worst_tick { 0 };
+        };
+
+        static constexpr std::uint64_t NEVER = std::numeric_limits<std::uint64_t>::max();
+
+        /**
+         * @param program   program to run; it must outlive the machine
+         */
+        Machine(Program const &program) : m_program(program) {
+            m_natives.resize(program.natives.size());
+            m_native_calls.resize(program.natives.size());
+            reset();
+        }
+
+        /**
+         * Bind a native function
+         * @param name      name of the function
+         * @param function  function to call
+         * @return          whether the program calls the function
+         */
+        bool bind(std::string_view name, NativeFunction function) {
+            for(std::size_t i = 0; i < m_program.natives.size(); i++) {
+                if(m_program.natives[i].name == name) {
+                    m_natives[i] = std::move(function);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * Restart the program: initialize the globals and the threads and clear the counters
+         */
+        void reset() {
+            m_tick = 0;
+            m_globals.assign(m_program.globals.size(), Value::from_integer(0));
+            m_profiles.assign(m_program.functions.size(), {});
+            std::fill(m_native_calls.begin(), m_native_calls.end(), 0);
+
+            m_threads.clear();
+            m_thread_of_script.assign(m_program.script_count, NO_THREAD);
+            for(std::size_t i = 0; i < m_program.script_count; i++) {
+                auto type = m_program.functions[i].type;
+                if(type != SCRIPT_TYPE_STARTUP && type != SCRIPT_TYPE_DORMANT && type != SCRIPT_TYPE_CONTINUOUS) {
+                    continue;
+                }
+                m_thread_of_script[i] = m_threads.size();
+                auto &thread = m_threads.emplace_back();
+                thread.script = static_cast<std::uint16_t>(i);
+                thread.wake_tick = type == SCRIPT_TYPE_DORMANT ? NEVER : 0;
+            }
+
+            for(std::size_t i = 0; i < m_program.globals.size(); i++) {
+                auto initializer = m_program.globals[i].initializer;
+                if(initializer >= 0) {
+                    Thread thread;
+                    thread.script = static_cast<std::uint16_t>(initializer);
+                    start(thread);
+                    if(run(thread, std::numeric_limits<std::uint64_t>::max()) == RUN_FINISHED) {
+                        m_globals[i] = thread.result;
+                    }
+                }
+            }
+        }
+
+        /**
+         * Run every thread that is awake until it sleeps or finishes
+         * @return  number of instructions run
+         * @throws std::runtime_error if a thread runs more instructions than the limit
+         */
+        std::uint64_t tick() {
+            std::uint64_t total = 0;
+            for(std::size_t i = 0; i < m_threads.size(); i++) {
+                auto &thread = m_threads[i];
+                if(thread.wake_tick > m_tick) {
+                    continue;
+                }
+                if(!thread.running) {
+                    start(thread);
+                }
+                auto &profile = m_profiles[thread.script];
+                auto start_time = std::chrono::steady_clock::now();
+                auto instructions_before = thread.instructions;
+                auto status = run(thread, m_instruction_limit);
+                auto time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_time);
+                auto instructions = thread.instructions - instructions_before;
+
+                profile.instructions += instructions;
+                profile.time += time;
+                profile.worst_tick = std::max(profile.worst_tick, time);
+                total += instructions;
+
+                if(status == RUN_LIMIT) {
+                    throw std::runtime_error(fmt::format("Script {} ran more than {} instructions in a tick", m_program.functions[thread.script].name, m_instruction_limit));
+                }
+                if(status == RUN_FINISHED) {
+                    // Continuous scripts run again on the next tick; the others are done
+                    auto type = m_program.functions[thread.script].type;
+                    if(type == SCRIPT_TYPE_CONTINUOUS) {
+                        thread.wake_tick = m_tick + 1;
+                    }
+                    else {
+                        thread.wake_tick = NEVER;
+                        thread.done = true;
+                    }
+                }
+            }
+            m_tick++;
+            return total;
+        }
+
+        /**
+         * Run a number of ticks
+         * @param ticks number of ticks
+         * @return      number of instructions run
+         */
+        std::uint64_t run_ticks(std::size_t ticks) {
+            std::uint64_t total = 0;
+            for(std::size_t i = 0; i < ticks; i++) {
+                total += tick();
+            }
+            return total;
+        }
+
+        /**
+         * Wake a dormant or sleeping script
+         * @param script    index of the script
+         */
+        void wake(std::size_t script) noexcept {
+            if(script < m_thread_of_script.size() && m_thread_of_script[script] != NO_THREAD) {
+                auto &thread = m_threads[m_thread_of_script[script]];
+                if(!thread.done) {
+                    thread.wake_tick = m_tick;
+                }
+            }
+        }
+
+        /**
+         * Check if the thread of a script is sleeping or done
+         * @param script    index of the script
+         * @return          whether the script will not run on the next tick
+         */
+        bool is_sleeping(std::size_t script) const noexcept {
+            if(script >= m_thread_of_script.size() || m_thread_of_script[script] == NO_THREAD) {
+                return false;
+            }
+            return m_threads[m_thread_of_script[script]].wake_tick > m_tick;
+        }
+
+        Value &global(std::size_t index) {
+            return m_globals.at(index);
+        }
+
+        /**
+         * Get an engine global; engine globals are created on first use
+         * @param index index of the global
+         */
+        Value &external(std::size_t index) {
+            if(index >= m_externals.size()) {
+                m_externals.resize(index + 1, Value::from_integer(0));
+            }
+            return m_externals[index];
+        }
+
+        /**
+         * Set the maximum number of instructions a thread may run in a tick
+         */
+        void set_instruction_limit(std::uint64_t limit) noexcept {
+            m_instruction_limit = limit;
+        }
+
+        std::uint64_t current_tick() const noexcept {
+            return m_tick;
+        }
+
+        Program const &program() const noexcept {
+            return m_program;
+        }
+
+        ScriptProfile const &profile(std::size_t script) const {
+            return m_profiles.at(script);
+        }
+
+        /**
+         * Get how many times a native function was called
+         * @param native    index of the native function
+         */
+        std::uint64_t native_calls(std::size_t native) const {
+            return m_native_calls.at(native);
+        }
+
+    private:
+        static constexpr std::size_t NO_THREAD = std::numeric_limits<std::size_t>::max();
+        static constexpr std::size_t MAX_CALL_DEPTH = 256;
+
+        struct Frame {
+            std::uint16_t function;
+            std::uint16_t dst;
+            std::uint32_t return_pc;
+            std::uint32_t base;
+        };
+
+        struct Thread {
+            std::uint16_t script;
+            bool running = false;
+            bool done = false;
+            std::uint64_t wake_tick = 0;
+            std::uint32_t pc = 0;
+            std::uint32_t base = 0;
+            std::uint16_t function = 0;
+            std::uint64_t instructions = 0;
+            Value result = Value::from_integer(0);
+            std::vector<Frame> frames;
+            std::vector<Value> registers;
+        };
+
+        enum RunStatus {
+            RUN_SLEEPING,
+            RUN_FINISHED,
+            RUN_LIMIT
+        };
+
+        Program const &m_program;
+        std::vector<NativeFunction> m_natives;
+        std::vector<std::uint64_t> m_native_calls;
+        std::vector<Value> m_globals;
+        std::vector<Value> m_externals;
+        std::vector<Thread> m_threads;
+        std::vector<std::size_t> m_thread_of_script;
+        std::vector<ScriptProfile> m_profiles;
+        std::uint64_t m_tick = 0;
+        std::uint64_t m_instruction_limit = 1000000;
+
+        void start(Thread &thread) {
+            auto const &function = m_program.functions[thread.script];
+            thread.running = true;
+            thread.function = thread.script;
+            thread.pc = function.entry;
+            thread.base = 0;
+            thread.frames.clear();
+            thread.registers.assign(function.register_count, Value::from_integer(0));
+            m_profiles[thread.script].runs++;
+        }
+
+        void sleep(std::uint16_t script, Thread &current, std::int32_t ticks) {
+            auto wake_tick = ticks < 0 ? NEVER : m_tick + std::max<std::int32_t>(ticks, 1);
+            if(script == NO_SCRIPT) {
+                current.wake_tick = wake_tick;
+            }
+            else if(m_thread_of_script[script] != NO_THREAD && !m_threads[m_thread_of_script[script]].done) {
+                m_threads[m_thread_of_script[script]].wake_tick = wake_tick;
+            }
+        }
+
+        /**
+         * Run a thread
+         * @param thread    thread to run
+         * @param limit     maximum number of instructions to run
+         */
+        RunStatus run(Thread &thread, std::uint64_t limit) {
+            auto const *code = m_program.code.data();
+            auto pc = thread.pc;
+            auto *r = thread.registers.data() + thread.base;
+            std::uint64_t count = 0;
+            std::uint64_t saved = 0;
+
+            auto save = [&]() {
+                thread.pc = pc;
+                thread.instructions += count - saved;
+                saved = count;
+            };
+
+            while(true) {
+                if(count++ >= limit) {
+                    save();
+                    return RUN_LIMIT;
+                }
+                auto const &instruction = code[pc++];
+                switch(instruction.op) {
+                    case OP_LOAD:
+                        r[instruction.a].integer = static_cast<std::int32_t>(instruction.wide());
+                        break;
+                    case OP_MOVE:
+                        r[instruction.a] = r[instruction.b];
+                        break;
+                    case OP_LOAD_GLOBAL:
+                        r[instruction.a] = m_globals[instruction.b];
+                        break;
+                    case OP_STORE_GLOBAL:
+                        m_globals[instruction.a] = r[instruction.b];
+                        break;
+                    case OP_LOAD_EXTERNAL:
+                        r[instruction.a] = external(instruction.b);
+                        break;
+                    case OP_STORE_EXTERNAL:
+                        external(instruction.a) = r[instruction.b];
+                        break;
+                    case OP_INT_TO_REAL:
+                        r[instruction.a].real = static_cast<float>(r[instruction.b].integer);
+                        break;
+                    case OP_REAL_TO_INT:
+                        r[instruction.a].integer = static_cast<std::int32_t>(r[instruction.b].real);
+                        break;
+                    case OP_ADD:
+                        r[instruction.a].real = r[instruction.b].real + r[instruction.c].real;
+                        break;
+                    case OP_SUBTRACT:
+                        r[instruction.a].real = r[instruction.b].real - r[instruction.c].real;
+                        break;
+                    case OP_MULTIPLY:
+                        r[instruction.a].real = r[instruction.b].real * r[instruction.c].real;
+                        break;
+                    case OP_DIVIDE:
+                        r[instruction.a].real = r[instruction.c].real != 0.0F ? r[instruction.b].real / r[instruction.c].real : 0.0F;
+                        break;
+                    case OP_MIN:
+                        r[instruction.a].real = std::min(r[instruction.b].real, r[instruction.c].real);
+                        break;
+                    case OP_MAX:
+                        r[instruction.a].real = std::max(r[instruction.b].real, r[instruction.c].real);
+                        break;
+                    case OP_EQUAL_INT:
+                        r[instruction.a].integer = r[instruction.b].integer == r[instruction.c].integer;
+                        break;
+                    case OP_NOT_EQUAL_INT:
+                        r[instruction.a].integer = r[instruction.b].integer != r[instruction.c].integer;
+                        break;
+                    case OP_LESS_INT:
+                        r[instruction.a].integer = r[instruction.b].integer < r[instruction.c].integer;
+                        break;
+                    case OP_GREATER_INT:
+                        r[instruction.a].integer = r[instruction.b].integer > r[instruction.c].integer;
+                        break;
+                    case OP_LESS_EQUAL_INT:
+                        r[instruction.a].integer = r[instruction.b].integer <= r[instruction.c].integer;
+                        break;
+                    case OP_GREATER_EQUAL_INT:
+                        r[instruction.a].integer = r[instruction.b].integer >= r[instruction.c].integer;
+                        break;
+                    case OP_EQUAL_REAL:
+                        r[instruction.a].integer = r[instruction.b].real == r[instruction.c].real;
+                        break;
+                    case OP_NOT_EQUAL_REAL:
+                        r[instruction.a].integer = r[instruction.b].real != r[instruction.c].real;
+                        break;
+                    case OP_LESS_REAL:
+                        r[instruction.a].integer = r[instruction.b].real < r[instruction.c].real;
+                        break;
+                    case OP_GREATER_REAL:
+                        r[instruction.a].integer = r[instruction.b].real > r[instruction.c].real;
+                        break;
+                    case OP_LESS_EQUAL_REAL:
+                        r[instruction.a].integer = r[instruction.b].real <= r[instruction.c].real;
+                        break;
+                    case OP_GREATER_EQUAL_REAL:
+                        r[instruction.a].integer = r[instruction.b].real >= r[instruction.c].real;
+                        break;
+                    case OP_NOT:
+                        r[instruction.a].integer = r[instruction.b].integer == 0;
+                        break;
+                    case OP_JUMP:
+                        pc = instruction.wide();
+                        break;
+                    case OP_JUMP_IF_FALSE:
+                        if(r[instruction.a].integer == 0) {
+                            pc = instruction.wide();
+                        }
+                        break;
+                    case OP_JUMP_IF_TRUE:
+                        if(r[instruction.a].integer != 0) {
+                            pc = instruction.wide();
+                        }
+                        break;
+                    case OP_CALL_SCRIPT: {
+                        if(thread.frames.size() >= MAX_CALL_DEPTH) {
+                            save();
+                            throw std::runtime_error(fmt::format("Script {} recursed too deeply", m_program.functions[instruction.b].name));
+                        }
+                        auto const &callee = m_program.functions[instruction.b];
+                        auto base = thread.base + m_program.functions[thread.function].register_count;
+                        thread.frames.push_back({ thread.function, instruction.a, pc, thread.base });
+                        if(thread.registers.size() < base + callee.register_count) {
+                            thread.registers.resize(base + callee.register_count);
+                        }
+                        r = thread.registers.data() + thread.base;
+                        std::copy_n(r + instruction.c, callee.parameter_count, thread.registers.data() + base);
+                        thread.base = base;
+                        thread.function = instruction.b;
+                        r = thread.registers.data() + base;
+                        pc = callee.entry;
+                        m_profiles[instruction.b].runs++;
+                        break;
+                    }
+                    case OP_CALL_NATIVE: {
+                        auto const &site = m_program.call_sites[instruction.wide()];
+                        m_native_calls[site.native]++;
+                        auto const &native = m_natives[site.native];
+                        if(native) {
+                            // The native function may wake or sleep scripts, so keep the thread consistent
+                            save();
+                            auto result = native(*this, r + site.first_argument, site.argument_count);
+                            r = thread.registers.data() + thread.base;
+                            r[instruction.a] = result;
+                        }
+                        else {
+                            r[instruction.a].integer = 0;
+                        }
+                        break;
+                    }
+                    case OP_SLEEP:
+                        sleep(instruction.b, thread, r[instruction.a].integer);
+                        if(instruction.b == NO_SCRIPT) {
+                            save();
+                            return RUN_SLEEPING;
+                        }
+                        break;
+                    case OP_WAKE:
+                        wake(instruction.b);
+                        break;
+                    case OP_RETURN: {
+                        auto result = r[instruction.a];
+                        if(thread.frames.empty()) {
+                            save();
+                            thread.result = result;
+                            thread.running = false;
+                            return RUN_FINISHED;
+                        }
+                        auto frame = thread.frames.back();
+                        thread.frames.pop_back();
+                        thread.function = frame.function;
+                        thread.base = frame.base;
+                        r = thread.registers.data() + frame.base;
+                        r[frame.dst] = result;
+                        pc = frame.return_pc;
+                        break;
+                    }
+                    default:
+                        save();
+                        throw std::runtime_error(fmt::format("Invalid opcode {}", static_cast<int>(instruction.op)));
+                }
+            }
+        }
+    };
+
+    /**
+     * Result of a benchmark
+     */
+    struct BenchmarkResult {
+        struct Script {
+            std::string name;
+            Machine::ScriptProfile profile;
+        };
+
+        std::size_t ticks;
+        std::uint64_t instructions;
+        std::chrono::nanoseconds time;
+
+        /** Scripts that ran, the most expensive first */
+        std::vector<Script> scripts;
+    };
+
+    /**
+     * Run a machine for a number of ticks and collect its profile
+     * @param machine   machine to run
+     * @param ticks     number of ticks
+     * @return          result
+     */
+    inline BenchmarkResult benchmark(Machine &machine, std::size_t ticks) {
+        BenchmarkResult result;
+        result.ticks = ticks;
+        auto start_time = std::chrono::steady_clock::now();
+        result.instructions = machine.run_ticks(ticks);
+        result.time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_time);
+
+        auto const &program = machine.program();
+        for(std::size_t i = 0; i < program.script_count; i++) {
+            auto const &profile = machine.profile(i);
+            if(profile.runs > 0) {
+                result.scripts.push_back({ program.functions[i].name, profile });
+            }
+        }
+        std::sort(result.scripts.begin(), result.scripts.end(), [](auto const &a, auto const &b) {
+            return a.profile.time > b.profile.time;
+        });
+        return result;
+    }
+}
+
+#endif
@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_API__HELPERS__SCRIPT_VM_TAG_HPP
+#define BALLTZE_API__HELPERS__SCRIPT_VM_TAG_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <string>
+#include "../engine/tag_definitions/scenario.hpp"
+#include "script_vm.hpp"
+
+/**
+ * Script VM entry points for scenario tags
+ */
+namespace Balltze::ScriptVM {
+    static_assert(static_cast<std::uint16_t>(VALUE_TYPE_SCRIPT) == Engine::TagDefinitions::SCENARIO_SCRIPT_VALUE_TYPE_SCRIPT);
+    static_assert(static_cast<std::uint16_t>(SCRIPT_TYPE_STUB) == Engine::TagDefinitions::SCENARIO_SCRIPT_TYPE_STUB);
+    static_assert(sizeof(Node) == sizeof(Engine::TagDefinitions::ScenarioScriptNode));
+    static_assert(offsetof(Node, next_node) == offsetof(Engine::TagDefinitions::ScenarioScriptNode, next_node));
+    static_assert(offsetof(Node, data) == offsetof(Engine::TagDefinitions::ScenarioScriptNode, data));
+
+    /**
+     * Get the script data of a scenario tag
+     * @param scenario  scenario tag data; its data offsets must point to loaded data
+     */
+    inline Source from_scenario(Engine::TagDefinitions::Scenario const &scenario) {
+        using namespace Engine::TagDefinitions;
+        auto tag_string = [](Engine::TagString const &string) {
+            return std::string(string.string, strnlen(string.string, sizeof(string.string)));
+        };
+
+        Source source;
+        auto const &syntax = scenario.script_syntax_data;
+        if(syntax.pointer && syntax.size >= sizeof(ScenarioScriptNodeTable)) {
+            auto const *table = reinterpret_cast<ScenarioScriptNodeTable const *>(syntax.pointer);
+            auto available = (syntax.size - sizeof(ScenarioScriptNodeTable)) / sizeof(ScenarioScriptNode);
+            source.nodes.resize(std::min<std::size_t>(table->size, available));
+            std::memcpy(source.nodes.data(), syntax.pointer + sizeof(ScenarioScriptNodeTable), source.nodes.size() * sizeof(Node));
+        }
+        if(scenario.script_string_data.pointer) {
+            auto const *strings = reinterpret_cast<char const *>(scenario.script_string_data.pointer);
+            source.strings.assign(strings, strings + scenario.script_string_data.size);
+        }
+        for(std::size_t i = 0; i < scenario.scripts.count; i++) {
+            auto const &script = scenario.scripts.offset[i];
+            source.scripts.push_back({ tag_string(script.name), static_cast<ScriptType>(script.script_type), static_cast<ValueType>(script.return_type), script.root_expression_index, static_cast<std::uint16_t>(script.parameters.count) });
+        }
+        for(std::size_t i = 0; i < scenario.globals.count; i++) {
+            auto const &global = scenario.globals.offset[i];
+            source.globals.push_back({ tag_string(global.name), static_cast<ValueType>(global.type), static_cast<std::uint32_t>(global.initialization_expression_index) });
+        }
+        return source;
+    }
+}
+
+#endif
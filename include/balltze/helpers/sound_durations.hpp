@@ -0,0 +1,248 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_API__HELPERS__SOUND_DURATIONS_HPP
+#define BALLTZE_API__HELPERS__SOUND_DURATIONS_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+#include <unordered_map>
+#include <vector>
+#include "../engine/tag_definitions/sound.hpp"
+#include "adpcm_tag.hpp"
+
+#ifdef _WIN32
+#include "../engine/tag.hpp"
+#include "../events/map_load.hpp"
+#endif
+
+namespace Balltze {
+    /**
+     * Table of the length of every sound permutation, built once per map.
+     *
+     * Permutations linked through next_permutation_index play one after another, so
+     * besides its own length each permutation records the length of the whole chain
+     * starting at it.
+     */
+    class SoundDurationTable {
+    public:
+        using Sound = Engine::TagDefinitions::Sound;
+        using SoundPermutation = Engine::TagDefinitions::SoundPermutation;
+
+        /**
+         * Length of a permutation
+         */
+        struct Entry {
+            /** Samples per channel of the permutation */
+            std::uint32_t samples;
+
+            /** Samples per channel of the permutation and every permutation chained after it */
+            std::uint32_t chain_samples;
+
+            /** Samples per second */
+            std::uint32_t sample_rate;
+
+            std::chrono::milliseconds duration() const noexcept {
+                return std::chrono::milliseconds(sample_rate ? static_cast<std::uint64_t>(samples) * 1000 / sample_rate : 0);
+            }
+
+            std::chrono::milliseconds chain_duration() const noexcept {
+                return std::chrono::milliseconds(sample_rate ? static_cast<std::uint64_t>(chain_samples) * 1000 / sample_rate : 0);
+            }
+        };
+
+        /**
+         * Add the permutations of a sound tag
+         * @param tag_index index of the tag
+         * @param sound     sound tag data
+         */
+        void add(std::uint16_t tag_index, Sound const &sound) {
+            using namespace Engine::TagDefinitions;
+            if(m_tags.size() <= tag_index) {
+                m_tags.resize(tag_index + 1, NO_ENTRY);
+            }
+            m_tags[tag_index] = static_cast<std::uint32_t>(m_pitch_ranges.size());
+
+            std::uint32_t sample_rate = sound.sample_rate == SOUND_SAMPLE_RATE_44100__HZ ? 44100 : 22050;
+            std::uint32_t channels = sound.channel_count == SOUND_CHANNEL_COUNT_STEREO ? 2 : 1;
+            for(std::size_t p = 0; p < sound.pitch_ranges.count; p++) {
+                auto const &pitch_range = sound.pitch_ranges.offset[p];
+                auto first = static_cast<std::uint32_t>(m_entries.size());
+                m_pitch_ranges.push_back(first);
+
+                for(std::size_t i = 0; i < pitch_range.permutations.count; i++) {
+                    auto const &permutation = pitch_range.permutations.offset[i];
+                    m_entries.push_back({ sample_count(permutation, sound.channel_count, channels), 0, sample_rate });
+                    m_permutations[&permutation] = first + static_cast<std::uint32_t>(i);
+                }
+
+                // Follow the chains; stop if a chain loops back on itself
+                std::size_t count = pitch_range.permutations.count;
+                for(std::size_t i = 0; i < count; i++) {
+                    std::uint32_t chain_samples = 0;
+                    std::size_t index = i;
+                    for(std::size_t steps = 0; index < count && steps < count; steps++) {
+                        chain_samples += m_entries[first + index].samples;
+                        index = pitch_range.permutations.offset[index].next_permutation_index;
+                    }
+                    m_entries[first + i].chain_samples = chain_samples;
+                }
+            }
+            m_tags_pitch_range_count.resize(m_tags.size(), 0);
+            m_tags_pitch_range_count[tag_index] = static_cast<std::uint32_t>(sound.pitch_ranges.count);
+        }
+
+        /**
+         * Look a permutation up
+         * @param permutation   permutation of a sound added to the table
+         * @return              entry; nullptr if the permutation is not in the table
+         */
+        Entry const *find(SoundPermutation const *permutation) const noexcept {
+            auto it = m_permutations.find(permutation);
+            return it != m_permutations.end() ? &m_entries[it->second] : nullptr;
+        }
+
+        /**
+         * Look a permutation up
+         * @param tag_index     index of the sound tag
+         * @param pitch_range   pitch range index
+         * @param permutation   permutation index
+         * @return              entry; nullptr if the permutation is not in the table
+         */
+        Entry const *find(std::uint16_t tag_index, std::size_t pitch_range, std::size_t permutation) const noexcept {
+            if(tag_index >= m_tags.size() || m_tags[tag_index] == NO_ENTRY || pitch_range >= m_tags_pitch_range_count[tag_index]) {
+                return nullptr;
+            }
+            auto range = m_tags[tag_index] + pitch_range;
+            auto first = m_pitch_ranges[range];
+            auto end = range + 1 < m_pitch_ranges.size() ? m_pitch_ranges[range + 1] : m_entries.size();
+            if(first + permutation >= end) {
+                return nullptr;
+            }
+            return &m_entries[first + permutation];
+        }
+
+        void clear() noexcept {
+            m_entries.clear();
+            m_pitch_ranges.clear();
+            m_tags.clear();
+            m_tags_pitch_range_count.clear();
+            m_permutations.clear();
+            m_built = false;
+        }
+
+        bool empty() const noexcept {
+            return m_entries.empty();
+        }
+
+        std::size_t size() const noexcept {
+            return m_entries.size();
+        }
+
+        /**
+         * Get the number of samples per channel of a permutation
+         * @param permutation   permutation
+         * @param channel_count channel count of the sound
+         * @param channels      number of channels
+         */
+        static std::uint32_t sample_count(SoundPermutation const &permutation, Engine::TagDefinitions::SoundChannelCount channel_count, std::uint32_t channels) noexcept {
+            using namespace Engine::TagDefinitions;
+            switch(permutation.format) {
+                case SOUND_FORMAT_16_BIT_PCM:
+                    return permutation.samples.size / (2 * channels);
+                case SOUND_FORMAT_XBOX_ADPCM:
+                case SOUND_FORMAT_IMA_ADPCM:
+                    return static_cast<std::uint32_t>(Adpcm::sample_count(Adpcm::sound_format(permutation.format, channel_count), permutation.samples.size));
+                case SOUND_FORMAT_OGG_VORBIS:
+                    // The buffer size is the size of the decoded 16-bit PCM data
+                    return permutation.buffer_size / (2 * channels);
+                default:
+                    return 0;
+            }
+        }
+
+        #ifdef _WIN32
+        /**
+         * Get the table of the current map. It is built on first use and rebuilt when a map is loaded.
+         */
+        static SoundDurationTable &get() {
+            auto &table = instance();
+            if(!table.m_built) {
+                table.build();
+            }
+            return table;
+        }
+
+        /**
+         * Rebuild the table from the tags of the current map
+         */
+        void build() {
+            clear();
+            auto &header = Engine::get_tag_data_header();
+            for(std::size_t i = 0; i < header.tag_count; i++) {
+                auto &tag = header.tag_array[i];
+                if(tag.primary_class == Engine::TAG_CLASS_SOUND && tag.data) {
+                    add(static_cast<std::uint16_t>(i), *tag.get_data<Sound>());
+                }
+            }
+            m_built = true;
+        }
+        #endif
+
+        SoundDurationTable() = default;
+
+    private:
+        static constexpr std::uint32_t NO_ENTRY = 0xFFFFFFFF;
+
+        std::vector<Entry> m_entries;
+
+        /** First entry of each pitch range */
+        std::vector<std::uint32_t> m_pitch_ranges;
+
+        /** First pitch range of each tag */
+        std::vector<std::uint32_t> m_tags;
+        std::vector<std::uint32_t> m_tags_pitch_range_count;
+
+        std::unordered_map<SoundPermutation const *, std::uint32_t> m_permutations;
+        bool m_built = false;
+
+        #ifdef _WIN32
+        Event::EventListenerHandle<Event::MapLoadEvent> m_map_load_listener;
+
+        static SoundDurationTable &instance() {
+            static SoundDurationTable table(true);
+            return table;
+        }
+
+        SoundDurationTable(bool) {
+            m_map_load_listener = Event::MapLoadEvent::subscribe_const([](Event::MapLoadEvent const &event) {
+                auto &table = SoundDurationTable::instance();
+                if(event.time == Event::EVENT_TIME_BEFORE) {
+                    table.clear();
+                }
+                else {
+                    table.build();
+                }
+            });
+        }
+        #endif
+    };
+
+    #ifdef _WIN32
+    /**
+     * Get the duration of a sound permutation from the duration table of the current map
+     * @param permutation   pointer to sound permutation
+     * @param chain         whether to include the permutations chained after it
+     * @return              duration of the sound permutation; zero if the permutation is not in the current map
+     */
+    inline std::chrono::milliseconds get_sound_permutation_duration_cached(Engine::TagDefinitions::SoundPermutation const *permutation, bool chain = false) {
+        auto *entry = SoundDurationTable::get().find(permutation);
+        if(!entry) {
+            return std::chrono::milliseconds(0);
+        }
+        return chain ? entry->chain_duration() : entry->duration();
+    }
+    #endif
+}
+
+#endif
@@ -0,0 +1,609 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_API__HELPERS__SPRITE_BATCH_HPP
+#define BALLTZE_API__HELPERS__SPRITE_BATCH_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <vector>
+
+#ifdef _WIN32
+#include <d3d9.h>
+#endif
+
+namespace Balltze {
+    /**
+     * Pre-transformed, colored and textured vertex (D3DFVF_XYZRHW | D3DFVF_DIFFUSE | D3DFVF_TEX1)
+     */
+    struct SpriteVertex {
+        float x, y, z, rhw;
+        std::uint32_t color;
+        float u, v;
+    };
+    static_assert(sizeof(SpriteVertex) == 0x1C);
+
+    /**
+     * Direct3D 9 state values used by the sprite batch, so the batching logic
+     * does not depend on the Direct3D headers
+     */
+    namespace SpriteBatchState {
+        constexpr std::uint32_t FVF = 0x004 | 0x040 | 0x100;
+
+        enum RenderState : std::uint32_t {
+            RS_ZENABLE = 7,
+            RS_ZWRITEENABLE = 14,
+            RS_ALPHATESTENABLE = 15,
+            RS_SRCBLEND = 19,
+            RS_DESTBLEND = 20,
+            RS_CULLMODE = 22,
+            RS_ALPHABLENDENABLE = 27,
+            RS_FOGENABLE = 28,
+            RS_STENCILENABLE = 52,
+            RS_LIGHTING = 137,
+            RS_BLENDOP = 171
+        };
+
+        enum TextureStageState : std::uint32_t {
+            TSS_COLOROP = 1,
+            TSS_COLORARG1 = 2,
+            TSS_COLORARG2 = 3,
+            TSS_ALPHAOP = 4,
+            TSS_ALPHAARG1 = 5,
+            TSS_ALPHAARG2 = 6,
+            TSS_TEXCOORDINDEX = 11
+        };
+
+        enum SamplerState : std::uint32_t {
+            SAMP_ADDRESSU = 1,
+            SAMP_ADDRESSV = 2,
+            SAMP_MAGFILTER = 5,
+            SAMP_MINFILTER = 6,
+            SAMP_MIPFILTER = 7
+        };
+
+        constexpr std::uint32_t BLEND_SRCALPHA = 5;
+        constexpr std::uint32_t BLEND_INVSRCALPHA = 6;
+        constexpr std::uint32_t BLENDOP_ADD = 1;
+        constexpr std::uint32_t CULL_NONE = 1;
+        constexpr std::uint32_t TOP_DISABLE = 1;
+        constexpr std::uint32_t TOP_MODULATE = 4;
+        constexpr std::uint32_t TA_DIFFUSE = 0;
+        constexpr std::uint32_t TA_TEXTURE = 2;
+        constexpr std::uint32_t TEXF_NONE = 0;
+        constexpr std::uint32_t TEXF_LINEAR = 2;
+        constexpr std::uint32_t TADDRESS_CLAMP = 3;
+    }
+
+    /**
+     * Shadow of the device state in flat arrays. Sets that would not change the
+     * device are skipped, and the first time a state or a texture is touched its value 
+     * is saved so restore() can put it back. begin() forgets the shadow, since other 
+     * code changes the device between batches.
+     *
+     * @tparam Device   device type; see SpriteBatch
+     */
+    template<typename Device>
+    class DeviceStateCache {
+    public:
+        using Texture = typename Device::Texture;
+
+        static constexpr std::size_t RENDER_STATE_COUNT = 256;
+        static constexpr std::size_t TEXTURE_STAGE_COUNT = 8;
+        static constexpr std::size_t TEXTURE_STAGE_STATE_COUNT = 33;
+        static constexpr std::size_t SAMPLER_COUNT = 16;
+        static constexpr std::size_t SAMPLER_STATE_COUNT = 14;
+
+        DeviceStateCache(Device &device) : m_device(device) {}
+
+        /**
+         * Forget the shadowed state; call before using the device after other code did
+         */
+        void begin() noexcept {
+            m_epoch++;
+            m_touched.clear();
+            m_textures.fill({});
+            m_saved_textures.fill({});
+            m_textures_known.fill(false);
+            m_skipped = 0;
+        }
+
+        void set_render_state(std::uint32_t state, std::uint32_t value) {
+            if(state >= RENDER_STATE_COUNT) {
+                m_device.set_render_state(state, value);
+                return;
+            }
+            set(RENDER_STATE, static_cast<std::uint16_t>(state), value);
+        }
+
+        void set_texture_stage_state(std::uint32_t stage, std::uint32_t type, std::uint32_t value) {
+            if(stage >= TEXTURE_STAGE_COUNT || type >= TEXTURE_STAGE_STATE_COUNT) {
+                m_device.set_texture_stage_state(stage, type, value);
+                return;
+            }
+            set(TEXTURE_STAGE_STATE, static_cast<std::uint16_t>(stage * TEXTURE_STAGE_STATE_COUNT + type), value);
+        }
+
+        void set_sampler_state(std::uint32_t sampler, std::uint32_t type, std::uint32_t value) {
+            if(sampler >= SAMPLER_COUNT || type >= SAMPLER_STATE_COUNT) {
+                m_device.set_sampler_state(sampler, type, value);
+                return;
+            }
+            set(SAMPLER_STATE, static_cast<std::uint16_t>(sampler * SAMPLER_STATE_COUNT + type), value);
+        }
+
+        void set_texture(std::uint32_t stage, Texture texture) {
+            if(stage < TEXTURE_STAGE_COUNT && !m_textures_known[stage]) {
+                m_saved_textures[stage] = m_textures[stage] = m_device.get_texture(stage);
+                m_textures_known[stage] = true;
+            }
+            if(stage < TEXTURE_STAGE_COUNT && m_textures[stage] == texture) {
+                m_skipped++;
+                return;
+            }
+            m_device.set_texture(stage, texture);
+            if(stage < TEXTURE_STAGE_COUNT) {
+                m_textures[stage] = texture;
+                m_textures_known[stage] = true;
+            }
+        }
+
+        /**
+         * Put back every state and texture changed since begin()
+         */
+        void restore() {
+            for(auto it = m_touched.rbegin(); it != m_touched.rend(); it++) {
+                auto &slot = slot_of(it->kind, it->index);
+                if(slot.value != slot.saved) {
+                    apply(it->kind, it->index, slot.saved);
+                    slot.value = slot.saved;
+                }
+            }
+            m_touched.clear();
+            for(std::uint32_t stage = 0; stage < TEXTURE_STAGE_COUNT; stage++) {
+                if(m_textures_known[stage] && m_textures[stage] != m_saved_textures[stage]) {
+                    m_device.set_texture(stage, m_saved_textures[stage]);
+                    m_textures[stage] = m_saved_textures[stage];
+                }
+            }
+        }
+
+        /**
+         * Get the number of sets skipped since begin() because they would not change anything
+         */
+        std::size_t skipped() const noexcept {
+            return m_skipped;
+        }
+
+    private:
+        enum Kind : std::uint8_t {
+            RENDER_STATE,
+            TEXTURE_STAGE_STATE,
+            SAMPLER_STATE
+        };
+
+        struct Slot {
+            std::uint32_t value;
+            std::uint32_t saved;
+            std::uint32_t epoch;
+        };
+
+        struct Touched {
+            Kind kind;
+            std::uint16_t index;
+        };
+
+        Device &m_device;
+        std::uint32_t m_epoch = 1;
+        std::array<Slot, RENDER_STATE_COUNT> m_render_states = {};
+        std::array<Slot, TEXTURE_STAGE_COUNT * TEXTURE_STAGE_STATE_COUNT> m_texture_stage_states = {};
+        std::array<Slot, SAMPLER_COUNT * SAMPLER_STATE_COUNT> m_sampler_states = {};
+        std::array<Texture, TEXTURE_STAGE_COUNT> m_textures = {};
+        std::array<Texture, TEXTURE_STAGE_COUNT> m_saved_textures = {};
+        std::array<bool, TEXTURE_STAGE_COUNT> m_textures_known = {};
+        std::vector<Touched> m_touched;
+        std::size_t m_skipped = 0;
+
+        Slot &slot_of(Kind kind, std::uint16_t index) noexcept {
+            switch(kind) {
+                case RENDER_STATE:
+                    return m_render_states[index];
+                case TEXTURE_STAGE_STATE:
+                    return m_texture_stage_states[index];
+                default:
+                    return m_sampler_states[index];
+            }
+        }
+
+        std::uint32_t fetch(Kind kind, std::uint16_t index) {
+            switch(kind) {
+                case RENDER_STATE:
+                    return m_device.get_render_state(index);
+                case TEXTURE_STAGE_STATE:
+                    return m_device.get_texture_stage_state(index / TEXTURE_STAGE_STATE_COUNT, index % TEXTURE_STAGE_STATE_COUNT);
+                default:
+                    return m_device.get_sampler_state(index / SAMPLER_STATE_COUNT, index % SAMPLER_STATE_COUNT);
+            }
+        }
+
+        void apply(Kind kind, std::uint16_t index, std::uint32_t value) {
+            switch(kind) {
+                case RENDER_STATE:
+                    m_device.set_render_state(index, value);
+                    break;
+                case TEXTURE_STAGE_STATE:
+                    m_device.set_texture_stage_state(index / TEXTURE_STAGE_STATE_COUNT, index % TEXTURE_STAGE_STATE_COUNT, value);
+                    break;
+                default:
+                    m_device.set_sampler_state(index / SAMPLER_STATE_COUNT, index % SAMPLER_STATE_COUNT, value);
+                    break;
+            }
+        }
+
+        void set(Kind kind, std::uint16_t index, std::uint32_t value) {
+            auto &slot = slot_of(kind, index);
+            if(slot.epoch != m_epoch) {
+                slot.saved = slot.value = fetch(kind, index);
+                slot.epoch = m_epoch;
+                m_touched.push_back({ kind, index });
+            }
+            if(slot.value == value) {
+                m_skipped++;
+                return;
+            }
+            apply(kind, index, value);
+            slot.value = value;
+        }
+    };
+
+    /**
+     * Sprite batcher. Sprites queued during a frame are sorted by layer and texture
+     * and written to one dynamic vertex buffer; each run of sprites sharing a texture
+     * is drawn with a single call. Within a layer the drawing order of sprites with
+     * different textures is not kept, so overlapping sprites must use different layers.
+     *
+     * The device type wraps the actual device, which allows testing against a mock. It must provide:
+     *   - Texture: texture handle type
+     *   - std::uint32_t get_render_state(std::uint32_t state) and set_render_state(state, value)
+     *   - std::uint32_t get_texture_stage_state(stage, type) and set_texture_stage_state(stage, type, value)
+     *   - std::uint32_t get_sampler_state(sampler, type) and set_sampler_state(sampler, type, value)
+     *   - Texture get_texture(std::uint32_t stage): bound texture; it must stay valid until end_batch()
+     *   - void set_texture(std::uint32_t stage, Texture texture)
+     *   - void begin_batch() and end_batch(): set and restore the vertex format, shaders and stream
+     *   - std::size_t vertex_capacity(): size of the vertex buffer in vertices
+     *   - SpriteVertex *lock_vertices(std::size_t first, std::size_t count, bool discard): nullptr if the 
+     *     buffer cannot be locked, in which case the sprites left in the frame are dropped
+     *   - void unlock_vertices()
+     *   - void draw_quads(std::size_t first_vertex, std::size_t quad_count): draw a triangle list, six vertices per quad
+     *
+     * @tparam Device   device type
+     */
+    template<typename Device>
+    class SpriteBatch {
+    public:
+        using Texture = typename Device::Texture;
+
+        /**
+         * Texture coordinates of a sprite
+         */
+        struct UVRect {
+            float left = 0.0f;
+            float top = 0.0f;
+            float right = 1.0f;
+            float bottom = 1.0f;
+        };
+
+        SpriteBatch(Device &device) : m_device(device), m_state(device) {}
+
+        /**
+         * Queue a sprite
+         * @param texture   texture to draw
+         * @param x         left side in pixels
+         * @param y         top side in pixels
+         * @param width     width in pixels
+         * @param height    height in pixels
+         * @param color     ARGB color multiplied with the texture
+         * @param uv        texture coordinates
+         * @param angle     rotation around the center of the sprite, in radians
+         * @param layer     sprites of lower layers are drawn first
+         */
+        void draw(Texture texture, float x, float y, float width, float height, std::uint32_t color = 0xFFFFFFFF, UVRect const &uv = {}, float angle = 0.0f, std::int32_t layer = 0) {
+            QueuedSprite sprite;
+            sprite.texture = texture;
+            sprite.layer = layer;
+            sprite.order = static_cast<std::uint32_t>(m_sprites.size());
+            float corners[4][2] = { { x, y }, { x + width, y }, { x, y + height }, { x + width, y + height } };
+            if(angle != 0.0f) {
+                float center_x = x + width / 2, center_y = y + height / 2;
+                float c = std::cos(angle), s = std::sin(angle);
+                for(auto &corner : corners) {
+                    float dx = corner[0] - center_x, dy = corner[1] - center_y;
+                    corner[0] = center_x + dx * c - dy * s;
+                    corner[1] = center_y + dx * s + dy * c;
+                }
+            }
+            float uvs[4][2] = { { uv.left, uv.top }, { uv.right, uv.top }, { uv.left, uv.bottom }, { uv.right, uv.bottom } };
+            for(std::size_t i = 0; i < 4; i++) {
+                // Offset by half a pixel so texels map to pixels
+                sprite.corners[i] = { corners[i][0] - 0.5f, corners[i][1] - 0.5f, 0.0f, 1.0f, color, uvs[i][0], uvs[i][1] };
+            }
+            m_sprites.push_back(sprite);
+        }
+
+        /**
+         * Draw every queued sprite and clear the queue
+         * @return number of draw calls issued
+         */
+        std::size_t flush() {
+            if(m_sprites.empty()) {
+                return 0;
+            }
+            std::sort(m_sprites.begin(), m_sprites.end(), [](QueuedSprite const &a, QueuedSprite const &b) {
+                if(a.layer != b.layer) {
+                    return a.layer < b.layer;
+                }
+                if(a.texture != b.texture) {
+                    return std::less<Texture>()(a.texture, b.texture);
+                }
+                return a.order < b.order;
+            });
+
+            m_state.begin();
+            apply_states();
+            m_device.begin_batch();
+
+            std::size_t capacity = m_device.vertex_capacity() / 6;
+            std::size_t draw_calls = 0;
+            if(capacity == 0) {
+                m_sprites.clear();
+            }
+            for(std::size_t first = 0; first < m_sprites.size(); ) {
+                // Wrap around when the buffer is full; discarding lets the driver hand out fresh memory
+                std::size_t count = std::min(m_sprites.size() - first, capacity);
+                bool discard = m_vertex_cursor + count * 6 > capacity * 6;
+                if(discard) {
+                    m_vertex_cursor = 0;
+                }
+                auto *vertices = m_device.lock_vertices(m_vertex_cursor, count * 6, discard);
+                if(!vertices) {
+                    // e.g. the device was lost; start over with a discarding lock next time
+                    m_vertex_cursor = capacity * 6;
+                    break;
+                }
+                for(std::size_t i = 0; i < count; i++) {
+                    auto const &corners = m_sprites[first + i].corners;
+                    auto *quad = vertices + i * 6;
+                    quad[0] = corners[0];
+                    quad[1] = corners[1];
+                    quad[2] = corners[2];
+                    quad[3] = corners[2];
+                    quad[4] = corners[1];
+                    quad[5] = corners[3];
+                }
+                m_device.unlock_vertices();
+
+                for(std::size_t run = 0; run < count; ) {
+                    std::size_t run_end = run + 1;
+                    auto texture = m_sprites[first + run].texture;
+                    while(run_end < count && m_sprites[first + run_end].texture == texture) {
+                        run_end++;
+                    }
+                    m_state.set_texture(0, texture);
+                    m_device.draw_quads(m_vertex_cursor + run * 6, run_end - run);
+                    draw_calls++;
+                    run = run_end;
+                }
+                m_vertex_cursor += count * 6;
+                first += count;
+            }
+
+            // Textures saved by the state cache are valid until end_batch()
+            m_state.restore();
+            m_device.end_batch();
+            m_sprites.clear();
+            return draw_calls;
+        }
+
+        /**
+         * Get the number of queued sprites
+         */
+        std::size_t size() const noexcept {
+            return m_sprites.size();
+        }
+
+        DeviceStateCache<Device> &state() noexcept {
+            return m_state;
+        }
+
+    private:
+        struct QueuedSprite {
+            Texture texture;
+            std::int32_t layer;
+            std::uint32_t order;
+            SpriteVertex corners[4];
+        };
+
+        Device &m_device;
+        DeviceStateCache<Device> m_state;
+        std::vector<QueuedSprite> m_sprites;
+        std::size_t m_vertex_cursor = 0;
+
+        void apply_states() {
+            using namespace SpriteBatchState;
+            m_state.set_render_state(RS_ZENABLE, 0);
+            m_state.set_render_state(RS_ZWRITEENABLE, 0);
+            m_state.set_render_state(RS_STENCILENABLE, 0);
+            m_state.set_render_state(RS_ALPHATESTENABLE, 0);
+            m_state.set_render_state(RS_FOGENABLE, 0);
+            m_state.set_render_state(RS_LIGHTING, 0);
+            m_state.set_render_state(RS_CULLMODE, CULL_NONE);
+            m_state.set_render_state(RS_ALPHABLENDENABLE, 1);
+            m_state.set_render_state(RS_BLENDOP, BLENDOP_ADD);
+            m_state.set_render_state(RS_SRCBLEND, BLEND_SRCALPHA);
+            m_state.set_render_state(RS_DESTBLEND, BLEND_INVSRCALPHA);
+
+            m_state.set_texture_stage_state(0, TSS_COLOROP, TOP_MODULATE);
+            m_state.set_texture_stage_state(0, TSS_COLORARG1, TA_TEXTURE);
+            m_state.set_texture_stage_state(0, TSS_COLORARG2, TA_DIFFUSE);
+            m_state.set_texture_stage_state(0, TSS_ALPHAOP, TOP_MODULATE);
+            m_state.set_texture_stage_state(0, TSS_ALPHAARG1, TA_TEXTURE);
+            m_state.set_texture_stage_state(0, TSS_ALPHAARG2, TA_DIFFUSE);
+            m_state.set_texture_stage_state(0, TSS_TEXCOORDINDEX, 0);
+            m_state.set_texture_stage_state(1, TSS_COLOROP, TOP_DISABLE);
+            m_state.set_texture_stage_state(1, TSS_ALPHAOP, TOP_DISABLE);
+
+            m_state.set_sampler_state(0, SAMP_ADDRESSU, TADDRESS_CLAMP);
+            m_state.set_sampler_state(0, SAMP_ADDRESSV, TADDRESS_CLAMP);
+            m_state.set_sampler_state(0, SAMP_MAGFILTER, TEXF_LINEAR);
+            m_state.set_sampler_state(0, SAMP_MINFILTER, TEXF_LINEAR);
+            m_state.set_sampler_state(0, SAMP_MIPFILTER, TEXF_NONE);
+        }
+    };
+
+    #ifdef _WIN32
+    /**
+     * SpriteBatch device for Direct3D 9
+     */
+    class Direct3D9SpriteDevice {
+    public:
+        using Texture = IDirect3DBaseTexture9 *;
+
+        /**
+         * @param device    device to draw with
+         * @param capacity  size of the dynamic vertex buffer in sprites
+         */
+        Direct3D9SpriteDevice(IDirect3DDevice9 *device, std::size_t capacity = 2048) : m_device(device), m_capacity(capacity * 6) {}
+
+        Direct3D9SpriteDevice(Direct3D9SpriteDevice const &) = delete;
+        Direct3D9SpriteDevice &operator=(Direct3D9SpriteDevice const &) = delete;
+
+        ~Direct3D9SpriteDevice() {
+            release();
+        }
+
+        /**
+         * Release the vertex buffer; call on device reset
+         */
+        void release() noexcept {
+            if(m_vertex_buffer) {
+                m_vertex_buffer->Release();
+                m_vertex_buffer = nullptr;
+            }
+        }
+
+        std::uint32_t get_render_state(std::uint32_t state) {
+            DWORD value = 0;
+            m_device->GetRenderState(static_cast<D3DRENDERSTATETYPE>(state), &value);
+            return value;
+        }
+
+        void set_render_state(std::uint32_t state, std::uint32_t value) {
+            m_device->SetRenderState(static_cast<D3DRENDERSTATETYPE>(state), value);
+        }
+
+        std::uint32_t get_texture_stage_state(std::uint32_t stage, std::uint32_t type) {
+            DWORD value = 0;
+            m_device->GetTextureStageState(stage, static_cast<D3DTEXTURESTAGESTATETYPE>(type), &value);
+            return value;
+        }
+
+        void set_texture_stage_state(std::uint32_t stage, std::uint32_t type, std::uint32_t value) {
+            m_device->SetTextureStageState(stage, static_cast<D3DTEXTURESTAGESTATETYPE>(type), value);
+        }
+
+        std::uint32_t get_sampler_state(std::uint32_t sampler, std::uint32_t type) {
+            DWORD value = 0;
+            m_device->GetSamplerState(sampler, static_cast<D3DSAMPLERSTATETYPE>(type), &value);
+            return value;
+        }
+
+        void set_sampler_state(std::uint32_t sampler, std::uint32_t type, std::uint32_t value) {
+            m_device->SetSamplerState(sampler, static_cast<D3DSAMPLERSTATETYPE>(type), value);
+        }
+
+        Texture get_texture(std::uint32_t stage) {
+            // Referenced until end_batch(), so the texture outlives being unbound by the batch
+            Texture texture = nullptr;
+            if(SUCCEEDED(m_device->GetTexture(stage, &texture)) && texture) {
+                m_old_textures.push_back(texture);
+            }
+            return texture;
+        }
+
+        void set_texture(std::uint32_t stage, Texture texture) {
+            m_device->SetTexture(stage, texture);
+        }
+
+        void begin_batch() {
+            if(!m_vertex_buffer) {
+                m_device->CreateVertexBuffer(static_cast<UINT>(m_capacity * sizeof(SpriteVertex)), D3DUSAGE_DYNAMIC | D3DUSAGE_WRITEONLY, SpriteBatchState::FVF, D3DPOOL_DEFAULT, &m_vertex_buffer, nullptr);
+            }
+            m_device->GetFVF(&m_old_fvf);
+            m_device->GetPixelShader(&m_old_pixel_shader);
+            m_device->GetVertexShader(&m_old_vertex_shader);
+            m_device->GetStreamSource(0, &m_old_stream, &m_old_stream_offset, &m_old_stream_stride);
+            m_device->SetFVF(SpriteBatchState::FVF);
+            m_device->SetPixelShader(nullptr);
+            m_device->SetVertexShader(nullptr);
+            m_device->SetStreamSource(0, m_vertex_buffer, 0, sizeof(SpriteVertex));
+        }
+
+        void end_batch() {
+            m_device->SetFVF(m_old_fvf);
+            m_device->SetPixelShader(m_old_pixel_shader);
+            m_device->SetVertexShader(m_old_vertex_shader);
+            m_device->SetStreamSource(0, m_old_stream, m_old_stream_offset, m_old_stream_stride);
+            for(IUnknown *object : { static_cast<IUnknown *>(m_old_pixel_shader), static_cast<IUnknown *>(m_old_vertex_shader), static_cast<IUnknown *>(m_old_stream) }) {
+                if(object) {
+                    object->Release();
+                }
+            }
+            m_old_pixel_shader = nullptr;
+            m_old_vertex_shader = nullptr;
+            m_old_stream = nullptr;
+            for(auto *texture : m_old_textures) {
+                texture->Release();
+            }
+            m_old_textures.clear();
+        }
+
+        std::size_t vertex_capacity() const noexcept {
+            return m_vertex_buffer ? m_capacity : 0;
+        }
+
+        SpriteVertex *lock_vertices(std::size_t first, std::size_t count, bool discard) {
+            void *data = nullptr;
+            auto result = m_vertex_buffer->Lock(static_cast<UINT>(first * sizeof(SpriteVertex)), static_cast<UINT>(count * sizeof(SpriteVertex)), &data, discard ? D3DLOCK_DISCARD : D3DLOCK_NOOVERWRITE);
+            if(FAILED(result)) {
+                return nullptr;
+            }
+            return static_cast<SpriteVertex *>(data);
+        }
+
+        void unlock_vertices() {
+            m_vertex_buffer->Unlock();
+        }
+
+        void draw_quads(std::size_t first_vertex, std::size_t quad_count) {
+            m_device->DrawPrimitive(D3DPT_TRIANGLELIST, static_cast<UINT>(first_vertex), static_cast<UINT>(quad_count * 2));
+        }
+
+    private:
+        IDirect3DDevice9 *m_device;
+        std::size_t m_capacity;
+        IDirect3DVertexBuffer9 *m_vertex_buffer = nullptr;
+        DWORD m_old_fvf = 0;
+        IDirect3DPixelShader9 *m_old_pixel_shader = nullptr;
+        IDirect3DVertexShader9 *m_old_vertex_shader = nullptr;
+        IDirect3DVertexBuffer9 *m_old_stream = nullptr;
+        UINT m_old_stream_offset = 0;
+        UINT m_old_stream_stride = 0;
+        std::vector<IDirect3DBaseTexture9 *> m_old_textures;
+    };
+    #endif
+}
+
+#endif
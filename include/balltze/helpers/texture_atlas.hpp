@@ -0,0 +1,312 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_API__HELPERS__TEXTURE_ATLAS_HPP
+#define BALLTZE_API__HELPERS__TEXTURE_ATLAS_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+#include "bitmap_codec.hpp"
+
+namespace Balltze::TextureAtlas {
+    using BitmapCodec::Image;
+
+    /**
+     * Rectangle in pixels
+     */
+    struct Rect {
+        std::uint32_t x;
+        std::uint32_t y;
+        std::uint32_t width;
+        std::uint32_t height;
+    };
+
+    /**
+     * Skyline bottom-left rectangle packer
+     */
+    class SkylinePacker {
+    public:
+        SkylinePacker(std::uint32_t width, std::uint32_t height) : m_width(width), m_height(height) {
+            m_skyline.push_back({ 0, 0, width });
+        }
+
+        /**
+         * Find a place for a rectangle
+         * @param width     width of the rectangle
+         * @param height    height of the rectangle
+         * @return          position of the rectangle; std::nullopt if it does not fit
+         */
+        std::optional<Rect> insert(std::uint32_t width, std::uint32_t height) {
+            std::size_t best_index = m_skyline.size();
+            std::uint32_t best_y = std::numeric_limits<std::uint32_t>::max();
+            std::uint32_t best_width = std::numeric_limits<std::uint32_t>::max();
+            for(std::size_t i = 0; i < m_skyline.size(); i++) {
+                auto y = fit(i, width, height);
+                if(y && (*y < best_y || (*y == best_y && m_skyline[i].width < best_width))) {
+                    best_index = i;
+                    best_y = *y;
+                    best_width = m_skyline[i].width;
+                }
+            }
+            if(best_index == m_skyline.size()) {
+                return std::nullopt;
+            }
+
+            Rect rect = { m_skyline[best_index].x, best_y, width, height };
+            add_level(best_index, rect);
+            m_used_area += static_cast<std::uint64_t>(width) * height;
+            return rect;
+        }
+
+        /**
+         * Get the fraction of the area in use
+         */
+        float occupancy() const noexcept {
+            return static_cast<float>(m_used_area) / (static_cast<float>(m_width) * m_height);
+        }
+
+    private:
+        struct Segment {
+            std::uint32_t x;
+            std::uint32_t y;
+            std::uint32_t width;
+        };
+
+        std::uint32_t m_width;
+        std::uint32_t m_height;
+        std::uint64_t m_used_area = 0;
+        std::vector<Segment> m_skyline;
+
+        std::optional<std::uint32_t> fit(std::size_t index, std::uint32_t width, std::uint32_t height) const noexcept {
+            std::uint32_t x = m_skyline[index].x;
+            if(x + width > m_width) {
+                return std::nullopt;
+            }
+            std::uint32_t remaining = width;
+            std::uint32_t y = 0;
+            for(std::size_t i = index; remaining > 0; i++) {
+                y = std::max(y, m_skyline[i].y);
+                if(y + height > m_height) {
+                    return std::nullopt;
+                }
+                remaining -= std::min(remaining, m_skyline[i].width);
+            }
+            return y;
+        }
+
+        void add_level(std::size_t index, Rect const &rect) {
+            m_skyline.insert(m_skyline.begin() + index, { rect.x, rect.y + rect.height, rect.width });
+
+            // Shrink or remove the segments covered by the new one
+            for(std::size_t i = index + 1; i < m_skyline.size(); ) {
+                auto &segment = m_skyline[i];
+                auto &previous = m_skyline[i - 1];
+                std::uint32_t previous_end = previous.x + previous.width;
+                if(segment.x >= previous_end) {
+                    break;
+                }
+                std::uint32_t shrink = previous_end - segment.x;
+                if(segment.width <= shrink) {
+                    m_skyline.erase(m_skyline.begin() + i);
+                    continue;
+                }
+                segment.x += shrink;
+                segment.width -= shrink;
+                break;
+            }
+
+            // Merge neighbors at the same height
+            for(std::size_t i = 1; i < m_skyline.size(); ) {
+                if(m_skyline[i - 1].y == m_skyline[i].y) {
+                    m_skyline[i - 1].width += m_skyline[i].width;
+                    m_skyline.erase(m_skyline.begin() + i);
+                }
+                else {
+                    i++;
+                }
+            }
+        }
+    };
+
+    /**
+     * Location of a sprite in an atlas
+     */
+    struct Entry {
+        /** Page holding the sprite */
+        std::size_t page;
+
+        /** Pixels of the sprite in the page, without padding */
+        Rect rect;
+
+        /** Texture coordinates of the sprite in the page */
+        float left;
+        float right;
+        float top;
+        float bottom;
+    };
+
+    /**
+     * Packed atlas
+     */
+    struct Atlas {
+        std::vector<Image> pages;
+        std::unordered_map<std::uint64_t, Entry> entries;
+
+        /**
+         * Get the location of a sprite
+         * @param key   key the sprite was added with
+         * @return      entry; nullptr if the sprite is not in the atlas
+         */
+        Entry const *find(std::uint64_t key) const noexcept {
+            auto it = entries.find(key);
+            return it != entries.end() ? &it->second : nullptr;
+        }
+    };
+
+    /**
+     * Builds atlas pages out of sprites of many bitmaps. Sprites are packed from the
+     * tallest to the shortest; a new page is started when one fills up. Every sprite is
+     * surrounded by a border that repeats its edge pixels, so filtering does not sample
+     * its neighbors.
+     */
+    class AtlasBuilder {
+    public:
+        /**
+         * @param page_width    width of the pages
+         * @param page_height   height of the pages
+         * @param padding       border around every sprite, in pixels
+         */
+        AtlasBuilder(std::uint32_t page_width = 1024, std::uint32_t page_height = 1024, std::uint32_t padding = 1) : m_page_width(page_width), m_page_height(page_height), m_padding(padding) {}
+
+        /**
+         * Add a sprite
+         * @param key       key to look the sprite up with; must be unique
+         * @param image     bitmap holding the sprite; must outlive build()
+         * @param rect      pixels of the sprite in the bitmap
+         * @throws std::runtime_error if the sprite does not fit in a page or the rect is outside of the image
+         */
+        void add(std::uint64_t key, Image const &image, Rect rect) {
+            if(rect.x + rect.width > image.width || rect.y + rect.height > image.height) {
+                throw std::runtime_error("Sprite is outside of its bitmap");
+            }
+            if(rect.width + m_padding * 2 > m_page_width || rect.height + m_padding * 2 > m_page_height) {
+                throw std::runtime_error("Sprite is larger than an atlas page");
+            }
+            m_sprites.push_back({ key, &image, rect });
+        }
+
+        /**
+         * Add a sprite given by texture coordinates, like a BitmapGroupSprite
+         * @param key       key to look the sprite up with; must be unique
+         * @param image     bitmap holding the sprite; must outlive build()
+         * @param left      left texture coordinate
+         * @param right     right texture coordinate
+         * @param top       top texture coordinate
+         * @param bottom    bottom texture coordinate
+         */
+        void add(std::uint64_t key, Image const &image, float left, float right, float top, float bottom) {
+            auto to_pixels = [](float coordinate, std::uint32_t size) {
+                return static_cast<std::uint32_t>(std::clamp(coordinate * size + 0.5f, 0.0f, static_cast<float>(size)));
+            };
+            std::uint32_t x0 = to_pixels(left, image.width);
+            std::uint32_t x1 = to_pixels(right, image.width);
+            std::uint32_t y0 = to_pixels(top, image.height);
+            std::uint32_t y1 = to_pixels(bottom, image.height);
+            add(key, image, { x0, y0, std::max(x0, x1) - x0, std::max(y0, y1) - y0 });
+        }
+
+        /**
+         * Pack the sprites added so far into pages
+         * @return atlas
+         */
+        Atlas build() const {
+            std::vector<std::size_t> order(m_sprites.size());
+            for(std::size_t i = 0; i < order.size(); i++) {
+                order[i] = i;
+            }
+            std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+                auto const &ra = m_sprites[a].rect;
+                auto const &rb = m_sprites[b].rect;
+                return ra.height != rb.height ? ra.height > rb.height : ra.width > rb.width;
+            });
+
+            Atlas atlas;
+            std::vector<SkylinePacker> packers;
+            for(auto index : order) {
+                auto const &sprite = m_sprites[index];
+                std::uint32_t padded_width = sprite.rect.width + m_padding * 2;
+                std::uint32_t padded_height = sprite.rect.height + m_padding * 2;
+
+                std::optional<Rect> placement;
+                std::size_t page = 0;
+                for(; page < packers.size() && !placement; page++) {
+                    placement = packers[page].insert(padded_width, padded_height);
+                }
+                if(!placement) {
+                    packers.emplace_back(m_page_width, m_page_height);
+                    atlas.pages.emplace_back(m_page_width, m_page_height);
+                    placement = packers.back().insert(padded_width, padded_height);
+                    page = packers.size();
+                }
+                page--;
+
+                Rect rect = { placement->x + m_padding, placement->y + m_padding, sprite.rect.width, sprite.rect.height };
+                blit(*sprite.image, sprite.rect, atlas.pages[page], rect);
+                atlas.entries[sprite.key] = {
+                    page,
+                    rect,
+                    static_cast<float>(rect.x) / m_page_width,
+                    static_cast<float>(rect.x + rect.width) / m_page_width,
+                    static_cast<float>(rect.y) / m_page_height,
+                    static_cast<float>(rect.y + rect.height) / m_page_height
+                };
+            }
+            return atlas;
+        }
+
+        /**
+         * Build a key for a sprite of a bitmap tag
+         * @param bitmap_handle value of the tag handle of the bitmap
+         * @param sequence      sequence index
+         * @param sprite        sprite index
+         */
+        static constexpr std::uint64_t sprite_key(std::uint32_t bitmap_handle, std::uint16_t sequence, std::uint16_t sprite) noexcept {
+            return (static_cast<std::uint64_t>(bitmap_handle) << 32) | (static_cast<std::uint64_t>(sequence) << 16) | sprite;
+        }
+
+    private:
+        struct Sprite {
+            std::uint64_t key;
+            Image const *image;
+            Rect rect;
+        };
+
+        std::uint32_t m_page_width;
+        std::uint32_t m_page_height;
+        std::uint32_t m_padding;
+        std::vector<Sprite> m_sprites;
+
+        void blit(Image const &source, Rect const &source_rect, Image &page, Rect const &rect) const noexcept {
+            if(source_rect.width == 0 || source_rect.height == 0) {
+                return;
+            }
+            std::int64_t padding = m_padding;
+            for(std::int64_t y = -padding; y < static_cast<std::int64_t>(rect.height) + padding; y++) {
+                auto source_y = static_cast<std::uint32_t>(std::clamp<std::int64_t>(y, 0, rect.height - 1)) + source_rect.y;
+                auto *source_row = source.pixels.data() + static_cast<std::size_t>(source_y) * source.width * 4;
+                auto *page_row = page.pixels.data() + static_cast<std::size_t>(rect.y + y) * page.width * 4;
+                for(std::int64_t x = -padding; x < static_cast<std::int64_t>(rect.width) + padding; x++) {
+                    auto source_x = static_cast<std::uint32_t>(std::clamp<std::int64_t>(x, 0, rect.width - 1)) + source_rect.x;
+                    std::memcpy(page_row + (rect.x + x) * 4, source_row + source_x * 4, 4);
+                }
+            }
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,35 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_API__HELPERS__TEXTURE_ATLAS_TAG_HPP
+#define BALLTZE_API__HELPERS__TEXTURE_ATLAS_TAG_HPP
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include "../engine/tag_definitions/bitmap.hpp"
+#include "texture_atlas.hpp"
+
+namespace Balltze::TextureAtlas {
+    /**
+     * Add every sprite of a bitmap tag to an atlas builder
+     * @param builder       atlas builder
+     * @param bitmap_handle value of the tag handle of the bitmap
+     * @param bitmap        bitmap tag data
+     * @param images        decoded base level of each bitmap data of the tag; must outlive build()
+     * @throws std::runtime_error if a sprite references a missing bitmap data
+     */
+    inline void add_bitmap_sprites(AtlasBuilder &builder, std::uint32_t bitmap_handle, Engine::TagDefinitions::Bitmap const &bitmap, std::vector<Image> const &images) {
+        for(std::uint16_t s = 0; s < bitmap.bitmap_group_sequence.count; s++) {
+            auto const &sequence = bitmap.bitmap_group_sequence.offset[s];
+            for(std::uint16_t i = 0; i < sequence.sprites.count; i++) {
+                auto const &sprite = sequence.sprites.offset[i];
+                if(sprite.bitmap_index >= images.size()) {
+                    throw std::runtime_error("Sprite references a missing bitmap");
+                }
+                builder.add(AtlasBuilder::sprite_key(bitmap_handle, s, i), images[sprite.bitmap_index], sprite.left, sprite.right, sprite.top, sprite.bottom);
+            }
+        }
+    }
+}
+
+#endif
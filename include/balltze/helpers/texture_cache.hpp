@@ -0,0 +1,301 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_API__HELPERS__TEXTURE_CACHE_HPP
+#define BALLTZE_API__HELPERS__TEXTURE_CACHE_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+#ifdef _WIN32
+#include "../engine/tag_definitions/bitmap.hpp"
+#include "../engine/tag_definitions/model_collision_geometry.hpp"
+#include "../engine/tag_definitions/object.hpp"
+#include "../engine/tag_definitions/scenario_structure_bsp.hpp"
+#include "../engine/renderer.hpp"
+#include "../engine/tag.hpp"
+#endif
+
+namespace Balltze {
+    /**
+     * Texture residency cache with a byte budget and least recently used eviction.
+     *
+     * Bitmaps are tracked by their texture cache ID and accounted by their pixel data
+     * size. Bitmaps used during the current frame are never evicted, so the budget
+     * may be exceeded temporarily if a single frame needs more than it.
+     *
+     * The loader decides how textures are loaded and released, which keeps the policy
+     * independent of the engine; tools/texture_cache_check.cpp runs it against a mock
+     * loader. Memory is only freed if the loader frees it on unload; see
+     * EngineTextureLoader. It must provide:
+     *   - a BitmapData type with texture_cache_id and pixel_data_size fields
+     *   - Texture load(BitmapData &bitmap, bool immediate)
+     *   - void unload(BitmapData &bitmap, Texture texture)
+     *   - BitmapData *resolve(Resource const &resource), only if clusters are prefetched;
+     *     it returns nullptr for resources that are not bitmaps
+     *
+     * @tparam Loader   loader type
+     */
+    template<typename Loader>
+    class TextureCache {
+    public:
+        using BitmapData = typename Loader::BitmapData;
+        using Texture = decltype(std::declval<Loader &>().load(std::declval<BitmapData &>(), true));
+
+        /**
+         * Cache counters
+         */
+        struct Statistics {
+            std::size_t hits = 0;
+            std::size_t misses = 0;
+            std::size_t prefetches = 0;
+            std::size_t evictions = 0;
+        };
+
+        /**
+         * @param loader    loader to use
+         * @param budget    maximum number of bytes of resident textures
+         */
+        TextureCache(Loader loader, std::size_t budget) : m_loader(std::move(loader)), m_budget(budget) {}
+
+        TextureCache(TextureCache const &) = delete;
+        TextureCache &operator=(TextureCache const &) = delete;
+
+        ~TextureCache() {
+            clear();
+        }
+
+        /**
+         * Start a new frame. Bitmaps used in previous frames become evictable.
+         */
+        void begin_frame() noexcept {
+            m_frame++;
+        }
+
+        /**
+         * Get the texture of a bitmap, loading it if it is not resident
+         * @param bitmap    bitmap to get
+         * @param immediate whether to load the bitmap immediately
+         * @return          texture
+         */
+        Texture get(BitmapData &bitmap, bool immediate = true) {
+            auto it = m_entries.find(bitmap.texture_cache_id);
+            if(it != m_entries.end() && it->second.bitmap == &bitmap) {
+                m_statistics.hits++;
+                auto &entry = it->second;
+                entry.frame = m_frame;
+                m_lru.splice(m_lru.end(), m_lru, entry.position);
+                return entry.texture;
+            }
+            m_statistics.misses++;
+            return insert(bitmap, immediate, true)->texture;
+        }
+
+        /**
+         * Load a bitmap in the background if it is not resident. Prefetching never
+         * evicts bitmaps used during the current frame.
+         * @param bitmap    bitmap to prefetch
+         * @return          whether the bitmap is resident or being loaded
+         */
+        bool prefetch(BitmapData &bitmap) {
+            auto it = m_entries.find(bitmap.texture_cache_id);
+            if(it != m_entries.end() && it->second.bitmap == &bitmap) {
+                return true;
+            }
+            if(!make_room(bitmap.pixel_data_size, false)) {
+                return false;
+            }
+            m_statistics.prefetches++;
+            insert(bitmap, false, false);
+            return true;
+        }
+
+        /**
+         * Prefetch the bitmaps predicted for a BSP cluster
+         * @param cluster   cluster the camera is in or moving to; anything with a predicted_resources reflexive
+         * @return          number of bitmaps resident or being loaded
+         */
+        template<typename Cluster>
+        std::size_t prefetch_cluster(Cluster const &cluster) {
+            std::size_t count = 0;
+            for(std::size_t i = 0; i < cluster.predicted_resources.count; i++) {
+                auto *bitmap = m_loader.resolve(cluster.predicted_resources.offset[i]);
+                if(bitmap && prefetch(*bitmap)) {
+                    count++;
+                }
+            }
+            return count;
+        }
+
+        /**
+         * Release a bitmap
+         * @param bitmap    bitmap to release
+         */
+        void release(BitmapData &bitmap) {
+            auto it = m_entries.find(bitmap.texture_cache_id);
+            if(it != m_entries.end() && it->second.bitmap == &bitmap) {
+                erase(it);
+            }
+        }
+
+        /**
+         * Release every bitmap; should be called before the map is unloaded
+         */
+        void clear() {
+            while(!m_entries.empty()) {
+                erase(m_entries.begin());
+            }
+        }
+
+        /**
+         * Change the budget, evicting bitmaps if needed
+         * @param budget    maximum number of bytes of resident textures
+         */
+        void set_budget(std::size_t budget) {
+            m_budget = budget;
+            make_room(0, true);
+        }
+
+        bool is_resident(BitmapData const &bitmap) const noexcept {
+            auto it = m_entries.find(bitmap.texture_cache_id);
+            return it != m_entries.end() && it->second.bitmap == &bitmap;
+        }
+
+        std::size_t budget() const noexcept {
+            return m_budget;
+        }
+
+        std::size_t resident_bytes() const noexcept {
+            return m_resident_bytes;
+        }
+
+        std::size_t resident_count() const noexcept {
+            return m_entries.size();
+        }
+
+        Statistics const &statistics() const noexcept {
+            return m_statistics;
+        }
+
+        Loader &loader() noexcept {
+            return m_loader;
+        }
+
+    private:
+        struct Entry {
+            BitmapData *bitmap;
+            Texture texture;
+            std::size_t size;
+            std::size_t frame;
+            std::list<std::uint32_t>::iterator position;
+        };
+
+        Loader m_loader;
+        std::size_t m_budget;
+        std::size_t m_resident_bytes = 0;
+        std::size_t m_frame = 0;
+        std::unordered_map<std::uint32_t, Entry> m_entries;
+        std::list<std::uint32_t> m_lru;
+        Statistics m_statistics;
+
+        Entry *insert(BitmapData &bitmap, bool immediate, bool used) {
+            // A different bitmap may have taken over the ID after a map change
+            auto stale = m_entries.find(bitmap.texture_cache_id);
+            if(stale != m_entries.end()) {
+                erase(stale);
+            }
+            make_room(bitmap.pixel_data_size, true);
+
+            auto texture = m_loader.load(bitmap, immediate);
+            auto position = m_lru.insert(m_lru.end(), bitmap.texture_cache_id);
+            auto &entry = m_entries[bitmap.texture_cache_id];
+            entry = { &bitmap, texture, bitmap.pixel_data_size, used ? m_frame : m_frame - 1, position };
+            m_resident_bytes += entry.size;
+            return &entry;
+        }
+
+        void erase(typename std::unordered_map<std::uint32_t, Entry>::iterator it) {
+            auto &entry = it->second;
+            m_loader.unload(*entry.bitmap, entry.texture);
+            m_resident_bytes -= entry.size;
+            m_lru.erase(entry.position);
+            m_entries.erase(it);
+        }
+
+        /**
+         * Evict the least recently used bitmaps until there is room for a new one
+         * @param size      bytes needed
+         * @param force     whether to evict as much as possible even if the room cannot be made
+         * @return          whether there is room
+         */
+        bool make_room(std::size_t size, bool force) {
+            // Check first so a prefetch that cannot fit does not evict anything
+            if(!force) {
+                std::size_t evictable = 0;
+                for(auto id : m_lru) {
+                    if(m_resident_bytes - evictable + size <= m_budget) {
+                        break;
+                    }
+                    auto const &entry = m_entries.find(id)->second;
+                    if(entry.frame != m_frame) {
+                        evictable += entry.size;
+                    }
+                }
+                if(m_resident_bytes - evictable + size > m_budget) {
+                    return false;
+                }
+            }
+            for(auto id = m_lru.begin(); id != m_lru.end() && m_resident_bytes + size > m_budget; ) {
+                auto it = m_entries.find(*id++);
+                if(it->second.frame != m_frame) {
+                    erase(it);
+                    m_statistics.evictions++;
+                }
+            }
+            return m_resident_bytes + size <= m_budget;
+        }
+    };
+
+    #ifdef _WIN32
+    /**
+     * Loader for TextureCache that uses the engine texture cache.
+     *
+     * With this loader the cache only tracks residency; eviction frees nothing. The 
+     * engine texture cache owns the textures it loads and keeps its own reference to 
+     * them, and the API has no way to evict a single texture from it, so unload() is 
+     * a no-op. The budget limits what the cache asks the engine to load and prefetch, 
+     * not the memory the engine keeps.
+     */
+    struct EngineTextureLoader {
+        using BitmapData = Engine::TagDefinitions::BitmapData;
+
+        IDirect3DTexture9 *load(BitmapData &bitmap, bool immediate) {
+            return Engine::load_bitmap(&bitmap, immediate, false);
+        }
+
+        void unload(BitmapData &, IDirect3DTexture9 *) noexcept {}
+
+        BitmapData *resolve(Engine::TagDefinitions::PredictedResource const &resource) {
+            if(resource.type != Engine::TagDefinitions::PREDICTED_RESOURCE_TYPE_BITMAP) {
+                return nullptr;
+            }
+            auto bitmap_data_index = resource.resource_index;
+            auto *tag = Engine::get_tag(resource.tag);
+            if(!tag || tag->primary_class != Engine::TAG_CLASS_BITMAP) {
+                return nullptr;
+            }
+            auto *bitmap = tag->get_data<Engine::TagDefinitions::Bitmap>();
+            if(bitmap_data_index >= bitmap->bitmap_data.count) {
+                return nullptr;
+            }
+            return bitmap->bitmap_data.offset + bitmap_data_index;
+        }
+    };
+
+    using EngineTextureCache = TextureCache<EngineTextureLoader>;
+    #endif
+}
+
+#endif
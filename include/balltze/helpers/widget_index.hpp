@@ -0,0 +1,277 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+#ifndef BALLTZE_API__HELPERS__WIDGET_INDEX_HPP
+#define BALLTZE_API__HELPERS__WIDGET_INDEX_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+#include "../engine/user_interface.hpp"
+#include "../event.hpp"
+
+namespace Balltze {
+    /**
+     * Index of the live widgets by definition tag handle.
+     *
+     * The index is rebuilt with a single walk of the widget tree whenever the tree may
+     * have changed: after the open, close, replace and reload wrappers below, when the
+     * engine switches the root widget or the menu history, and when a map is loaded.
+     * The SDK cannot hook the engine creating or freeing widgets, so the index also
+     * checks itself on lookups: each widget is found again by following the sibling
+     * and child links recorded for it from the current root, which only reads widgets
+     * that are still in the tree; and a lookup that finds nothing walks the tree again,
+     * so widgets the engine created under the same root are found like the engine
+     * search finds them. Code that changes widgets by other means should call invalidate().
+     */
+    class WidgetIndex {
+    public:
+        using Widget = Engine::Widget;
+        using TagHandle = Engine::TagHandle;
+
+        /**
+         * Get the index of the current module
+         */
+        static WidgetIndex &get() {
+            static WidgetIndex index;
+            return index;
+        }
+
+        /**
+         * Find a widget from a given widget definition
+         * @param widget_definition     Widget definition tag handle of the widget to find
+         * @param widget_base           Widget where to look; the root widget if null
+         * @return                      Pointer to widget if found, nullptr if not
+         */
+        Widget *find_widget(TagHandle widget_definition, Widget *widget_base = nullptr) {
+            auto result = find_widgets(widget_definition, true, widget_base);
+            return result.empty() ? nullptr : result[0];
+        }
+
+        /**
+         * Find widgets from a given widget definition
+         * @param widget_definition     Widget definition tag handle of the widget to find
+         * @param first_match           Return only the first widget found
+         * @param widget_base           Widget where to look; the root widget if null
+         * @return                      Widgets in tree order
+         */
+        std::vector<Widget *> find_widgets(TagHandle widget_definition, bool first_match = true, Widget *widget_base = nullptr) {
+            std::vector<Widget *> result;
+            bool rebuilt = false;
+            auto const &matches = widgets(widget_definition, &rebuilt);
+            collect(matches, first_match, widget_base, result);
+            if(result.empty() && !rebuilt) {
+                // The engine may have created the widget without the index noticing
+                rebuild();
+                collect(lookup(widget_definition), first_match, widget_base, result);
+            }
+            return result;
+        }
+
+        /**
+         * Get every live widget of a definition
+         * @param widget_definition     Widget definition tag handle
+         * @param rebuilt               set to whether the tree was walked again for this lookup
+         * @return                      Widgets in tree order; valid until the widget tree changes
+         *
+         * Every widget is found again from the current root before it is returned, and 
+         * the index is rebuilt if one is no longer where it was. The list may miss widgets 
+         * the engine created since the last walk; find_widget() walks again if it finds nothing.
+         */
+        std::vector<Widget *> const &widgets(TagHandle widget_definition, bool *rebuilt = nullptr) {
+            bool walked = refresh();
+            auto it = m_widgets.find(widget_definition.handle);
+            if(!walked && it != m_widgets.end()) {
+                // A rebuilt list comes from a fresh walk of the tree, so it needs no check
+                for(std::size_t i = 0; i < it->second.widgets.size(); i++) {
+                    if(!is_at_path(it->second, i, widget_definition)) {
+                        rebuild();
+                        walked = true;
+                        it = m_widgets.find(widget_definition.handle);
+                        break;
+                    }
+                }
+            }
+            if(rebuilt) {
+                *rebuilt = walked;
+            }
+            return it != m_widgets.end() ? it->second.widgets : m_no_widgets;
+        }
+
+        /**
+         * Open a widget and update the index
+         * @param widget_definition     Tag handle of widget definition
+         * @param push_history          Push or not the current root widget to menu history
+         * @return                      Pointer to the new widget
+         */
+        Widget *open_widget(TagHandle widget_definition, bool push_history = true) noexcept {
+            auto *widget = Engine::open_widget(widget_definition, push_history);
+            invalidate();
+            return widget;
+        }
+
+        /**
+         * Close current root widget and update the index
+         */
+        void close_widget() noexcept {
+            Engine::close_widget();
+            invalidate();
+        }
+
+        /**
+         * Replace a widget and update the index
+         * @param widget                Widget to be replaced
+         * @param widget_definition     Tag handle of the definition for the widget replace
+         * @return                      Pointer to the new widget
+         */
+        Widget *replace_widget(Widget *widget, TagHandle widget_definition) noexcept {
+            auto *new_widget = Engine::replace_widget(widget, widget_definition);
+            invalidate();
+            return new_widget;
+        }
+
+        /**
+         * Reload a widget and update the index
+         * @param widget    Widget to reload
+         * @return          Pointer to the new widget
+         */
+        Widget *reload_widget(Widget *widget) noexcept {
+            auto *new_widget = Engine::reload_widget(widget);
+            invalidate();
+            return new_widget;
+        }
+
+        /**
+         * Rebuild the index on the next lookup
+         */
+        void invalidate() noexcept {
+            m_dirty = true;
+        }
+
+    private:
+        struct Matches {
+            /** Widgets of a definition in tree order */
+            std::vector<Widget *> widgets;
+
+            /** Offset and length in m_paths of the path of each widget */
+            std::vector<std::pair<std::uint32_t, std::uint32_t>> paths;
+        };
+
+        struct Step {
+            Widget *widget;
+            std::uint32_t depth;
+            std::uint32_t sibling;
+        };
+
+        std::unordered_map<std::uint32_t, Matches> m_widgets;
+        std::vector<Widget *> const m_no_widgets;
+
+        /** Sibling index of each widget on the path from the root, for every indexed widget */
+        std::vector<std::uint32_t> m_paths;
+        std::vector<std::uint32_t> m_path;
+        std::vector<Step> m_stack;
+        Widget *m_root = nullptr;
+        Engine::WidgetHistoryEntry *m_history_top = nullptr;
+        bool m_dirty = true;
+        Event::EventListenerHandle<Event::MapLoadEvent> m_map_load_listener;
+
+        WidgetIndex() {
+            m_map_load_listener = Event::MapLoadEvent::subscribe_const([](Event::MapLoadEvent const &) {
+                WidgetIndex::get().invalidate();
+            });
+        }
+
+        static bool is_descendant(Widget *widget, Widget *base) noexcept {
+            for(; widget; widget = widget->parent_widget) {
+                if(widget == base) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        std::vector<Widget *> const &lookup(TagHandle widget_definition) const noexcept {
+            auto it = m_widgets.find(widget_definition.handle);
+            return it != m_widgets.end() ? it->second.widgets : m_no_widgets;
+        }
+
+        static void collect(std::vector<Widget *> const &matches, bool first_match, Widget *widget_base, std::vector<Widget *> &result) {
+            for(auto *widget : matches) {
+                if(!widget_base || is_descendant(widget, widget_base)) {
+                    result.push_back(widget);
+                    if(first_match) {
+                        break;
+                    }
+                }
+            }
+        }
+
+        /**
+         * Check that a widget is still where the last walk found it, following the 
+         * recorded links from the current root. Only widgets reached through those 
+         * links are read, so a widget the engine freed is never dereferenced.
+         */
+        bool is_at_path(Matches const &matches, std::size_t index, TagHandle widget_definition) const noexcept {
+            auto [offset, length] = matches.paths[index];
+            Widget *widget = m_root;
+            for(std::uint32_t level = 0; level < length && widget; level++) {
+                if(level > 0) {
+                    widget = widget->child_widget;
+                }
+                for(std::uint32_t i = 0; i < m_paths[offset + level] && widget; i++) {
+                    widget = widget->next_widget;
+                }
+            }
+            return widget && widget == matches.widgets[index] && widget->definition_tag_handle == widget_definition;
+        }
+
+        /**
+         * Rebuild the index if the tree changed in a way that can be seen without walking it
+         * @return whether it was rebuilt
+         */
+        bool refresh() {
+            auto *globals = Engine::get_widget_globals();
+            if(m_dirty || globals->root_widget != m_root || globals->history_top_entry != m_history_top) {
+                rebuild();
+                return true;
+            }
+            return false;
+        }
+
+        void rebuild() {
+            auto *globals = Engine::get_widget_globals();
+            m_root = globals->root_widget;
+            m_history_top = globals->history_top_entry;
+            m_dirty = false;
+            m_widgets.clear();
+            m_paths.clear();
+
+            // Depth first, children before siblings, like the engine search. Siblings 
+            // share the path of their parent, so only the last entry changes between them.
+            m_stack.clear();
+            if(m_root) {
+                m_stack.push_back({ m_root, 0, 0 });
+            }
+            while(!m_stack.empty()) {
+                auto step = m_stack.back();
+                m_stack.pop_back();
+                m_path.resize(step.depth + 1);
+                m_path[step.depth] = step.sibling;
+
+                auto &matches = m_widgets[step.widget->definition_tag_handle.handle];
+                matches.widgets.push_back(step.widget);
+                matches.paths.emplace_back(static_cast<std::uint32_t>(m_paths.size()), static_cast<std::uint32_t>(m_path.size()));
+                m_paths.insert(m_paths.end(), m_path.begin(), m_path.end());
+
+                if(step.widget->next_widget) {
+                    m_stack.push_back({ step.widget->next_widget, step.depth, step.sibling + 1 });
+                }
+                if(step.widget->child_widget) {
+                    m_stack.push_back({ step.widget->child_widget, step.depth + 1, 0 });
+                }
+            }
+        }
+    };
+}
+
+#endif
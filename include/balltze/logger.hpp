@@ -9,13 +9,681 @@
 #include <filesystem>
 #include <mutex>
 #include <optional>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <memory>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#include <tuple>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
 #include <windows.h>
 #include <fmt/color.h>
 #include <fmt/format.h>
+#include "binary_log.hpp"
 #include "api.hpp"
 #include "utils.hpp"
 
 namespace Balltze {
+    /**
+     * Background sink for loggers in asynchronous mode.
+     * 
+     * Producers push records into a bounded lock-free ring (one sequence number per 
+     * cell, so any number of threads can push) and return immediately. A single 
+     * writer thread formats deferred records and writes them in batches. When the 
+     * ring is full, new records are dropped and counted; the writer reports how 
+     * many were lost. Messages longer than a record are cut and marked as such.
+     * 
+     * shutdown() must be called before the plugin is unloaded. Threads cannot be 
+     * joined while the loader lock is held, so the destructor only tells the writer 
+     * thread to stop and detaches it.
+     */
+    class AsyncLogSink {
+    public:
+        /** Size of a record; longer messages are truncated */
+        static constexpr std::size_t RECORD_SIZE = 512;
+
+        using DeferredFormatter = void (*)(const char *format, const std::byte *arguments, fmt::memory_buffer &output);
+        using DeferredEncoder = void (*)(const std::byte *arguments, fmt::memory_buffer &output);
+
+        /**
+         * Output format of the sink
+         */
+        enum Format {
+            /** Lines of text */
+            FORMAT_TEXT,
+
+            /** Binary log; see binary_log.hpp */
+            FORMAT_BINARY
+        };
+
+        struct RecordHeader {
+            std::chrono::system_clock::time_point time;
+            DeferredFormatter formatter;
+            DeferredEncoder encoder;
+            const char *format;
+            const char *logger_name;
+            std::uint16_t size;
+            std::uint8_t level;
+            bool truncated;
+        };
+
+        struct Record : RecordHeader {
+            std::byte data[RECORD_SIZE - sizeof(RecordHeader)];
+        };
+
+        /**
+         * Start a sink
+         * @param file_path     file to write to
+         * @param append        append to the file instead of truncating it
+         * @param capacity      number of records the ring can hold; rounded up to a power of two
+         * @param echo_console  also write the records to the standard output
+         * @throws std::runtime_error if the file cannot be opened
+         */
+        AsyncLogSink(std::filesystem::path const &file_path, bool append = true, std::size_t capacity = 2048, bool echo_console = true, Format format = FORMAT_TEXT) : m_state(std::make_shared<State>()) {
+            std::size_t size = 1;
+            while(size < capacity) {
+                size <<= 1;
+            }
+            m_state->mask = size - 1;
+            m_state->cells = std::make_unique<Cell[]>(size);
+            for(std::size_t i = 0; i < size; i++) {
+                m_state->cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+            m_state->echo_console = echo_console && format == FORMAT_TEXT;
+            m_state->format = format;
+            m_state->file = _wfopen(file_path.wstring().c_str(), append ? L"ab" : L"wb");
+            if(!m_state->file) {
+                throw std::runtime_error("Failed to open log file " + file_path.string());
+            }
+            if(format == FORMAT_BINARY) {
+                std::fseek(m_state->file, 0, SEEK_END);
+                if(std::ftell(m_state->file) == 0) {
+                    std::fwrite(BinaryLog::MAGIC, 1, sizeof(BinaryLog::MAGIC), m_state->file);
+                }
+            }
+            m_thread = std::thread(&AsyncLogSink::run, m_state);
+        }
+
+        AsyncLogSink(AsyncLogSink const &) = delete;
+        AsyncLogSink &operator=(AsyncLogSink const &) = delete;
+
+        /**
+         * Write every pending record and stop the writer thread. Records pushed after 
+         * this are not written.
+         */
+        void shutdown() {
+            m_state->stop.store(true, std::memory_order_release);
+            if(m_thread.joinable()) {
+                m_thread.join();
+            }
+        }
+
+        /**
+         * Tell the writer thread to stop without waiting for it; see shutdown()
+         */
+        ~AsyncLogSink() {
+            m_state->stop.store(true, std::memory_order_release);
+            if(m_thread.joinable()) {
+                m_thread.detach();
+            }
+        }
+
+        /**
+         * Push a preformatted message
+         * @return false if the message was dropped
+         */
+        bool push(std::uint8_t level, const char *logger_name, std::string_view message) noexcept {
+            return emplace(level, logger_name, [&](Record &record) {
+                std::size_t size = std::min(message.size(), sizeof(record.data));
+                std::memcpy(record.data, message.data(), size);
+                record.size = static_cast<std::uint16_t>(size);
+                record.formatter = nullptr;
+                record.encoder = nullptr;
+                if(size < message.size()) {
+                    record.truncated = true;
+                    m_state->truncated.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+        }
+
+        /**
+         * Push a message to be formatted by the writer thread. Arguments are copied 
+         * by value, so they must be trivially copyable and must not refer to other 
+         * memory: pointers, string views and spans are rejected. The format string 
+         * must outlive the sink. In binary mode, arithmetic and enum arguments are 
+         * stored raw; messages with other arguments are formatted by the writer.
+         * @return false if the message was dropped
+         */
+        template<typename... Args>
+        bool push_deferred(std::uint8_t level, const char *logger_name, fmt::format_string<Args...> format, Args const &...args) noexcept {
+            static_assert((std::is_trivially_copyable_v<Args> && ...), "Deferred log arguments must be trivially copyable");
+            static_assert(!(is_reference_like<Args> || ...), "Deferred log arguments cannot be pointers, string views or spans; what they refer to may be gone when they are formatted");
+            static_assert((sizeof(Args) + ... + 0) <= sizeof(Record::data), "Deferred log arguments are too large");
+            return emplace(level, logger_name, [&](Record &record) {
+                std::size_t offset = 0;
+                ((std::memcpy(record.data + offset, &args, sizeof(Args)), offset += sizeof(Args)), ...);
+                record.size = static_cast<std::uint16_t>(offset);
+                record.format = format.get().data();
+                record.formatter = [](const char *format, const std::byte *data, fmt::memory_buffer &output) {
+                    std::size_t offset = 0;
+                    std::tuple<Args...> arguments { read_argument<Args>(data, offset)... };
+                    std::apply([&](auto const &...args) {
+                        fmt::format_to(std::back_inserter(output), fmt::runtime(format), args...);
+                    }, arguments);
+                };
+                if constexpr((BinaryLog::is_encodable<Args> && ...)) {
+                    record.encoder = [](const std::byte *data, fmt::memory_buffer &output) {
+                        std::size_t offset = 0;
+                        BinaryLog::write_raw<std::uint8_t>(output, sizeof...(Args));
+                        (BinaryLog::write_argument(output, read_argument<Args>(data, offset)), ...);
+                    };
+                }
+                else {
+                    record.encoder = nullptr;
+                }
+            });
+        }
+
+        /**
+         * Get the number of records dropped since the sink was started
+         */
+        std::size_t dropped() const noexcept {
+            return m_state->total_dropped.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * Get the number of messages cut to fit a record since the sink was started
+         */
+        std::size_t truncated() const noexcept {
+            return m_state->truncated.load(std::memory_order_relaxed);
+        }
+
+    private:
+        struct alignas(64) Cell {
+            std::atomic<std::size_t> sequence;
+            Record record;
+        };
+
+        /**
+         * State shared with the writer thread; the thread keeps it alive after the 
+         * sink is destroyed
+         */
+        struct State {
+            std::unique_ptr<Cell[]> cells;
+            std::size_t mask = 0;
+            alignas(64) std::atomic<std::size_t> enqueue_position = 0;
+            alignas(64) std::size_t dequeue_position = 0;
+            std::atomic<std::size_t> dropped = 0;
+            std::atomic<std::size_t> total_dropped = 0;
+            std::atomic<std::size_t> truncated = 0;
+            std::atomic<bool> stop = false;
+            std::FILE *file = nullptr;
+            bool echo_console = false;
+            Format format = FORMAT_TEXT;
+
+            /** IDs of the format strings and logger names already written; only used by the writer */
+            std::unordered_map<const char *, std::uint32_t> format_ids;
+            std::unordered_map<const char *, std::uint32_t> logger_name_ids;
+
+            ~State() {
+                if(file) {
+                    std::fclose(file);
+                }
+            }
+        };
+
+        std::shared_ptr<State> m_state;
+        std::thread m_thread;
+
+        /** Views such as string views and spans, which have a data() pointer */
+        template<typename T, typename = void>
+        struct HasDataPointer : std::false_type {};
+
+        template<typename T>
+        struct HasDataPointer<T, std::void_t<decltype(std::declval<T const &>().data())>> : std::is_pointer<decltype(std::declval<T const &>().data())> {};
+
+        /** Types that refer to memory they do not own */
+        template<typename T>
+        static constexpr bool is_reference_like = std::is_pointer_v<T> || std::is_member_pointer_v<T> || HasDataPointer<T>::value;
+
+        template<typename F>
+        bool emplace(std::uint8_t level, const char *logger_name, F &&fill) noexcept {
+            auto &state = *m_state;
+            std::size_t position = state.enqueue_position.load(std::memory_order_relaxed);
+            Cell *cell;
+            while(true) {
+                cell = &state.cells[position & state.mask];
+                std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+                if(difference == 0) {
+                    if(state.enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                }
+                else if(difference < 0) {
+                    state.dropped.fetch_add(1, std::memory_order_relaxed);
+                    state.total_dropped.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                else {
+                    position = state.enqueue_position.load(std::memory_order_relaxed);
+                }
+            }
+            auto &record = cell->record;
+            record.time = std::chrono::system_clock::now();
+            record.level = level;
+            record.logger_name = logger_name;
+            record.truncated = false;
+            fill(record);
+            cell->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        static Record *front(State &state) noexcept {
+            Cell &cell = state.cells[state.dequeue_position & state.mask];
+            if(cell.sequence.load(std::memory_order_acquire) != state.dequeue_position + 1) {
+                return nullptr;
+            }
+            return &cell.record;
+        }
+
+        static void pop(State &state) noexcept {
+            Cell &cell = state.cells[state.dequeue_position & state.mask];
+            cell.sequence.store(state.dequeue_position + state.mask + 1, std::memory_order_release);
+            state.dequeue_position++;
+        }
+
+        template<typename T>
+        static T read_argument(const std::byte *data, std::size_t &offset) noexcept {
+            T value;
+            std::memcpy(&value, data + offset, sizeof(T));
+            offset += sizeof(T);
+            return value;
+        }
+
+        static const char *level_name(std::uint8_t level) noexcept {
+            static const char *names[] = { "debug", "info", "warning", "error", "fatal" };
+            return level < sizeof(names) / sizeof(names[0]) ? names[level] : "unknown";
+        }
+
+        static void format_message(Record const &record, fmt::memory_buffer &output) {
+            if(record.formatter) {
+                try {
+                    record.formatter(record.format, record.data, output);
+                }
+                catch(fmt::format_error &e) {
+                    fmt::format_to(std::back_inserter(output), "<format error: {}>", e.what());
+                }
+            }
+            else {
+                auto *text = reinterpret_cast<const char *>(record.data);
+                output.append(text, text + record.size);
+                if(record.truncated) {
+                    fmt::format_to(std::back_inserter(output), " <truncated to {} bytes>", record.size);
+                }
+            }
+        }
+
+        static void format_record(Record const &record, fmt::memory_buffer &output) {
+            auto time = std::chrono::system_clock::to_time_t(record.time);
+            std::tm local_time;
+            localtime_s(&local_time, &time);
+            fmt::format_to(std::back_inserter(output), "[{:02}:{:02}:{:02}] [{}] [{}] ", local_time.tm_hour, local_time.tm_min, local_time.tm_sec, record.logger_name, level_name(record.level));
+            format_message(record, output);
+            output.push_back('\n');
+        }
+
+        static std::uint32_t binary_id(std::unordered_map<const char *, std::uint32_t> &ids, BinaryLog::EntryType type, const char *string, fmt::memory_buffer &output) {
+            auto [it, inserted] = ids.try_emplace(string, static_cast<std::uint32_t>(ids.size()));
+            if(inserted) {
+                output.push_back(type);
+                BinaryLog::write_raw(output, it->second);
+                BinaryLog::write_string(output, string);
+            }
+            return it->second;
+        }
+
+        static void encode_record(State &state, Record const &record, fmt::memory_buffer &output) {
+            static constexpr const char *TEXT_FORMAT = "{}";
+            auto logger_id = binary_id(state.logger_name_ids, BinaryLog::ENTRY_LOGGER_NAME, record.logger_name, output);
+            auto format_id = binary_id(state.format_ids, BinaryLog::ENTRY_FORMAT, record.encoder ? record.format : TEXT_FORMAT, output);
+            output.push_back(BinaryLog::ENTRY_RECORD);
+            BinaryLog::write_raw<std::uint64_t>(output, std::chrono::duration_cast<std::chrono::nanoseconds>(record.time.time_since_epoch()).count());
+            BinaryLog::write_raw<std::uint8_t>(output, record.level);
+            BinaryLog::write_raw(output, logger_id);
+            BinaryLog::write_raw(output, format_id);
+            if(record.encoder) {
+                record.encoder(record.data, output);
+                return;
+            }
+
+            fmt::memory_buffer text;
+            format_message(record, text);
+            BinaryLog::write_raw<std::uint8_t>(output, 1);
+            BinaryLog::write_raw(output, BinaryLog::ARGUMENT_STRING);
+            BinaryLog::write_string(output, std::string_view(text.data(), text.size()));
+        }
+
+        static void run(std::shared_ptr<State> state_ptr) {
+            auto &state = *state_ptr;
+            fmt::memory_buffer batch;
+            auto idle_time = std::chrono::microseconds(50);
+            while(true) {
+                bool stopping = state.stop.load(std::memory_order_acquire);
+                batch.clear();
+                while(auto *record = front(state)) {
+                    if(state.format == FORMAT_BINARY) {
+                        encode_record(state, *record, batch);
+                    }
+                    else {
+                        format_record(*record, batch);
+                    }
+                    pop(state);
+                    if(batch.size() > 64 * 1024) {
+                        break;
+                    }
+                }
+                if(auto dropped = state.dropped.exchange(0, std::memory_order_relaxed)) {
+                    if(state.format == FORMAT_BINARY) {
+                        batch.push_back(BinaryLog::ENTRY_DROPPED);
+                        BinaryLog::write_raw<std::uint64_t>(batch, dropped);
+                    }
+                    else {
+                        fmt::format_to(std::back_inserter(batch), "[async logger] {} messages were dropped\n", dropped);
+                    }
+                }
+                if(batch.size() > 0) {
+                    std::fwrite(batch.data(), 1, batch.size(), state.file);
+                    std::fflush(state.file);
+                    if(state.echo_console) {
+                        std::fwrite(batch.data(), 1, batch.size(), stdout);
+                    }
+                    idle_time = std::chrono::microseconds(50);
+                }
+                else if(stopping) {
+                    return;
+                }
+                else {
+                    std::this_thread::sleep_for(idle_time);
+                    idle_time = std::min(idle_time * 2, std::chrono::microseconds(5000));
+                }
+            }
+        }
+    };
+
+    class Logger;
+
+    /**
+     * Asynchronous sinks of the loggers of the current module. Logger is exported by 
+     * the library, so the sink of a logger is kept here and looked up by its address.
+     * 
+     * Sinks are kept in a fixed table of slots. Lookups only use atomics: a lookup 
+     * counts itself as a user of the slot while it holds the sink, and a sink is only 
+     * destroyed once its slot has no users. Call shutdown() from the unload function 
+     * of the plugin; the static registry cannot wait for the writers when it is 
+     * destroyed.
+     */
+    class AsyncLogSinkRegistry {
+    public:
+        /** Maximum number of asynchronous loggers per module */
+        static constexpr std::size_t MAX_SINKS = 32;
+
+        /**
+         * Sink of a logger, with a copy of the name of the logger that outlives its records
+         */
+        struct Entry {
+            std::string logger_name;
+            AsyncLogSink sink;
+
+            template<typename... Args>
+            Entry(std::string name, Args &&...args) : logger_name(std::move(name)), sink(std::forward<Args>(args)...) {}
+        };
+
+    private:
+        struct Slot {
+            std::atomic<Logger const *> logger = nullptr;
+            std::atomic<Entry *> entry = nullptr;
+            std::atomic<std::size_t> users = 0;
+        };
+
+    public:
+        /**
+         * Sink in use; it is not destroyed while the reference exists
+         */
+        class Reference {
+            friend class AsyncLogSinkRegistry;
+
+        public:
+            Reference() noexcept = default;
+            Reference(Reference const &) = delete;
+            Reference &operator=(Reference const &) = delete;
+
+            Reference(Reference &&other) noexcept : m_slot(std::exchange(other.m_slot, nullptr)), m_entry(std::exchange(other.m_entry, nullptr)) {}
+
+            ~Reference() {
+                if(m_slot) {
+                    m_slot->users.fetch_sub(1, std::memory_order_release);
+                }
+            }
+
+            explicit operator bool() const noexcept {
+                return m_entry != nullptr;
+            }
+
+            Entry *operator->() const noexcept {
+                return m_entry;
+            }
+
+            Entry &operator*() const noexcept {
+                return *m_entry;
+            }
+
+        private:
+            Slot *m_slot = nullptr;
+            Entry *m_entry = nullptr;
+
+            Reference(Slot *slot, Entry *entry) noexcept : m_slot(slot), m_entry(entry) {}
+        };
+
+        /**
+         * Get the registry of the current module
+         */
+        static AsyncLogSinkRegistry &get() noexcept {
+            static AsyncLogSinkRegistry registry;
+            return registry;
+        }
+
+        /**
+         * Get the sink of a logger
+         * @param logger    logger
+         * @return          sink of the logger; empty if the logger is synchronous
+         */
+        Reference find(Logger const *logger) noexcept {
+            std::size_t used = m_used_slots.load(std::memory_order_acquire);
+            for(std::size_t i = 0; i < used; i++) {
+                auto &slot = m_slots[i];
+                if(slot.logger.load(std::memory_order_acquire) != logger) {
+                    continue;
+                }
+                slot.users.fetch_add(1, std::memory_order_seq_cst);
+                auto *entry = slot.entry.load(std::memory_order_seq_cst);
+                if(entry && slot.logger.load(std::memory_order_seq_cst) == logger) {
+                    return Reference(&slot, entry);
+                }
+                slot.users.fetch_sub(1, std::memory_order_release);
+            }
+            return {};
+        }
+
+        /**
+         * Set or remove the sink of a logger. The previous sink writes its pending 
+         * records and stops once no thread is using it.
+         * @param logger    logger
+         * @param entry     sink; nullptr to remove it
+         * @throws std::runtime_error if there are too many asynchronous loggers
+         */
+        void set(Logger const *logger, std::unique_ptr<Entry> entry) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::size_t used = m_used_slots.load(std::memory_order_relaxed);
+            Slot *current = nullptr;
+            Slot *free_slot = nullptr;
+            for(std::size_t i = 0; i < used; i++) {
+                auto *key = m_slots[i].logger.load(std::memory_order_relaxed);
+                if(key == logger) {
+                    current = &m_slots[i];
+                }
+                else if(!key && !free_slot) {
+                    free_slot = &m_slots[i];
+                }
+            }
+
+            // The new sink is published before the old one is retired
+            if(entry) {
+                if(!free_slot) {
+                    if(used == MAX_SINKS) {
+                        throw std::runtime_error("Too many asynchronous loggers");
+                    }
+                    free_slot = &m_slots[used];
+                }
+                free_slot->entry.store(entry.release(), std::memory_order_seq_cst);
+                free_slot->logger.store(logger, std::memory_order_seq_cst);
+                if(free_slot == &m_slots[used]) {
+                    m_used_slots.store(used + 1, std::memory_order_release);
+                }
+            }
+            if(current) {
+                if(auto *previous = retire(*current)) {
+                    previous->sink.shutdown();
+                    delete previous;
+                }
+            }
+        }
+
+        /**
+         * Stop every sink, writing their pending records. Call it from the unload 
+         * function of the plugin.
+         */
+        void shutdown() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::size_t used = m_used_slots.load(std::memory_order_relaxed);
+            for(std::size_t i = 0; i < used; i++) {
+                if(auto *entry = retire(m_slots[i])) {
+                    entry->sink.shutdown();
+                    delete entry;
+                }
+            }
+        }
+
+        ~AsyncLogSinkRegistry() {
+            for(auto &slot : m_slots) {
+                delete slot.entry.load(std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        Slot m_slots[MAX_SINKS];
+        std::atomic<std::size_t> m_used_slots = 0;
+        std::mutex m_mutex;
+
+        AsyncLogSinkRegistry() = default;
+
+        /**
+         * Unpublish the sink of a slot and wait until nobody is using it
+         * @return sink of the slot
+         */
+        static Entry *retire(Slot &slot) noexcept {
+            auto *entry = slot.entry.exchange(nullptr, std::memory_order_seq_cst);
+            while(slot.users.load(std::memory_order_seq_cst) != 0) {
+                std::this_thread::yield();
+            }
+            slot.logger.store(nullptr, std::memory_order_seq_cst);
+            return entry;
+        }
+    };
+
+    /**
+     * State of a rate limited log call site. Declare it static at the call site, 
+     * or use the BALLTZE_LOG_SAMPLED and BALLTZE_LOG_RATE_LIMITED macros.
+     * 
+     * Messages pass if they are among the first `first` messages of the site, or 
+     * every `every`th message after that, and if fewer than `per_second` messages 
+     * of the site have passed within the current second. The check only touches 
+     * the atomic counters of the site.
+     */
+    class LogSite {
+    public:
+        /**
+         * Create a log site
+         * @param first         number of messages that always pass
+         * @param every         after the first ones, let one of every this many messages pass; 0 drops them all
+         * @param per_second    maximum number of messages per second; 0 for no limit
+         */
+        constexpr LogSite(std::uint32_t first, std::uint32_t every = 0, std::uint32_t per_second = 0) noexcept : m_first(first), m_every(every), m_per_second(per_second) {}
+
+        /**
+         * Check if a message should be logged
+         * @param suppressed    set to the number of messages suppressed since the last one that passed
+         * @return              true if the message should be logged
+         */
+        bool should_log(std::uint32_t &suppressed) noexcept {
+            auto count = m_count.fetch_add(1, std::memory_order_relaxed);
+            bool sampled = count < m_first || (m_every != 0 && (count - m_first) % m_every == 0);
+            if(!sampled || !take_rate_token()) {
+                m_suppressed.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            suppressed = m_suppressed.exchange(0, std::memory_order_relaxed);
+            return true;
+        }
+
+        /**
+         * Get the number of messages suppressed since the last one that passed
+         */
+        std::uint32_t suppressed() const noexcept {
+            return m_suppressed.load(std::memory_order_relaxed);
+        }
+
+    private:
+        const std::uint32_t m_first;
+        const std::uint32_t m_every;
+        const std::uint32_t m_per_second;
+        std::atomic<std::uint32_t> m_count = 0;
+        std::atomic<std::uint32_t> m_suppressed = 0;
+
+        /** Current second in the high half, messages passed within it in the low half */
+        std::atomic<std::uint64_t> m_window = 0;
+
+        bool take_rate_token() noexcept {
+            if(m_per_second == 0) {
+                return true;
+            }
+            auto now = std::chrono::steady_clock::now().time_since_epoch();
+            auto second = static_cast<std::uint32_t>(std::chrono::duration_cast<std::chrono::seconds>(now).count());
+            auto window = m_window.load(std::memory_order_relaxed);
+            while(true) {
+                std::uint64_t next;
+                if(static_cast<std::uint32_t>(window >> 32) != second) {
+                    next = (static_cast<std::uint64_t>(second) << 32) | 1;
+                }
+                else if(static_cast<std::uint32_t>(window) < m_per_second) {
+                    next = window + 1;
+                }
+                else {
+                    return false;
+                }
+                if(m_window.compare_exchange_weak(window, next, std::memory_order_relaxed)) {
+                    return true;
+                }
+            }
+        }
+    };
+
     /**
      * A logger class that can be used to log messages to the console, a file and the in-game console.
      * 
@@ -59,15 +727,82 @@ namespace Balltze {
                 return *this;
             }
 
+            /**
+             * Log a message as is
+             * @param message message to log
+             */
+            void operator()(const char *message) {
+                write(message);
+            }
+
+            /**
+             * Log a message with a format string checked at compile time
+             * @param format format string
+             * @param args   format arguments
+             */
             template<typename ...Args>
-            void operator()(std::string format, Args &&...args) {
+            void operator()(fmt::format_string<Args...> format, Args &&...args) {
+                auto &buffer = format_buffer();
+                buffer.clear();
+                fmt::format_to(std::back_inserter(buffer), format, std::forward<Args>(args)...);
+                write(std::string_view(buffer.data(), buffer.size()));
+            }
+
+            /**
+             * Log a message with a format string known only at runtime
+             * @param format format string; if no arguments are given, it is logged as is
+             * @param args   format arguments
+             */
+            template<typename S, typename ...Args, std::enable_if_t<!std::is_array_v<S> && (std::is_same_v<std::decay_t<S>, std::string> || std::is_same_v<std::decay_t<S>, std::string_view> || std::is_same_v<std::decay_t<S>, const char *> || std::is_same_v<std::decay_t<S>, char *>), int> = 0>
+            void operator()(S const &format, Args &&...args) {
                 if constexpr (sizeof...(args) == 0) {
-                    *this << format << endl;
+                    write(format);
                 } 
                 else {
-                    std::string output = fmt::format(fmt::runtime(format), args...);
-                    *this << output << endl;
+                    auto &buffer = format_buffer();
+                    buffer.clear();
+                    fmt::vformat_to(std::back_inserter(buffer), fmt::string_view(format), fmt::make_format_args(args...));
+                    write(std::string_view(buffer.data(), buffer.size()));
+                }
+            }
+
+            /**
+             * Log a message if the rate limits of its call site allow it. The first message 
+             * after others were suppressed says how many were.
+             * @param site   state of the call site
+             * @param format format string
+             * @param args   format arguments
+             */
+            template<typename ...Args>
+            void sampled(LogSite &site, fmt::format_string<Args...> format, Args &&...args) {
+                std::uint32_t suppressed;
+                if(!site.should_log(suppressed)) {
+                    return;
+                }
+                auto &buffer = format_buffer();
+                buffer.clear();
+                fmt::format_to(std::back_inserter(buffer), format, std::forward<Args>(args)...);
+                if(suppressed > 0) {
+                    fmt::format_to(std::back_inserter(buffer), " ({} similar messages suppressed)", suppressed);
+                }
+                write(std::string_view(buffer.data(), buffer.size()));
+            }
+
+        private:
+            static fmt::memory_buffer &format_buffer() noexcept {
+                thread_local fmt::memory_buffer buffer;
+                return buffer;
+            }
+
+            void write(std::string_view message) {
+                if(auto entry = AsyncLogSinkRegistry::get().find(m_logger)) {
+                    if(m_level != LOG_LEVEL_DEBUG || !m_logger->m_mute_debug) {
+                        entry->sink.push(m_level, entry->logger_name.c_str(), message);
+                    }
+                    return;
                 }
+                m_stream.write(message.data(), static_cast<std::streamsize>(message.size()));
+                endl(*this);
             }
         };
 
@@ -104,8 +839,82 @@ namespace Balltze {
             }
         }
         
+        /**
+         * Log a message without formatting it on the calling thread. If the logger is 
+         * not in asynchronous mode, the message is formatted and logged right away.
+         * @param level     level of the message
+         * @param format    format string; must be a literal
+         * @param args      trivially copyable arguments
+         */
+        template<typename... Args>
+        void log_deferred(LogLevel level, fmt::format_string<Args...> format, Args const &...args) noexcept {
+            if(level == LOG_LEVEL_DEBUG && m_mute_debug) {
+                return;
+            }
+            if(auto entry = AsyncLogSinkRegistry::get().find(this)) {
+                entry->sink.push_deferred(level, entry->logger_name.c_str(), format, args...);
+                return;
+            }
+            try {
+                auto format_string = format.get();
+                stream(level)(std::string_view(format_string.data(), format_string.size()), args...);
+            }
+            catch(...) {
+                // Deferred logging does not throw; a failed synchronous write is lost like a dropped record
+            }
+        }
+
+        /**
+         * Enable asynchronous mode. Messages are written to the file and the standard 
+         * output by a background thread; they are not shown in the in-game console.
+         * @param file_path     file to write to
+         * @param append        append to the file instead of truncating it
+         * @param capacity      number of messages that can be pending before new ones are dropped
+         * @throws std::runtime_error if the file cannot be opened
+         */
+        void enable_async(std::filesystem::path const &file_path, bool append = true, std::size_t capacity = 2048) {
+            AsyncLogSinkRegistry::get().set(this, std::make_unique<AsyncLogSinkRegistry::Entry>(m_name, file_path, append, capacity));
+        }
+
+        /**
+         * Enable binary mode. Like asynchronous mode, but messages are written to a 
+         * binary log (see binary_log.hpp) with their arguments unformatted; messages 
+         * logged with log_deferred() cost little more than copying their arguments.
+         * @param file_path     file to write to
+         * @param append        append to the file instead of truncating it
+         * @param capacity      number of messages that can be pending before new ones are dropped
+         * @throws std::runtime_error if the file cannot be opened
+         */
+        void enable_binary(std::filesystem::path const &file_path, bool append = true, std::size_t capacity = 2048) {
+            AsyncLogSinkRegistry::get().set(this, std::make_unique<AsyncLogSinkRegistry::Entry>(m_name, file_path, append, capacity, false, AsyncLogSink::FORMAT_BINARY));
+        }
+
+        /**
+         * Disable asynchronous mode, writing every pending message. Call it before 
+         * the logger is destroyed and from the unload function of the plugin; the 
+         * writer thread cannot be waited for later.
+         */
+        void disable_async() {
+            AsyncLogSinkRegistry::get().set(this, nullptr);
+        }
+
+        /**
+         * Get the asynchronous sink; empty if the logger is synchronous
+         */
+        AsyncLogSinkRegistry::Reference async_sink() const {
+            return AsyncLogSinkRegistry::get().find(this);
+        }
+
         inline static void endl(LoggerStream &ls) {
             try {
+                if(auto entry = AsyncLogSinkRegistry::get().find(ls.m_logger)) {
+                    if(ls.m_level != LOG_LEVEL_DEBUG || !ls.m_logger->m_mute_debug) {
+                        entry->sink.push(ls.m_level, entry->logger_name.c_str(), ls.m_stream.str());
+                    }
+                    ls.m_stream.str("");
+                    ls.m_stream.clear();
+                    return;
+                }
                 endl_impl(get_current_module(), ls);
             }
             catch(...) {
@@ -124,6 +933,21 @@ namespace Balltze {
 
         void set_file_impl(HMODULE module, std::filesystem::path file_path, bool append);
 
+        LoggerStream &stream(LogLevel level) noexcept {
+            switch(level) {
+                case LOG_LEVEL_DEBUG:
+                    return debug;
+                case LOG_LEVEL_INFO:
+                    return info;
+                case LOG_LEVEL_WARNING:
+                    return warning;
+                case LOG_LEVEL_ERROR:
+                    return error;
+                default:
+                    return fatal;
+            }
+        }
+
         static void endl_impl(HMODULE module, LoggerStream &stream);
         static void print_console(LoggerStream &stream);
         static void print_file(LoggerStream &stream);
@@ -131,4 +955,27 @@ namespace Balltze {
     };
 }
 
+/**
+ * Log the first messages of a call site, then one of every few
+ * @param stream     logger stream (e.g. logger.error)
+ * @param first      number of messages that always pass
+ * @param every      after the first ones, let one of every this many messages pass
+ * @param ...        format string and arguments
+ */
+#define BALLTZE_LOG_SAMPLED(stream, first, every, ...) do { \
+    static Balltze::LogSite balltze_log_site_(first, every); \
+    (stream).sampled(balltze_log_site_, __VA_ARGS__); \
+} while(0)
+
+/**
+ * Log at most a number of messages per second from a call site
+ * @param stream     logger stream (e.g. logger.error)
+ * @param per_second maximum number of messages per second
+ * @param ...        format string and arguments
+ */
+#define BALLTZE_LOG_RATE_LIMITED(stream, per_second, ...) do { \
+    static Balltze::LogSite balltze_log_site_(0xFFFFFFFF, 0, per_second); \
+    (stream).sampled(balltze_log_site_, __VA_ARGS__); \
+} while(0)
+
 #endif
@@ -6,7 +6,17 @@
 #include <filesystem>
 #include <chrono>
 #include <variant>
+#include <vector>
+#include <memory>
+#include <array>
+#include <unordered_map>
+#include <algorithm>
+#include <string>
+#include <string_view>
 #include "engine/data_types.hpp"
+#include "engine/tag.hpp"
+#include "engine/tag_definitions/font.hpp"
+#include "events/map_load.hpp"
 #include "api.hpp"
 
 namespace Balltze {
@@ -84,6 +94,301 @@ namespace Balltze {
      */
     BALLTZE_API std::int16_t get_font_pixel_height(const std::variant<Engine::TagHandle, GenericFont> &font) noexcept;
 
+    /**
+     * Glyph metrics of a font tag, flattened so measuring text is a table lookup per character.
+     */
+    class FontMetrics {
+    public:
+        /**
+         * Build the metrics of a font
+         * @param font  font tag data
+         */
+        FontMetrics(Engine::TagDefinitions::Font const &font) : m_widths(0x10000, 0) {
+            m_height = font.ascending_height + font.descending_height;
+            auto const &characters = font.characters;
+            auto const &tables = font.character_tables;
+            for(std::size_t high = 0; high < tables.count && high < 0x100; high++) {
+                auto const &table = tables.offset[high].character_table;
+                for(std::size_t low = 0; low < table.count && low < 0x100; low++) {
+                    auto index = table.offset[low].character_index;
+                    if(index < characters.count) {
+                        m_widths[(high << 8) | low] = characters.offset[index].character_width;
+                    }
+                }
+            }
+        }
+
+        /**
+         * Get the width of a character
+         * @param character UTF-16 code unit
+         */
+        std::int16_t width(std::uint16_t character) const noexcept {
+            return m_widths[character];
+        }
+
+        /**
+         * Get the height of the font
+         */
+        std::int16_t height() const noexcept {
+            return m_height;
+        }
+
+        /**
+         * Measure a string; color codes (^ followed by a character) take no space
+         * @param text      text to measure
+         * @param length    length of the text in code units
+         * @return          length in pixels
+         */
+        template<typename CharT>
+        std::int32_t measure(const CharT *text, std::size_t length) const noexcept {
+            std::int32_t total = 0;
+            std::size_t start = 0;
+            for(std::size_t i = 0; i < length; i++) {
+                if(text[i] == '^') {
+                    total += sum(text + start, i - start);
+                    i++;
+                    start = i + 1;
+                }
+            }
+            if(start < length) {
+                total += sum(text + start, length - start);
+            }
+            return total;
+        }
+
+    private:
+        std::vector<std::int16_t> m_widths;
+        std::int16_t m_height;
+
+        template<typename CharT>
+        std::int32_t sum(const CharT *text, std::size_t length) const noexcept {
+            // Plain loop over a flat table; compilers vectorize it
+            std::int32_t total = 0;
+            auto const *widths = m_widths.data();
+            for(std::size_t i = 0; i < length; i++) {
+                total += widths[static_cast<std::make_unsigned_t<CharT>>(text[i])];
+            }
+            return total;
+        }
+    };
+
+    /**
+     * Cache of font metrics and of the length of recently measured strings. 
+     * It is cleared when a map is loaded. Use it from the game thread.
+     */
+    class FontMetricsCache {
+    public:
+        /** Number of measured strings remembered */
+        static constexpr std::size_t LRU_CAPACITY = 256;
+
+        /**
+         * Get the cache of the current module
+         */
+        static FontMetricsCache &get() {
+            static FontMetricsCache cache;
+            return cache;
+        }
+
+        /**
+         * Get the metrics of a font
+         * @param font  font tag or generic font
+         * @return      pointer to the metrics; nullptr if the font tag is not loaded
+         */
+        FontMetrics const *metrics(std::variant<Engine::TagHandle, GenericFont> const &font) {
+            auto handle = std::holds_alternative<GenericFont>(font) ? get_generic_font(std::get<GenericFont>(font)) : std::get<Engine::TagHandle>(font);
+            if(handle.is_null()) {
+                return nullptr;
+            }
+            auto it = m_fonts.find(handle.handle);
+            if(it != m_fonts.end()) {
+                return it->second.get();
+            }
+            auto *tag = Engine::get_tag(handle);
+            if(!tag || tag->primary_class != Engine::TAG_CLASS_FONT) {
+                return nullptr;
+            }
+            auto metrics = std::make_unique<FontMetrics>(*tag->get_data<Engine::TagDefinitions::Font>());
+            return m_fonts.emplace(handle.handle, std::move(metrics)).first->second.get();
+        }
+
+        /**
+         * Get the number of pixels a string takes up given a font.
+         * @param  text the text to measure
+         * @param  font the font
+         * @return      the length in pixels
+         */
+        template<typename CharT>
+        std::int16_t text_pixel_length(const CharT *text, std::variant<Engine::TagHandle, GenericFont> const &font) {
+            auto *font_metrics = metrics(font);
+            if(!font_metrics) {
+                return 0;
+            }
+
+            std::size_t length = 0;
+            std::uint64_t hash = 14695981039346656037ull;
+            for(; text[length]; length++) {
+                hash = (hash ^ static_cast<std::make_unsigned_t<CharT>>(text[length])) * 1099511628211ull;
+            }
+            hash ^= reinterpret_cast<std::uintptr_t>(font_metrics) * 0x9E3779B97F4A7C15ull;
+            hash ^= sizeof(CharT);
+
+            std::string_view key(reinterpret_cast<const char *>(text), length * sizeof(CharT));
+            if(auto *entry = lru_find(hash, font_metrics, sizeof(CharT), key)) {
+                return entry->pixel_length;
+            }
+            auto pixel_length = static_cast<std::int16_t>(font_metrics->measure(text, length));
+            lru_insert(hash, font_metrics, sizeof(CharT), key, pixel_length);
+            return pixel_length;
+        }
+
+        /**
+         * Forget every font and measured string
+         */
+        void clear() noexcept {
+            m_fonts.clear();
+            m_slots.fill(EMPTY);
+            m_size = 0;
+            m_head = EMPTY;
+            m_tail = EMPTY;
+        }
+
+    private:
+        static constexpr std::uint16_t EMPTY = 0xFFFF;
+
+        struct Entry {
+            std::uint64_t hash;
+
+            /** Bytes of the string; compared on every hit, since different strings can share a hash */
+            std::string text;
+            FontMetrics const *font;
+            std::uint8_t char_size;
+            std::int16_t pixel_length;
+            std::uint16_t previous;
+            std::uint16_t next;
+            std::uint16_t slot;
+        };
+
+        std::unordered_map<std::uint32_t, std::unique_ptr<FontMetrics>> m_fonts;
+
+        /** Strings measured, linked from most to least recently used */
+        std::array<Entry, LRU_CAPACITY> m_entries;
+        std::size_t m_size = 0;
+        std::uint16_t m_head = EMPTY;
+        std::uint16_t m_tail = EMPTY;
+
+        /** Hash table of indices into m_entries, with linear probing */
+        std::array<std::uint16_t, LRU_CAPACITY * 2> m_slots;
+
+        Event::EventListenerHandle<Event::MapLoadEvent> m_map_load_listener;
+
+        FontMetricsCache() {
+            m_slots.fill(EMPTY);
+            m_map_load_listener = Event::MapLoadEvent::subscribe_const([](Event::MapLoadEvent const &event) {
+                if(event.time == Event::EVENT_TIME_BEFORE) {
+                    FontMetricsCache::get().clear();
+                }
+            });
+        }
+
+        void lru_unlink(std::uint16_t index) noexcept {
+            auto &entry = m_entries[index];
+            if(entry.previous != EMPTY) {
+                m_entries[entry.previous].next = entry.next;
+            }
+            else {
+                m_head = entry.next;
+            }
+            if(entry.next != EMPTY) {
+                m_entries[entry.next].previous = entry.previous;
+            }
+            else {
+                m_tail = entry.previous;
+            }
+        }
+
+        void lru_push_front(std::uint16_t index) noexcept {
+            auto &entry = m_entries[index];
+            entry.previous = EMPTY;
+            entry.next = m_head;
+            if(m_head != EMPTY) {
+                m_entries[m_head].previous = index;
+            }
+            m_head = index;
+            if(m_tail == EMPTY) {
+                m_tail = index;
+            }
+        }
+
+        Entry *lru_find(std::uint64_t hash, FontMetrics const *font, std::uint8_t char_size, std::string_view text) noexcept {
+            std::size_t mask = m_slots.size() - 1;
+            for(std::size_t i = hash & mask; m_slots[i] != EMPTY; i = (i + 1) & mask) {
+                auto index = m_slots[i];
+                auto &entry = m_entries[index];
+                if(entry.hash == hash && entry.font == font && entry.char_size == char_size && entry.text == text) {
+                    if(m_head != index) {
+                        lru_unlink(index);
+                        lru_push_front(index);
+                    }
+                    return &entry;
+                }
+            }
+            return nullptr;
+        }
+
+        void slot_erase(std::size_t slot) noexcept {
+            // Backward shift deletion keeps probe sequences intact without tombstones
+            std::size_t mask = m_slots.size() - 1;
+            std::size_t hole = slot;
+            for(std::size_t i = (slot + 1) & mask; m_slots[i] != EMPTY; i = (i + 1) & mask) {
+                std::size_t home = m_entries[m_slots[i]].hash & mask;
+                if(((i - home) & mask) >= ((i - hole) & mask)) {
+                    m_slots[hole] = m_slots[i];
+                    m_entries[m_slots[hole]].slot = static_cast<std::uint16_t>(hole);
+                    hole = i;
+                }
+            }
+            m_slots[hole] = EMPTY;
+        }
+
+        void lru_insert(std::uint64_t hash, FontMetrics const *font, std::uint8_t char_size, std::string_view text, std::int16_t pixel_length) {
+            std::uint16_t index;
+            if(m_size < LRU_CAPACITY) {
+                index = static_cast<std::uint16_t>(m_size++);
+            }
+            else {
+                index = m_tail;
+                lru_unlink(index);
+                slot_erase(m_entries[index].slot);
+            }
+            std::size_t mask = m_slots.size() - 1;
+            std::size_t slot = hash & mask;
+            while(m_slots[slot] != EMPTY) {
+                slot = (slot + 1) & mask;
+            }
+            m_slots[slot] = index;
+            auto &entry = m_entries[index];
+            entry.hash = hash;
+            entry.text.assign(text);
+            entry.font = font;
+            entry.char_size = char_size;
+            entry.pixel_length = pixel_length;
+            entry.slot = static_cast<std::uint16_t>(slot);
+            lru_push_front(index);
+        }
+    };
+
+    /**
+     * Get the number of pixels a string takes up given a font, using the font 
+     * metrics cache. Repeated strings cost a hash lookup and a comparison.
+     * @param  text the text to measure
+     * @param  font the font
+     * @return      the length in pixels
+     */
+    template<typename CharT>
+    inline std::int16_t get_text_pixel_length_cached(const CharT *text, std::variant<Engine::TagHandle, GenericFont> const &font) {
+        return FontMetricsCache::get().text_pixel_length(text, font);
+    }
+
     /**
      * Display text on the screen for one frame.
      * @param text      text to display
@@ -99,6 +404,250 @@ namespace Balltze {
      */
     BALLTZE_API void apply_text(std::variant<std::string, std::wstring> text, std::int16_t x, std::int16_t y, std::int16_t width, std::int16_t height, const Engine::ColorARGB &color, const std::variant<Engine::TagHandle, GenericFont> &font, FontAlignment alignment, TextAnchor anchor, bool immediate = false) noexcept;
 
+    /**
+     * Text laid out once and drawn every frame. Line breaks and line positions are 
+     * computed when the text, font or box change; drawing only submits the lines.
+     */
+    class TextLayout {
+    public:
+        using Text = std::variant<std::string, std::wstring>;
+
+        /**
+         * A laid out line
+         */
+        struct Line {
+            /** Text of the line, starting with the color code in effect */
+            Text text;
+
+            /** Width of the line in pixels */
+            std::int16_t width;
+
+            /** Horizontal offset of the line within the box, according to the alignment */
+            std::int16_t x;
+
+            /** Vertical offset of the line from the anchor */
+            std::int16_t y;
+        };
+
+        /**
+         * Create a text layout
+         * @param text      text to display; newlines break lines
+         * @param x         pixels for left side
+         * @param y         pixels for top side
+         * @param width     width of textbox; lines longer than this are wrapped
+         * @param height    height of textbox; lines that do not fit are not drawn
+         * @param font      font to use; can be a generic font type or a specific font tag
+         * @param alignment alignment to use
+         * @param anchor    anchor to use
+         */
+        TextLayout(Text text, std::int16_t x, std::int16_t y, std::int16_t width, std::int16_t height, std::variant<Engine::TagHandle, GenericFont> font, FontAlignment alignment, TextAnchor anchor) : m_text(std::move(text)), m_x(x), m_y(y), m_width(width), m_height(height), m_font(font), m_alignment(alignment), m_anchor(anchor) {}
+
+        void set_text(Text text) {
+            if(text != m_text) {
+                m_text = std::move(text);
+                m_dirty = true;
+            }
+        }
+
+        void set_font(std::variant<Engine::TagHandle, GenericFont> font) noexcept {
+            if(font != m_font) {
+                m_font = font;
+                m_dirty = true;
+            }
+        }
+
+        void set_box(std::int16_t x, std::int16_t y, std::int16_t width, std::int16_t height) noexcept {
+            if(x != m_x || y != m_y || width != m_width || height != m_height) {
+                m_x = x;
+                m_y = y;
+                m_width = width;
+                m_height = height;
+                m_dirty = true;
+            }
+        }
+
+        void set_alignment(FontAlignment alignment, TextAnchor anchor) noexcept {
+            if(alignment != m_alignment || anchor != m_anchor) {
+                m_alignment = alignment;
+                m_anchor = anchor;
+                m_dirty = true;
+            }
+        }
+
+        /**
+         * Mark the layout as outdated, e.g. after the font tag was reloaded
+         */
+        void invalidate() noexcept {
+            m_dirty = true;
+        }
+
+        /**
+         * Get the laid out lines, laying the text out if needed
+         */
+        std::vector<Line> const &lines() {
+            if(m_dirty) {
+                layout();
+            }
+            return m_lines;
+        }
+
+        /**
+         * Pass every laid out line to a function, laying the text out if needed. Lines 
+         * are passed by reference, so renderers other than apply_text() can draw the 
+         * layout every frame without copying it.
+         * @param function  function called as function(text, x, y, width, height) with screen coordinates
+         */
+        template<typename Function>
+        void for_each_line(Function &&function) {
+            for(auto const &line : lines()) {
+                function(line.text, static_cast<std::int16_t>(m_x + line.x), static_cast<std::int16_t>(m_y + line.y), line.width, m_line_height);
+            }
+        }
+
+        /**
+         * Display the text on the screen for one frame. apply_text() takes its text by 
+         * value, so each line is copied once per call; nothing is laid out or measured.
+         * @param color     color to use
+         * @param immediate attempt to render it immediately
+         */
+        void draw(Engine::ColorARGB const &color, bool immediate = false) {
+            for_each_line([&](Text const &text, std::int16_t x, std::int16_t y, std::int16_t width, std::int16_t height) {
+                apply_text(text, x, y, width, height, color, m_font, ALIGN_LEFT, m_anchor, immediate);
+            });
+        }
+
+    private:
+        Text m_text;
+        std::int16_t m_x;
+        std::int16_t m_y;
+        std::int16_t m_width;
+        std::int16_t m_height;
+        std::variant<Engine::TagHandle, GenericFont> m_font;
+        FontAlignment m_alignment;
+        TextAnchor m_anchor;
+        std::int16_t m_line_height = 0;
+        std::vector<Line> m_lines;
+        bool m_dirty = true;
+
+        void layout() {
+            m_lines.clear();
+            m_dirty = false;
+            auto *metrics = FontMetricsCache::get().metrics(m_font);
+            if(!metrics) {
+                return;
+            }
+            m_line_height = metrics->height();
+            std::visit([&](auto const &text) {
+                break_lines(text, *metrics);
+            }, m_text);
+
+            // Drop the lines that do not fit, then place them
+            std::size_t max_lines = m_line_height > 0 ? std::max(1, m_height / m_line_height) : m_lines.size();
+            if(m_lines.size() > max_lines) {
+                m_lines.resize(max_lines);
+            }
+            auto count = static_cast<std::int16_t>(m_lines.size());
+            for(std::int16_t i = 0; i < count; i++) {
+                auto &line = m_lines[i];
+                switch(m_alignment) {
+                    case ALIGN_RIGHT:
+                        line.x = m_width - line.width;
+                        break;
+                    case ALIGN_CENTER:
+                        line.x = (m_width - line.width) / 2;
+                        break;
+                    default:
+                        line.x = 0;
+                        break;
+                }
+                switch(m_anchor) {
+                    case ANCHOR_BOTTOM_LEFT:
+                    case ANCHOR_BOTTOM_RIGHT:
+                        line.y = (count - 1 - i) * m_line_height;
+                        break;
+                    case ANCHOR_CENTER:
+                        line.y = i * m_line_height - (count * m_line_height) / 2;
+                        break;
+                    default:
+                        line.y = i * m_line_height;
+                        break;
+                }
+            }
+        }
+
+        template<typename String>
+        void break_lines(String const &text, FontMetrics const &metrics) {
+            using CharT = typename String::value_type;
+            String line;
+            String color;
+            String color_at_space;
+            std::int32_t line_width = 0;
+            std::size_t last_space = String::npos;
+            std::int32_t width_at_space = 0;
+
+            auto push_line = [&](String const &line_text, std::int32_t width) {
+                m_lines.push_back({ Text(line_text), static_cast<std::int16_t>(width), 0, 0 });
+            };
+
+            for(std::size_t i = 0; i < text.size(); i++) {
+                CharT c = text[i];
+                if(c == '\n') {
+                    push_line(line, line_width);
+                    line = color;
+                    line_width = 0;
+                    last_space = String::npos;
+                    continue;
+                }
+                if(c == '^' && i + 1 < text.size()) {
+                    color = text.substr(i, 2);
+                    line += color;
+                    i++;
+                    continue;
+                }
+                auto char_width = metrics.width(static_cast<std::make_unsigned_t<CharT>>(c));
+                bool wrapped_at_space = false;
+                while(line_width + char_width > m_width && line_width > 0) {
+                    if(c == ' ') {
+                        push_line(line, line_width);
+                        line = color;
+                        line_width = 0;
+                        last_space = String::npos;
+                        wrapped_at_space = true;
+                        break;
+                    }
+                    if(last_space != String::npos) {
+                        // Wrap at the last space; the rest of the word moves to the next line, 
+                        // and the character is measured again against it
+                        String rest = line.substr(last_space + 1);
+                        std::int32_t rest_width = line_width - width_at_space - metrics.width(' ');
+                        line.resize(last_space);
+                        push_line(line, width_at_space);
+                        line = color_at_space + rest;
+                        line_width = rest_width;
+                        last_space = String::npos;
+                        continue;
+                    }
+                    push_line(line, line_width);
+                    line = color;
+                    line_width = 0;
+                }
+                if(wrapped_at_space) {
+                    continue;
+                }
+                if(c == ' ') {
+                    last_space = line.size();
+                    width_at_space = line_width;
+                    color_at_space = color;
+                }
+                line += c;
+                line_width += char_width;
+            }
+            if(!line.empty() && line != color) {
+                push_line(line, line_width);
+            }
+        }
+    };
+
     /**
      * Show text as a subtitle on the screen.
      * @param text The text to show.
@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+/**
+ * Prints a binary log written by a logger in binary mode as text.
+ * 
+ * Portable; build it with the bundled fmt, e.g.:
+ *   g++ -std=c++20 -O2 -Iinclude -DFMT_HEADER_ONLY tools/binary_log_decoder.cpp -o binary_log_decoder
+ */
+
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <balltze/binary_log.hpp>
+
+static const char *level_name(std::uint8_t level) noexcept {
+    static const char *names[] = { "debug", "info", "warning", "error", "fatal" };
+    return level < sizeof(names) / sizeof(names[0]) ? names[level] : "unknown";
+}
+
+int main(int argc, const char **argv) {
+    if(argc != 2) {
+        std::fprintf(stderr, "Usage: %s <binary log>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::ifstream file(argv[1], std::ios::binary);
+    if(!file.is_open()) {
+        std::fprintf(stderr, "Failed to open %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    try {
+        Balltze::BinaryLog::Reader reader(file);
+        while(auto entry = reader.next()) {
+            if(entry->level == 0xFF) {
+                fmt::print("[binary log] {}\n", entry->message);
+                continue;
+            }
+            auto time = std::chrono::system_clock::to_time_t(entry->time);
+            auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(entry->time.time_since_epoch()).count() % 1000;
+            std::tm local_time;
+            localtime_r(&time, &local_time);
+            fmt::print("[{:04}-{:02}-{:02} {:02}:{:02}:{:02}.{:03}] [{}] [{}] {}\n", local_time.tm_year + 1900, local_time.tm_mon + 1, local_time.tm_mday, local_time.tm_hour, local_time.tm_min, local_time.tm_sec, milliseconds, entry->logger_name, level_name(entry->level), entry->message);
+        }
+    }
+    catch(std::exception &e) {
+        std::fflush(stdout);
+        std::fprintf(stderr, "%s\n", e.what());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
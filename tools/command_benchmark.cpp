@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+/**
+ * Compares running a script of commands line by line through split_arguments()
+ * and Command::call(std::vector<std::string>) with running it through
+ * CommandBatchExecutor.
+ *
+ * Links against the library; build it with MinGW and run it next to balltze.dll, e.g.:
+ *   i686-w64-mingw32-g++ -std=c++20 -O2 -Iinclude tools/command_benchmark.cpp lib/libballtze.dll.a lib/libfmt.a -o command_benchmark.exe
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <balltze/command.hpp>
+
+using namespace Balltze;
+
+static std::size_t calls = 0;
+
+static bool benchmark_command(int arg_count, const char **args) {
+    calls += arg_count;
+    return true;
+}
+
+static std::vector<std::string> split_lines(std::string const &script) {
+    std::vector<std::string> lines;
+    std::size_t start = 0;
+    while(start < script.size()) {
+        auto end = script.find('\n', start);
+        if(end == std::string::npos) {
+            end = script.size();
+        }
+        lines.emplace_back(script.substr(start, end - start));
+        start = end + 1;
+    }
+    return lines;
+}
+
+int main(int argc, const char **argv) {
+    std::size_t command_count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000;
+    std::size_t iterations = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20;
+    if(command_count == 0 || iterations == 0) {
+        std::fprintf(stderr, "Usage: %s [commands] [iterations]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    Command command("benchmark_set", "benchmark", "Benchmark command", std::nullopt, benchmark_command, false, std::size_t(0), std::size_t(8));
+    auto &index = PluginCommandIndex::get();
+    index.add(command);
+
+    std::string script;
+    for(std::size_t i = 0; i < command_count; i++) {
+        script += "benchmark_set " + std::to_string(i) + " \"some quoted value\" 3.5 escaped\\ space\n";
+    }
+    auto lines = split_lines(script);
+
+    using Clock = std::chrono::steady_clock;
+    auto per_command = [&](Clock::duration elapsed) {
+        return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(command_count * iterations);
+    };
+
+    // Current path: one vector of strings per command, converted back to const char ** by Command::call
+    auto start = Clock::now();
+    for(std::size_t iteration = 0; iteration < iterations; iteration++) {
+        for(auto const &line : lines) {
+            auto arguments = split_arguments(line);
+            auto *found = index.find(arguments[0]);
+            arguments.erase(arguments.begin());
+            found->call(arguments);
+        }
+    }
+    auto split_time = per_command(Clock::now() - start);
+
+    CommandBatchExecutor executor(index);
+    executor.execute(script);
+    start = Clock::now();
+    for(std::size_t iteration = 0; iteration < iterations; iteration++) {
+        executor.execute(script);
+    }
+    auto batch_time = per_command(Clock::now() - start);
+
+    std::printf("%zu commands x %zu iterations\n", command_count, iterations);
+    std::printf("split_arguments + call: %10.1f ns/command\n", split_time);
+    std::printf("CommandBatchExecutor:   %10.1f ns/command\n", batch_time);
+    std::printf("speedup:                %10.2fx\n", split_time / batch_time);
+
+    index.remove(command.name());
+    return calls > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+/**
+ * Compares the cost of formatting a log line and a console_printf() message the way
+ * the SDK did before format strings were checked at compile time with the way it does
+ * now. Only the part that runs in the plugin is measured; the library receives the
+ * same text in every case.
+ *
+ * Portable; build it with the bundled fmt, e.g.:
+ *   g++ -std=c++20 -O2 -Iinclude -DFMT_HEADER_ONLY tools/logger_benchmark.cpp -o logger_benchmark
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <fmt/format.h>
+#include <fmt/printf.h>
+
+using Clock = std::chrono::steady_clock;
+
+static std::size_t sink = 0;
+
+/** What the library gets; console_print() takes its message by value */
+static void consume(std::string message) {
+    sink += message.size();
+}
+
+static void consume(std::ostringstream &stream) {
+    sink += static_cast<std::size_t>(stream.tellp());
+    stream.str("");
+    stream.clear();
+}
+
+template<typename F>
+static double time_per_call(std::size_t iterations, F &&function) {
+    auto start = Clock::now();
+    for(std::size_t i = 0; i < iterations; i++) {
+        function(i);
+    }
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / static_cast<double>(iterations);
+}
+
+int main(int argc, const char **argv) {
+    std::size_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000000;
+    if(iterations == 0) {
+        std::fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::string map_name = "bloodgulch";
+    std::ostringstream stream;
+
+    // LoggerStream::operator()(std::string format, Args...) before compile-time format strings
+    auto logger_before = time_per_call(iterations, [&](std::size_t i) {
+        std::string format = "Loaded map {} with {} tags in {:.2f} ms";
+        std::string output = fmt::format(fmt::runtime(format), map_name, i, 12.5);
+        stream << output;
+        consume(stream);
+    });
+
+    // LoggerStream::operator()(fmt::format_string<Args...>, Args...) with its thread-local buffer
+    auto logger_now = time_per_call(iterations, [&](std::size_t i) {
+        thread_local fmt::memory_buffer buffer;
+        buffer.clear();
+        fmt::format_to(std::back_inserter(buffer), "Loaded map {} with {} tags in {:.2f} ms", map_name, i, 12.5);
+        stream.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        consume(stream);
+    });
+
+    // console_printf() with snprintf into a 256 byte buffer
+    auto printf_snprintf = time_per_call(iterations, [&](std::size_t i) {
+        char message[256];
+        std::snprintf(message, sizeof(message), "Loaded map %s with %zu tags in %.2f ms", map_name.c_str(), i, 12.5);
+        consume(message);
+    });
+
+    // console_printf() with fmt::sprintf, which formats into a new buffer every call
+    auto printf_sprintf = time_per_call(iterations, [&](std::size_t i) {
+        consume(fmt::sprintf("Loaded map %s with %zu tags in %.2f ms", map_name, i, 12.5));
+    });
+
+    // console_printf() as it is now
+    auto printf_now = time_per_call(iterations, [&](std::size_t i) {
+        thread_local fmt::memory_buffer buffer;
+        buffer.clear();
+        fmt::detail::vprintf(buffer, fmt::string_view("Loaded map %s with %zu tags in %.2f ms"), fmt::printf_args(fmt::make_printf_args(map_name, i, 12.5)));
+        consume(std::string(buffer.data(), buffer.size()));
+    });
+
+    std::printf("%zu iterations\n", iterations);
+    std::printf("log line, runtime format:        %8.1f ns\n", logger_before);
+    std::printf("log line, compile-time format:   %8.1f ns\n", logger_now);
+    std::printf("console_printf, snprintf:        %8.1f ns\n", printf_snprintf);
+    std::printf("console_printf, fmt::sprintf:    %8.1f ns\n", printf_sprintf);
+    std::printf("console_printf, reused buffer:   %8.1f ns\n", printf_now);
+    return sink > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
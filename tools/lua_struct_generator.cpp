@@ -0,0 +1,265 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+/**
+ * Generates Balltze::LuaStruct::Describe specializations for the tag definition
+ * structs, so they can be pushed to Lua with LuaStruct::push().
+ *
+ * The tag definition headers are generated too, so they are parsed line by line:
+ * every struct reachable from the given structs is described, bases and nested
+ * structs first. Fields whose type cannot be bound (pointers, matrices, raw bytes)
+ * are left out and listed on stderr.
+ *
+ * Portable, e.g.:
+ *   g++ -std=c++20 -O2 tools/lua_struct_generator.cpp -o lua_struct_generator
+ *
+ * lua_struct_tags.hpp is generated with:
+ *   ./lua_struct_generator include/balltze/engine/tag_definitions include/balltze/helpers/lua_struct_tags.hpp Biped Vehicle Weapon Equipment Garbage Projectile Scenery
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct ParsedField {
+    std::string type;
+    std::string name;
+
+    /** Whether the field is a one bit field */
+    bool is_bit = false;
+};
+
+struct ParsedStruct {
+    std::string name;
+    std::string base;
+    std::string file;
+    std::vector<ParsedField> fields;
+
+    /** Lines of the struct that are not fields */
+    std::vector<std::string> skipped;
+};
+
+/** Types every field of which is a scalar for LuaStruct */
+static const std::set<std::string> SCALAR_TYPES = {
+    "bool", "float", "std::int8_t", "std::uint8_t", "std::int16_t", "std::uint16_t", "std::int32_t", "std::uint32_t",
+    "Angle", "Fraction", "Index", "TagEnum", "TagFourCC", "TickCount32", "TickCount16", "Point",
+    "ResourceHandle", "TagHandle", "ObjectHandle", "PlayerHandle", "TagString"
+};
+
+/** Structures of data_types.hpp described in lua_struct.hpp */
+static const std::set<std::string> ENGINE_TYPES = {
+    "Point2D", "Point3D", "Point2DInt", "Vector2D", "Vector3D", "Euler2D", "Euler3D", "Euler3DPYR", "ColorRGB", "ColorARGB",
+    "ColorARGBInt", "Quaternion", "Plane2D", "Plane3D", "Rectangle2D", "Rectangle2DF", "TagDependency", "TagDataOffset"
+};
+
+class Generator {
+public:
+    void parse_directory(std::filesystem::path const &directory) {
+        std::vector<std::filesystem::path> files;
+        for(auto const &entry : std::filesystem::directory_iterator(directory)) {
+            if(entry.path().extension() == ".hpp") {
+                files.push_back(entry.path());
+            }
+        }
+        std::sort(files.begin(), files.end());
+        for(auto const &file : files) {
+            parse_file(file);
+        }
+    }
+
+    /**
+     * Generate the header
+     * @param roots     structs to describe, with every struct they need
+     * @return          header; std::nullopt if a root does not exist
+     */
+    std::optional<std::string> generate(std::vector<std::string> const &roots, std::string const &guard) {
+        for(auto const &root : roots) {
+            if(!m_structs.count(root)) {
+                std::fprintf(stderr, "Unknown struct %s\n", root.c_str());
+                return std::nullopt;
+            }
+            visit(root);
+        }
+
+        std::set<std::string> files;
+        for(auto const &name : m_order) {
+            files.insert(m_structs[name].file);
+        }
+
+        std::ostringstream out;
+        out << "// SPDX-License-Identifier: GPL-3.0-only\n";
+        out << "// This file is auto-generated by tools/lua_struct_generator.cpp. DO NOT EDIT!\n\n";
+        out << "#ifndef " << guard << "\n#define " << guard << "\n\n";
+        out << "#include \"lua_struct.hpp\"\n";
+        for(auto const &file : files) {
+            out << "#include \"../engine/tag_definitions/" << file << "\"\n";
+        }
+        out << "\nnamespace Balltze::LuaStruct {\n";
+        for(auto const &name : m_order) {
+            write_struct(out, m_structs[name]);
+        }
+        out << "}\n\n#endif\n";
+        return out.str();
+    }
+
+private:
+    std::map<std::string, ParsedStruct> m_structs;
+    std::set<std::string> m_enums;
+    std::set<std::string> m_visited;
+    std::vector<std::string> m_order;
+
+    void parse_file(std::filesystem::path const &path) {
+        static const std::regex enum_line(R"(^\s*enum (\w+) : [\w:]+ \{)");
+        static const std::regex struct_line(R"(^\s*struct (\w+)(?: : public (\w+))? \{)");
+        // Arrays need nothing special; TypeBuilder::field() takes array members
+        static const std::regex field_line(R"(^\s*([\w:<>]+)\s+(\w+)(?:\[\d+\])?(\s*:\s*1)?;)");
+
+        std::ifstream file(path);
+        std::string line;
+        ParsedStruct *current = nullptr;
+        std::smatch match;
+        while(std::getline(file, line)) {
+            if(std::regex_search(line, match, enum_line)) {
+                m_enums.insert(match[1]);
+            }
+            else if(std::regex_search(line, match, struct_line)) {
+                current = &m_structs[match[1]];
+                current->name = match[1];
+                current->base = match[2];
+                current->file = path.filename().string();
+            }
+            else if(current && line.find("};") != std::string::npos) {
+                current = nullptr;
+            }
+            else if(current && std::regex_search(line, match, field_line)) {
+                ParsedField field;
+                field.type = match[1];
+                field.name = match[2];
+                field.is_bit = match[3].matched;
+                current->fields.push_back(field);
+            }
+            else if(current && line.find("PADDING") == std::string::npos && line.find_first_not_of(" \t\r") != std::string::npos) {
+                current->skipped.push_back(line.substr(line.find_first_not_of(" \t")));
+            }
+        }
+    }
+
+    static std::optional<std::string> reflexive_element(std::string const &type) {
+        static const std::regex reflexive(R"(^TagReflexive<(\w+)>$)");
+        std::smatch match;
+        if(std::regex_match(type, match, reflexive)) {
+            return match[1].str();
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * Check whether a field type can be bound, visiting the structs it needs
+     */
+    bool bindable(std::string const &type) {
+        if(SCALAR_TYPES.count(type) || ENGINE_TYPES.count(type) || m_enums.count(type)) {
+            return true;
+        }
+        if(auto element = reflexive_element(type)) {
+            return bindable(*element);
+        }
+        if(m_structs.count(type)) {
+            visit(type);
+            return true;
+        }
+        return false;
+    }
+
+    void visit(std::string const &name) {
+        if(!m_visited.insert(name).second) {
+            return;
+        }
+        auto &parsed = m_structs[name];
+        for(auto const &line : parsed.skipped) {
+            std::fprintf(stderr, "%s: skipping %s\n", name.c_str(), line.c_str());
+        }
+        if(!parsed.base.empty()) {
+            visit(parsed.base);
+        }
+        for(auto &field : parsed.fields) {
+            if(!field.is_bit && !bindable(field.type)) {
+                std::fprintf(stderr, "%s: cannot bind %s %s\n", name.c_str(), field.type.c_str(), field.name.c_str());
+                field.type.clear();
+            }
+        }
+        m_order.push_back(name);
+    }
+
+    static void write_struct(std::ostringstream &out, ParsedStruct const &parsed) {
+        auto full_name = "Engine::TagDefinitions::" + parsed.name;
+        out << "    template<> struct Describe<" << full_name << "> {\n";
+        out << "        static constexpr char const *name = \"" << parsed.name << "\";\n";
+        out << "        static void describe(TypeBuilder<" << full_name << "> &type) {\n";
+        std::vector<std::string> calls;
+        if(!parsed.base.empty()) {
+            calls.push_back(".base<Engine::TagDefinitions::" + parsed.base + ">()");
+        }
+
+        // Bit fields cannot be pointed to, so bits are given by position; they are allocated from the lowest bit
+        std::size_t bit = 0;
+        bool has_members = false;
+        for(auto const &field : parsed.fields) {
+            if(field.is_bit) {
+                calls.push_back(".bit(\"" + field.name + "\", 0, " + std::to_string(bit++) + ")");
+            }
+            else if(!field.type.empty()) {
+                calls.push_back(".field(\"" + field.name + "\", &T::" + field.name + ")");
+                has_members = true;
+            }
+        }
+        if(has_members) {
+            out << "            using T = " << full_name << ";\n";
+        }
+        if(calls.empty()) {
+            out << "            (void)type;\n";
+        }
+        else {
+            out << "            type" << calls[0];
+            for(std::size_t i = 1; i < calls.size(); i++) {
+                out << "\n                " << calls[i];
+            }
+            out << ";\n";
+        }
+        out << "        }\n    };\n\n";
+    }
+};
+
+int main(int argc, const char **argv) {
+    if(argc < 4) {
+        std::fprintf(stderr, "Usage: %s <tag definitions directory> <output header> <struct>...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    Generator generator;
+    generator.parse_directory(argv[1]);
+
+    std::vector<std::string> roots(argv + 3, argv + argc);
+    auto guard = "BALLTZE_API__HELPERS__" + std::filesystem::path(argv[2]).stem().string() + "_HPP";
+    std::transform(guard.begin(), guard.end(), guard.begin(), [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    auto header = generator.generate(roots, guard);
+    if(!header) {
+        return EXIT_FAILURE;
+    }
+
+    std::ofstream output(argv[2], std::ios::binary);
+    output << *header;
+    if(!output) {
+        std::fprintf(stderr, "Failed to write %s\n", argv[2]);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+/**
+ * Compiles the scripts of a scenario dump and runs them for a number of ticks,
+ * printing the cost of every script that ran.
+ *
+ * Dumps are written in game with Balltze::ScriptVM::Source::write(), e.g. from the
+ * result of Balltze::ScriptVM::from_scenario() for the scenario of the current map.
+ *
+ * Portable; build it with the bundled fmt, e.g.:
+ *   g++ -std=c++20 -O2 -Iinclude -DFMT_HEADER_ONLY tools/script_vm_benchmark.cpp -o script_vm_benchmark
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <balltze/helpers/script_vm.hpp>
+
+using namespace Balltze;
+
+int main(int argc, const char **argv) {
+    std::size_t ticks = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 30 * 60;
+    if(argc < 2 || argc > 3 || ticks == 0) {
+        std::fprintf(stderr, "Usage: %s <scenario dump> [ticks]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::ifstream file(argv[1], std::ios::binary);
+    if(!file.is_open()) {
+        std::fprintf(stderr, "Failed to open %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    try {
+        auto source = ScriptVM::Source::read(file);
+        auto program = ScriptVM::Compiler::compile(source);
+        ScriptVM::Machine machine(program);
+        auto result = ScriptVM::benchmark(machine, ticks);
+
+        fmt::print("{} scripts, {} globals, {} instructions, {} native functions\n", program.script_count, program.globals.size(), program.code.size(), program.natives.size());
+        fmt::print("{} ticks: {} instructions in {:.3f} ms\n\n", result.ticks, result.instructions, result.time.count() / 1e6);
+        fmt::print("{:<32} {:>10} {:>14} {:>12} {:>14}\n", "script", "runs", "instructions", "time (ms)", "worst tick (us)");
+        for(auto const &script : result.scripts) {
+            auto const &profile = script.profile;
+            fmt::print("{:<32} {:>10} {:>14} {:>12.3f} {:>14.1f}\n", script.name, profile.runs, profile.instructions, profile.time.count() / 1e6, profile.worst_tick.count() / 1e3);
+        }
+    }
+    catch(std::exception &e) {
+        std::fflush(stdout);
+        std::fprintf(stderr, "%s\n", e.what());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,129 @@
+// SPDX-License-Identifier: GPL-3.0-only
+
+/**
+ * Runs the eviction policy of Balltze::TextureCache against a mock loader that
+ * records every load and unload, and checks the budget and LRU rules.
+ *
+ * Portable, e.g.:
+ *   g++ -std=c++20 -O2 -Iinclude tools/texture_cache_check.cpp -o texture_cache_check
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+#include <vector>
+#include <balltze/helpers/texture_cache.hpp>
+
+using namespace Balltze;
+
+struct MockLoader {
+    struct BitmapData {
+        std::uint32_t texture_cache_id;
+        std::size_t pixel_data_size;
+    };
+
+    struct Resource {
+        std::size_t index;
+    };
+
+    std::vector<BitmapData> *bitmaps;
+    std::set<std::uint32_t> loaded;
+    std::size_t loads = 0;
+    std::size_t unloads = 0;
+
+    std::uint32_t load(BitmapData &bitmap, bool) {
+        loads++;
+        loaded.insert(bitmap.texture_cache_id);
+        return bitmap.texture_cache_id;
+    }
+
+    void unload(BitmapData &bitmap, std::uint32_t texture) {
+        unloads++;
+        if(texture != bitmap.texture_cache_id || loaded.erase(texture) != 1) {
+            std::fprintf(stderr, "unloaded a texture that was not loaded: %u\n", texture);
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
+    BitmapData *resolve(Resource const &resource) {
+        return resource.index < bitmaps->size() ? &(*bitmaps)[resource.index] : nullptr;
+    }
+};
+
+struct Cluster {
+    struct {
+        std::size_t count;
+        MockLoader::Resource *offset;
+    } predicted_resources;
+};
+
+static int failures = 0;
+
+static void check(bool condition, const char *what) {
+    if(!condition) {
+        std::fprintf(stderr, "FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+int main() {
+    std::vector<MockLoader::BitmapData> bitmaps;
+    for(std::uint32_t i = 0; i < 8; i++) {
+        bitmaps.push_back({ i, 100 });
+    }
+
+    TextureCache<MockLoader> cache(MockLoader { &bitmaps }, 300);
+    auto &loader = cache.loader();
+
+    // Fill the budget, then touch the oldest bitmap so the second one is the LRU
+    cache.begin_frame();
+    cache.get(bitmaps[0]);
+    cache.get(bitmaps[1]);
+    cache.get(bitmaps[2]);
+    cache.begin_frame();
+    cache.get(bitmaps[0]);
+    check(cache.statistics().hits == 1 && cache.statistics().misses == 3, "hits and misses are counted");
+
+    cache.begin_frame();
+    cache.get(bitmaps[3]);
+    check(!cache.is_resident(bitmaps[1]), "least recently used bitmap is evicted");
+    check(cache.is_resident(bitmaps[0]) && cache.is_resident(bitmaps[2]) && cache.is_resident(bitmaps[3]), "other bitmaps stay resident");
+    check(cache.resident_bytes() == 300 && loader.loaded.size() == 3, "budget is kept and matches the loader");
+
+    // Everything resident was used this frame: the budget is exceeded instead of evicting
+    cache.get(bitmaps[0]);
+    cache.get(bitmaps[2]);
+    cache.get(bitmaps[4]);
+    check(cache.resident_bytes() == 400 && cache.resident_count() == 4, "bitmaps used this frame are not evicted");
+
+    // A prefetch that does not fit without evicting this frame's bitmaps is refused
+    check(!cache.prefetch(bitmaps[5]), "prefetch does not evict bitmaps used this frame");
+    check(!cache.is_resident(bitmaps[5]) && cache.resident_count() == 4, "refused prefetch loads nothing");
+
+    // Next frame, prefetching a cluster evicts older bitmaps to make room
+    cache.begin_frame();
+    cache.set_budget(300);
+    check(cache.resident_bytes() <= 300, "lowering the budget evicts");
+    MockLoader::Resource resources[] = { { 5 }, { 6 }, { 100 } };
+    Cluster cluster { { 3, resources } };
+    auto prefetched = cache.prefetch_cluster(cluster);
+    check(prefetched == 2, "cluster prefetch resolves bitmaps and skips other resources");
+    check(cache.is_resident(bitmaps[5]) && cache.is_resident(bitmaps[6]), "prefetched bitmaps are resident");
+    check(cache.resident_bytes() <= 300, "prefetch stays within the budget");
+
+    // A bitmap reusing the ID of a resident one replaces it
+    MockLoader::BitmapData replacement { 5, 50 };
+    cache.get(replacement);
+    check(cache.is_resident(replacement) && !cache.is_resident(bitmaps[5]), "stale entry with the same ID is replaced");
+
+    cache.clear();
+    check(cache.resident_count() == 0 && cache.resident_bytes() == 0 && loader.loaded.empty(), "clear unloads everything");
+    check(loader.loads == loader.unloads, "every load is matched by an unload");
+
+    if(failures > 0) {
+        return EXIT_FAILURE;
+    }
+    std::printf("texture cache: all checks passed (%zu loads, %zu evictions)\n", loader.loads, cache.statistics().evictions);
+    return EXIT_SUCCESS;
+}